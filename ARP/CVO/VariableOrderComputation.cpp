@@ -62,15 +62,74 @@ static void GetCurrentDTmsec(char *strDT, int64_t  & tNow)
 	sprintf(strDT, "%lld", tNow) ;
 }
 
+int ARE::VarElimOrderComp::CVOcontext::N(void) const
+{
+	return NULL != _Problem ? _Problem->N() : _OriginalGraph._nNodes ;
+}
+
+int ARE::VarElimOrderComp::CVOcontext::ComputeEliminationTreeHeight(const int *VarElimOrder)
+{
+	int n = _OriginalGraph._nNodes ;
+	if (n < 1 || NULL == _OriginalGraph._Nodes) 
+		return 0 ;
+	int *pos = new int[4*n] ;
+	if (NULL == pos) 
+		return INT_MAX ;
+	int *parent = pos + n, *ancestor = pos + 2*n, *depth = pos + 3*n ;
+	int i, height = 0 ;
+	for (i = 0 ; i < n ; i++) {
+		pos[VarElimOrder[i]] = i ;
+		parent[i] = ancestor[i] = -1 ;
+		}
+	// elimination tree of the filled-in graph, computed from the original graph (Liu's algorithm, with path compression).
+	for (i = 0 ; i < n ; i++) {
+		int v = VarElimOrder[i] ;
+		for (ARE::AdjVar *av = _OriginalGraph._Nodes[v]._Neighbors ; NULL != av ; av = av->_NextAdjVar) {
+			int u = av->_V ;
+			if (pos[u] >= i) 
+				continue ;
+			while (ancestor[u] >= 0 && ancestor[u] != v) {
+				int next = ancestor[u] ;
+				ancestor[u] = v ;
+				u = next ;
+				}
+			if (ancestor[u] < 0) {
+				ancestor[u] = v ;
+				parent[u] = v ;
+				}
+			}
+		}
+	// parents are eliminated after their children
+	for (i = n - 1 ; i >= 0 ; i--) {
+		int v = VarElimOrder[i] ;
+		depth[v] = parent[v] < 0 ? 0 : depth[parent[v]] + 1 ;
+		if (depth[v] > height) 
+			height = depth[v] ;
+		}
+	delete [] pos ;
+	return height ;
+}
+
 int ARE::VarElimOrderComp::CVOcontext::NoteVarOrderComputationCompletion(int w_IDX, ARE::Graph & G)
 {
-	if (G._OrderLength != _Problem->N()) {
+	if (G._OrderLength != N()) {
 		int error = 1 ;
 		return 1 ;
 		}
 	++_nRunsCompleted ;
-	if ((StateSpaceSize==_ObjCode && (G._TotalVarElimComplexity_Log10 < _BestOrder->_Complexity_Log10 || (fabs(G._TotalVarElimComplexity_Log10 - _BestOrder->_Complexity_Log10) < 0.01 && G._VarElimOrderWidth < _BestOrder->_Width))) ||  
-		(Width==_ObjCode && (G._VarElimOrderWidth < _BestOrder->_Width || (G._VarElimOrderWidth == _BestOrder->_Width && G._TotalVarElimComplexity_Log10 < _BestOrder->_Complexity_Log10)))) {
+	int height = -1 ;
+	bool better = false ;
+	if (Width==_ObjCode && BTheight==_SecondaryObjCode) {
+		// ties on width are broken by the height of the elimination tree (i.e. pseudo tree height), not complexity
+		if (G._VarElimOrderWidth <= _BestOrder->_Width) {
+			height = ComputeEliminationTreeHeight(G._VarElimOrder) ;
+			better = G._VarElimOrderWidth < _BestOrder->_Width || height < _BestOrder->_Height ;
+			}
+		}
+	else 
+		better = (StateSpaceSize==_ObjCode && (G._TotalVarElimComplexity_Log10 < _BestOrder->_Complexity_Log10 || (fabs(G._TotalVarElimComplexity_Log10 - _BestOrder->_Complexity_Log10) < 0.01 && G._VarElimOrderWidth < _BestOrder->_Width))) ||  
+			(Width==_ObjCode && (G._VarElimOrderWidth < _BestOrder->_Width || (G._VarElimOrderWidth == _BestOrder->_Width && G._TotalVarElimComplexity_Log10 < _BestOrder->_Complexity_Log10))) ;
+	if (better) {
 		int64_t tNow = ARE::GetTimeInMilliseconds() ;
 		if (NULL != _fpLOG) {
 			fprintf(_fpLOG, "\n%I64d worker %2d found better solution : width=%d complexity=%g space(#elements)=%g", tNow, (int) w_IDX, (int) G._VarElimOrderWidth, (double) G._TotalVarElimComplexity_Log10, (double) G._TotalNewFunctionStorageAsNumOfElements_Log10) ;
@@ -81,17 +140,21 @@ int ARE::VarElimOrderComp::CVOcontext::NoteVarOrderComputationCompletion(int w_I
 		result_record._dt = tNow - _tStart ;
 		result_record._width = G._VarElimOrderWidth ;
 		result_record._complexity = G._TotalVarElimComplexity_Log10 ;
+		result_record._height = height ;
 
 		_BestOrder->_Width = G._VarElimOrderWidth ;
+		_BestOrder->_Height = height ;
 		_BestOrder->_nFillEdges = G._nFillEdges ;
 		_BestOrder->_MaxSingleVarElimComplexity = G._MaxVarElimComplexity_Log10 ;
 		_BestOrder->_Complexity_Log10 = G._TotalVarElimComplexity_Log10 ;
 		_BestOrder->_TotalNewFunctionStorageAsNumOfElements_Log10 = G._TotalNewFunctionStorageAsNumOfElements_Log10 ;
-		for (int i = 0 ; i < _Problem->N() ; i++) 
+		for (int i = 0 ; i < N() ; i++) 
 			_BestOrder->_VarListInElimOrder[i] = (G._VarElimOrder)[i] ;
 
-		cout << "c status " << (1+_BestOrder->_Width) << ' ' << tNow << std::endl ;
-		cout << flush ;
+		if (_PrintStatus) {
+			cout << "c status " << (1+_BestOrder->_Width) << ' ' << tNow << std::endl ;
+			cout << flush ;
+			}
 		}
 
 	if (G._VarElimOrderWidth >= 0 && G._VarElimOrderWidth < 1024) {
@@ -116,7 +179,6 @@ static void *WorkerThreadFn(void *X)
 {
 	ARE::VarElimOrderComp::Worker *w = (ARE::VarElimOrderComp::Worker *) X;
 	ARE::VarElimOrderComp::CVOcontext & CVOcontext = *(w->_CVOcontext) ;
-	ARE::ARP & Problem = *(CVOcontext._Problem) ;
 	ARE::VarElimOrderComp::Order & best_order = *(CVOcontext._BestOrder) ;
 
 	// initialize best order to something bad; we don't want anything worse than that.
@@ -173,6 +235,9 @@ static void *WorkerThreadFn(void *X)
 		try {
 			bool earlyTerminationOk = nCompleteRunsTodo-- > 0 ? false : true ;
 			int widthLimit = bestWidth ;
+			// when ties on width are broken by height, orders of the same width have to be completed
+			if (ARE::VarElimOrderComp::BTheight == CVOcontext._SecondaryObjCode && widthLimit < INT_MAX) 
+				++widthLimit ;
 			if (CVOcontext._FindPracticalVariableOrder && widthLimit > CVOcontext._PracticalOrderLimit_W) 
 				widthLimit = CVOcontext._PracticalOrderLimit_W ;
 			int spaceLimit = bestComplexity ;
@@ -271,19 +336,13 @@ done :
 }
 
 
-#if defined WINDOWS || _WINDOWS
-typedef unsigned int (__stdcall *pCVOThreadFn)(void *X) ;
-static unsigned int __stdcall CVOThreadFn(void *X) 
-#elif defined (LINUX)
-typedef void *(*pCVOThreadFn)(void *X) ;
-static void *CVOThreadFn(void *X)
-#endif 
+// CVO control logic (preprocessing, worker threads); runs in the CVO thread, or in the caller's thread (CVOcontext::Run()).
+static void CVOcontrol(ARE::VarElimOrderComp::CVOcontext *context)
 {
-	ARE::VarElimOrderComp::CVOcontext *context = (ARE::VarElimOrderComp::CVOcontext *)(X) ;
 	context->Reset() ;
 	int nWorkers = context->_nThreads ;
 	int nRunsToDoMax = context->_nRunsToDoMax ;
-	ARE::ARP & p = *(context->_Problem) ;
+	int N = context->N() ;
 	ARE::VarElimOrderComp::Order & BestOrder = *(context->_BestOrder) ;
 	int & ret = context->_ret, i ;
 	ARE::Graph & OriginalGraph = context->_OriginalGraph ;
@@ -304,7 +363,7 @@ static void *CVOThreadFn(void *X)
 		}
 
 	if (NULL == BestOrder._VarListInElimOrder) {
-		if (0 != BestOrder.Initialize(p.N())) {
+		if (0 != BestOrder.Initialize(N)) {
 			ret = 1000 ;
 			if (NULL != context->_fpLOG) {
 				fprintf(context->_fpLOG, "\n%I64d CVO control thread; bestorder init failed ...", tNow) ;
@@ -314,10 +373,11 @@ static void *CVOThreadFn(void *X)
 			}
 		}
 
-	// create problem graph
+	// create problem graph, unless the caller has done so
 	if (context->_RandomGeneratorSeed > 0) 
 		OriginalGraph.RNG().seed(context->_RandomGeneratorSeed) ; // set seed so that starting point can be duplicated
-	OriginalGraph.Create(p) ;
+	if (NULL != context->_Problem) 
+		OriginalGraph.Create(*(context->_Problem)) ;
 	if (! OriginalGraph._IsValid) {
 		ret = 1001 ;
 		goto done ;
@@ -385,7 +445,8 @@ static void *CVOThreadFn(void *X)
 	// if strictly best order (whatever the width/complexity) is required, execute one run here to get some real bound on width/complexity.
 	// when we launch multi-threaded search for good order, knowing a decent bound will help the threads right away.
 	// when we want a practical order, width/complexity limits are (should be) quite low.
-	best_order._Width = p.N() ;
+	best_order._Width = N ;
+	best_order._Height = INT_MAX ;
 	best_order._Complexity_Log10 = DBL_MAX ;
 	// 2015-12-14 KK : do this always, so that we have some result (order); we may quite quickly, and if we did  not run this, we may have nothing.
 //	if (! context->_FindPracticalVariableOrder) {
@@ -469,6 +530,9 @@ static void *CVOThreadFn(void *X)
 			ret = 1005 ;
 			goto done ;
 			}
+		// graph copies don't carry the RNG state; give each worker its own stream, so that runs are distinct and repeatable given the seed
+		if (context->_RandomGeneratorSeed > 0) 
+			Workers[i]._G->RNG().seed(context->_RandomGeneratorSeed + 7919*(i+1)) ;
 		}
 
 	context->_LogIncrement = nRunsToDoMax/20 ;
@@ -581,7 +645,7 @@ done :
 //		nRuns += Workers[i]._nRunsDone ;
 	if (NULL != Workers) 
 		delete [] Workers ;
-	if (best_order._Width < p.N()) {
+	if (best_order._Width < N) {
 		// some ordering was found
 		}
 
@@ -604,7 +668,19 @@ done :
 		fflush(context->_fpLOG) ;
 */
 		}
+}
+
 
+#if defined WINDOWS || _WINDOWS
+typedef unsigned int (__stdcall *pCVOThreadFn)(void *X) ;
+static unsigned int __stdcall CVOThreadFn(void *X) 
+#elif defined (LINUX)
+typedef void *(*pCVOThreadFn)(void *X) ;
+static void *CVOThreadFn(void *X)
+#endif 
+{
+	ARE::VarElimOrderComp::CVOcontext *context = (ARE::VarElimOrderComp::CVOcontext *)(X) ;
+	CVOcontrol(context) ;
 	context->_ThreadHandle = 0 ;
 #if defined WINDOWS || _WINDOWS
 	_endthreadex(0) ;
@@ -615,6 +691,13 @@ done :
 }
 
 
+int ARE::VarElimOrderComp::CVOcontext::Run(void)
+{
+	CVOcontrol(this) ;
+	return _ret ;
+}
+
+
 int ARE::VarElimOrderComp::CVOcontext::CreateCVOthread(void)
 {
 #if defined WINDOWS || _WINDOWS
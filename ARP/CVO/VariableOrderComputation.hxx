@@ -39,19 +39,22 @@ public :
 	int64_t _dt ; // in milliseconds
 	int _width ;
 	double _complexity ;
+	int _height ; // height of the elimination tree; -1 if not computed
 public :
 	void operator=(const ResultSnapShot & O)
 	{
 		_dt = O._dt ;
 		_width = O._width ;
 		_complexity = O._complexity ;
+		_height = O._height ;
 	}
 public :
 	ResultSnapShot(void)
 		:
 		_dt(0), 
 		_width(0), 
-		_complexity(0.0)
+		_complexity(0.0), 
+		_height(-1)
 	{
 	}
 } ;
@@ -63,6 +66,7 @@ public :
 	int *_VarListInElimOrder ;
 	int _Width ;
 	int _WidthLowerBound ;
+	int _Height ; // height of the elimination tree; only computed when BTheight is the secondary objective
 	double _Complexity_Log10 ; // log of
 	double _TotalNewFunctionStorageAsNumOfElements_Log10 ; // log of
 	double _MaxSingleVarElimComplexity ;
@@ -86,6 +90,7 @@ public :
 		_nVars = 0 ;
 		_Width = INT_MAX ;
 		_WidthLowerBound = -1 ;
+		_Height = INT_MAX ;
 		_Complexity_Log10 = 0.0 ;
 		_TotalNewFunctionStorageAsNumOfElements_Log10 = 0.0 ;
 		_MaxSingleVarElimComplexity = DBL_MAX ;
@@ -104,6 +109,7 @@ public :
 		_nVars = 0 ;
 		_Width  = -1 ;
 		_WidthLowerBound = -1 ;
+		_Height = -1 ;
 		_Complexity_Log10 = -1.0 ;
 		_TotalNewFunctionStorageAsNumOfElements_Log10 = -1.0 ;
 		_MaxSingleVarElimComplexity = DBL_MAX ;
@@ -118,6 +124,7 @@ public :
 		_VarListInElimOrder(NULL), 
 		_Width(-1), 
 		_WidthLowerBound(-1), 
+		_Height(-1), 
 		_Complexity_Log10(-1.0), 
 		_TotalNewFunctionStorageAsNumOfElements_Log10(-1.0), 
 		_MaxSingleVarElimComplexity(DBL_MAX), 
@@ -135,6 +142,7 @@ class CVOcontext
 {
 public :
 	// IN
+	// if _Problem is NULL, the caller has to create _OriginalGraph (e.g. from fn signatures) before starting the CVO thread.
 	ARE::ARP *_Problem ;
 	// OPTIONS
 	ARE::VarElimOrderComp::ObjectiveToMinimize _ObjCode ;
@@ -157,6 +165,7 @@ public :
 	ARE::VarElimOrderComp::Order *_BestOrder ;
 	// CONTROL
 	FILE *_fpLOG ;
+	bool _PrintStatus ; // print 'c status' line to stdout on each improvement
 	unsigned long _RandomGeneratorSeed ;
 #if defined WINDOWS || _WINDOWS
 	LONG volatile _StopAndExit ;
@@ -182,8 +191,12 @@ public :
 	int _nImprovements ;
 	ARE::VarElimOrderComp::ResultSnapShot _Improvements[1024] ;
 public :
+	int N(void) const ;
+	// height of the elimination tree of the given (complete) order of the original graph; longest root-leaf path, in edges.
+	int ComputeEliminationTreeHeight(const int *VarElimOrder) ;
 	int NoteVarOrderComputationCompletion(int w_IDX, Graph & G) ;
 	int CreateCVOthread(void) ;
+	int Run(void) ; // same as the CVO thread, but in the calling thread; returns _ret (0 = ok).
 	int RequestStopCVOthread(void) ; // ret=0 means stopped; 1=stop requested, but still running; -1=stop requested before, but still running.
 	int StopCVOthread(int64_t TimeoutInMilliseconds = 10000) ;
 	int Reset(void)
@@ -233,6 +246,7 @@ public :
 		_ret(-1), 
 		_BestOrder(NULL), 
 		_fpLOG(NULL), 
+		_PrintStatus(true), 
 		_RandomGeneratorSeed(0), 
 		_StopAndExit(0), 
 		_ThreadHandle(0), 
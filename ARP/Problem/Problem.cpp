@@ -735,6 +735,75 @@ done :
 }
 
 
+int32_t ARE::ARP::LoadFromTables(int32_t N, const int32_t *K, int32_t nFunctions, const int32_t *Arity, const int32_t * const *Scopes, const ARE_Function_TableType * const *Tables, bool TablesAreLog10)
+{
+	int32_t ret = 1, i, j ;
+
+	Destroy() ;
+
+	if (N > 0) {
+		for (i = 0 ; i < N ; i++) {
+			if (K[i] < 0 || K[i] > MAX_NUM_VALUES_PER_VAR_DOMAIN) 
+				{ ret = ERRORCODE_VarDomainSizeTooLarge ; goto done ; }
+			}
+		if (0 != SetN(N)) 
+			goto done ;
+		if (0 != SetK((int32_t *) K)) 
+			goto done ;
+		}
+
+	if (nFunctions < 1) 
+		{ ret = 0 ; goto done ; }
+	_Functions = new ARE::Function*[nFunctions] ;
+	if (NULL == _Functions) 
+		goto done ;
+	_nFunctions = nFunctions ;
+	for (i = 0 ; i < _nFunctions ; i++) 
+		_Functions[i] = NULL ;
+
+	for (i = 0 ; i < _nFunctions ; i++) {
+		int32_t nA = Arity[i] ;
+		if (nA < 0 || nA > MAX_NUM_ARGUMENTS_PER_FUNCTION) 
+			goto done ;
+		for (j = 0 ; j < nA ; j++) {
+			if (Scopes[i][j] < 0 || Scopes[i][j] >= _nVars) 
+				goto done ;
+			}
+		_Functions[i] = new ARE::Function(NULL, this, i) ;
+		if (NULL == _Functions[i]) 
+			goto done ;
+		ARE::Function *f = _Functions[i] ;
+		f->SetType(ARE_Function_Type_RealCost) ;
+		if (0 != f->SetArguments(nA, Scopes[i], -1)) 
+			goto done ;
+		if (nA > 0) {
+			if (NULL == f->SortedArgumentsList(true)) 
+				goto done ;
+			}
+		f->ComputeTableSize() ;
+		if (nA <= 0) {
+			f->ConstValue() = Tables[i][0] ;
+			continue ;
+			}
+		f->AllocateInMemoryAsSingleTableBlock() ;
+		ARE_Function_TableType *data = f->TableData() ;
+		if (NULL == data) 
+			goto done ;
+		memcpy(data, Tables[i], sizeof(ARE_Function_TableType)*f->TableSize()) ;
+		}
+
+	_FunctionsAreConvertedToLogScale = TablesAreLog10 ;
+	ret = 0 ;
+
+done :
+
+	if (0 != ret) 
+		Destroy() ;
+
+	return ret ;
+}
+
+
 int32_t ARE::ARP::LoadFromFile_Evidence(const std::string & FileName, int32_t & nEvidenceVars)
 {
 	nEvidenceVars = 0 ;
@@ -402,6 +402,11 @@ public :
 	int32_t LoadUAIFormat(const char *buf, int32_t L) ;
 	int32_t LoadUAIFormat_Evidence(const char *buf, int32_t L, int32_t & nEvidenceVars) ;
 
+	// this function loads problem from tables that are already in memory (e.g. when converting from another problem representation).
+	// function i is over Scopes[i][0 ... Arity[i]); its table is indexed with the last argument changing fastest; a function with no arguments has a single entry.
+	// if TablesAreLog10, entries are taken to be in log10 scale already, i.e. functions are marked as converted to log scale.
+	int32_t LoadFromTables(int32_t N, const int32_t *K, int32_t nFunctions, const int32_t *Arity, const int32_t * const *Scopes, const ARE_Function_TableType * const *Tables, bool TablesAreLog10) ;
+
 public :
 
 	void Destroy(void)
@@ -0,0 +1,298 @@
+/*
+ * MasterPipeline.cpp
+ *
+ *  Synthetic throughput benchmark for the message pipeline of the parallel
+ *  master (cf. SearchMaster and BoundPropagatorMaster): as long as the thread
+ *  allowance permits, the search thread either finds a leaf itself or hands
+ *  a subproblem to one of the producers, which stand in for the subproblem
+ *  threads and report it solved right away. Leaves and solved subproblems
+ *  feed a single propagation thread. Reports the leaves propagated per
+ *  second for the mutex/condition variable queues the master used before,
+ *  and for the ring buffers it uses now.
+ *
+ *  Work is simulated by a busy loop of the given number of steps: expanding
+ *  a node (search, under mtx_space), propagating a leaf (under mtx_space),
+ *  and freeing the solved subproblem (under mtx_space before, outside of any
+ *  lock now).
+ *
+ *  Usage: master_pipeline_bench [producers] [threads] [seconds]
+ *                               [search work] [prop. work] [free work]
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RingBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+
+using namespace daoopt;
+
+static int producers = 4;
+static int threads = 16;
+static double runTime = 2.0;
+static int searchWork = 200;
+static int propWork = 100;
+static int freeWork = 100;
+
+static volatile double sink;
+
+/* busy loop standing in for actual work */
+static void work(int steps) {
+  double x = 0.0;
+  for (int i = 0; i < steps; ++i)
+    x += i * 0.5;
+  sink = x;
+}
+
+/* the master before: queues guarded by a mutex and condition variable each,
+ * every leaf is propagated (and its subproblem freed) under its own lock */
+struct QueuePipeline {
+  struct Inbox {
+    std::queue<long> jobs;
+    boost::mutex mtx;
+    boost::condition_variable_any cond;
+  };
+  vector<Inbox> inboxes;
+  std::queue<long> leaves, solved;
+  boost::mutex mtx_solved, mtx_space, mtx_allowed;
+  boost::condition_variable_any cond_solved, cond_allowed;
+  size_t allowed;
+  std::atomic<bool> stop;
+  std::atomic<long> propagated;
+
+  QueuePipeline() : inboxes(producers), allowed(threads), stop(false),
+      propagated(0) {}
+
+  void search() {
+    for (size_t k = 0; !stop; ++k) {
+      {
+        GETLOCK(mtx_allowed, lk);
+        while (!allowed && !stop)
+          CONDWAIT(cond_allowed, lk);
+        if (stop)
+          return;
+        --allowed;
+      }
+      if (inboxes.empty() || k % (inboxes.size() + 1) == 0) {
+        GETLOCK(mtx_space, lk);
+        work(searchWork);
+        GETLOCK(mtx_solved, lk2);
+        leaves.push(1);
+        cond_solved.notify_one();
+      } else {
+        Inbox& in = inboxes[k % (inboxes.size() + 1) - 1];
+        GETLOCK(in.mtx, lk);
+        in.jobs.push(2);
+        in.cond.notify_one();
+      }
+    }
+  }
+  void producer(size_t i) {
+    Inbox& in = inboxes[i];
+    while (!stop) {
+      long x;
+      {
+        GETLOCK(in.mtx, lk);
+        while (in.jobs.empty() && !stop)
+          CONDWAIT(in.cond, lk);
+        if (stop)
+          return;
+        x = in.jobs.front();
+        in.jobs.pop();
+      }
+      GETLOCK(mtx_solved, lk);
+      solved.push(x);
+      cond_solved.notify_one();
+    }
+  }
+  void propagate() {
+    while (!stop) {
+      size_t n = 0;
+      bool more = false;
+      do {
+        {
+          GETLOCK(mtx_solved, lk);
+          while (leaves.empty() && solved.empty() && !stop)
+            CONDWAIT(cond_solved, lk);
+          if (stop)
+            return;
+          if (!leaves.empty())
+            leaves.pop();
+          else
+            solved.pop();
+        }
+        {
+          GETLOCK(mtx_space, lk);
+          work(propWork);
+          work(freeWork);
+        }
+        ++n;
+        ++propagated;
+        GETLOCK(mtx_solved, lk);
+        more = !leaves.empty() || !solved.empty();
+      } while (more);
+      GETLOCK(mtx_allowed, lk);
+      allowed += n;
+      cond_allowed.notify_all();
+    }
+  }
+  void wake() {
+    { GETLOCK(mtx_solved, lk); cond_solved.notify_all(); }
+    { GETLOCK(mtx_allowed, lk); cond_allowed.notify_all(); }
+    for (size_t i = 0; i < inboxes.size(); ++i) {
+      GETLOCK(inboxes[i].mtx, lk);
+      inboxes[i].cond.notify_all();
+    }
+  }
+};
+
+/* the master now: ring buffers, the whole batch propagated under one lock,
+ * solved subproblems freed after releasing it */
+struct RingPipeline {
+  struct Inbox {
+    RingBuffer<long> jobs;
+    RingWaiter wait;
+    Inbox() : jobs(threads) {}
+  };
+  vector<Inbox*> inboxes;
+  RingBuffer<long> leaves, solved;
+  RingWaiter waitPropagate, waitAllowed;
+  boost::mutex mtx_space;
+  std::atomic<size_t> allowed;
+  std::atomic<bool> stop;
+  std::atomic<long> propagated;
+
+  RingPipeline() : leaves(threads), solved(threads), allowed(threads),
+      stop(false), propagated(0) {
+    for (int i = 0; i < producers; ++i)
+      inboxes.push_back(new Inbox());
+  }
+  ~RingPipeline() {
+    for (size_t i = 0; i < inboxes.size(); ++i)
+      delete inboxes[i];
+  }
+
+  void search() {
+    for (size_t k = 0; !stop; ++k) {
+      waitAllowed.wait([this]() { return allowed.load() > 0 || stop; });
+      if (stop)
+        return;
+      --allowed;
+      if (inboxes.empty() || k % (inboxes.size() + 1) == 0) {
+        {
+          GETLOCK(mtx_space, lk);
+          work(searchWork);
+        }
+        leaves.push(1);
+        waitPropagate.notify();
+      } else {
+        Inbox* in = inboxes[k % (inboxes.size() + 1) - 1];
+        in->jobs.push(2);
+        in->wait.notify();
+      }
+    }
+  }
+  void producer(size_t i) {
+    Inbox* in = inboxes[i];
+    while (!stop) {
+      in->wait.wait([in, this]() { return !in->jobs.empty() || stop; });
+      long x;
+      while (in->jobs.tryPop(x)) {
+        solved.push(x);
+        waitPropagate.notify();
+      }
+    }
+  }
+  void propagate() {
+    vector<long> batch;
+    batch.reserve(2 * threads);
+    while (!stop) {
+      waitPropagate.wait(
+          [this]() { return !leaves.empty() || !solved.empty() || stop; });
+      batch.clear();
+      long x;
+      while (leaves.tryPop(x))
+        batch.push_back(x);
+      while (solved.tryPop(x))
+        batch.push_back(x);
+      if (batch.empty())
+        continue;
+      {
+        GETLOCK(mtx_space, lk);
+        for (size_t i = 0; i < batch.size(); ++i)
+          work(propWork);
+      }
+      allowed += batch.size();
+      waitAllowed.notify();
+      for (size_t i = 0; i < batch.size(); ++i)
+        work(freeWork);
+      propagated += batch.size();
+    }
+  }
+  void wake() {
+    waitPropagate.notify();
+    waitAllowed.notify();
+    for (size_t i = 0; i < inboxes.size(); ++i)
+      inboxes[i]->wait.notify();
+  }
+};
+
+/* runs the pipeline for the given time, returns leaves propagated per second */
+template <class Pipeline>
+double run() {
+  Pipeline p;
+  vector<boost::thread*> ts;
+  ts.push_back(new boost::thread([&p]() { p.propagate(); }));
+  ts.push_back(new boost::thread([&p]() { p.search(); }));
+  for (int i = 0; i < producers; ++i)
+    ts.push_back(new boost::thread([&p, i]() { p.producer(i); }));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  boost::this_thread::sleep(boost::posix_time::milliseconds((long) (runTime * 1000)));
+  long n = p.propagated;
+  double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  p.stop = true;
+  for (vector<boost::thread*>::iterator it = ts.begin(); it != ts.end(); ++it) {
+    // (threads might go back to sleep until they see the stop flag)
+    while (!(*it)->timed_join(boost::posix_time::milliseconds(10)))
+      p.wake();
+    delete *it;
+  }
+  return n / t;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) producers = atoi(argv[1]);
+  if (argc > 2) threads = max(atoi(argv[2]), 1);
+  if (argc > 3) runTime = atof(argv[3]);
+  if (argc > 4) searchWork = atoi(argv[4]);
+  if (argc > 5) propWork = atoi(argv[5]);
+  if (argc > 6) freeWork = atoi(argv[6]);
+
+  printf("%d producers, %d threads, work %d/%d/%d, %u cores\n", producers, threads,
+         searchWork, propWork, freeWork, boost::thread::hardware_concurrency());
+  for (int r = 0; r < 3; ++r) {
+    double before = run<QueuePipeline>();
+    double now = run<RingPipeline>();
+    printf("leaves/s: queues %.0f  ring buffers %.0f  (%+.1f%%)\n", before, now,
+           100.0 * (now - before) / before);
+  }
+  return 0;
+}
@@ -9,7 +9,7 @@
 
 namespace sls4mpe {
 
-daoopt::SLSWrapper* slsWrapper;  // for reporting solutions back
+thread_local daoopt::SLSWrapper* slsWrapper;  // for reporting solutions back
 
 void AssignmentManager::outputCurrentAssignment(FILE* outfile){
 	copyAssignment(tmpAssignment);
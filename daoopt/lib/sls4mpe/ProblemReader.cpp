@@ -15,8 +15,8 @@
 
 namespace sls4mpe {
 
-char bntFileAndFunctionName[1000];
-int inputType = 0; // bn in .simple format
+thread_local char bntFileAndFunctionName[1000];
+thread_local int inputType = 0; // bn in .simple format
 
 void ProblemReader::readNetwork(){
 
@@ -36,6 +36,7 @@ class AssignmentManager; // just such that we know the name;
 #include <cassert>
 #include <vector>
 #include <fstream>
+#include <atomic>
 
 namespace sls4mpe {
 /************************************/
@@ -100,93 +101,102 @@ struct instantiation{
 };
 
 //Parameter:
-extern int maxRuns;
-extern double maxTime;
-extern int maxIterations;
-extern long maxSteps;
-
-extern bool global_abort;
-
-extern int caching;
-extern int init_algo;
-extern int pertubationType;
-
-extern int noout;
-extern int output_res;
-extern bool onlyConvertToBNT;
-
-extern int output_to_stdout;
-extern int output_lm;
-extern bool justStats;
-extern int output_runstats;
-extern int output_trajectory;
-
-extern char sls_filename[1000];
-extern char res_filename[1000];
-extern char network_filename[1000];
-extern char traj_it_filename[1000];
-extern char traj_fl_filename[1000];
-extern FILE *outfile;
-extern FILE *resfile;
-extern FILE *traj_it_file;
-extern FILE *traj_fl_file;
+extern thread_local int maxRuns;
+extern thread_local double maxTime;
+extern thread_local int maxIterations;
+extern thread_local long maxSteps;
+
+//=== All engine state below is thread_local, so that several runs can
+//=== proceed concurrently in different threads. global_abort stops every
+//=== run in the process, run_abort (if set) only the calling thread's run.
+//=== Limits: one engine per thread at a time, and settings outlive a run
+//=== in its thread (reset_parameters() restores the defaults, which
+//=== SLSWrapper does before every run).
+extern std::atomic<bool> global_abort;
+extern thread_local const std::atomic<bool>* run_abort;
+extern thread_local long initial_seed;
+bool aborted();
+
+extern thread_local int caching;
+extern thread_local int init_algo;
+extern thread_local int pertubationType;
+
+extern thread_local int noout;
+extern thread_local int output_res;
+extern thread_local bool onlyConvertToBNT;
+
+extern thread_local int output_to_stdout;
+extern thread_local int output_lm;
+extern thread_local bool justStats;
+extern thread_local int output_runstats;
+extern thread_local int output_trajectory;
+
+extern thread_local char sls_filename[1000];
+extern thread_local char res_filename[1000];
+extern thread_local char network_filename[1000];
+extern thread_local char traj_it_filename[1000];
+extern thread_local char traj_fl_filename[1000];
+extern thread_local FILE *outfile;
+extern thread_local FILE *resfile;
+extern thread_local FILE *traj_it_file;
+extern thread_local FILE *traj_fl_file;
 
 // old ILS params
-extern double tmult;
-extern double tdiv;
-extern double tmin;
-extern double tbase;
-extern double T;
-extern int pertubationType;
-extern int num_vns_pertubation_strength;
-extern int mbPertubation;
-extern bool vns;
-extern int restartNumFactor;
-extern bool pertubationFixVars;
-extern bool pertubation_rel;
-extern double psp_base;
-extern double psa_base;
-extern int tl;
-extern int accCriterion;
-extern double worseningInterval;
-extern double accNoise;
+extern thread_local double tmult;
+extern thread_local double tdiv;
+extern thread_local double tmin;
+extern thread_local double tbase;
+extern thread_local double T;
+extern thread_local int pertubationType;
+extern thread_local int num_vns_pertubation_strength;
+extern thread_local int mbPertubation;
+extern thread_local bool vns;
+extern thread_local int restartNumFactor;
+extern thread_local bool pertubationFixVars;
+extern thread_local bool pertubation_rel;
+extern thread_local double psp_base;
+extern thread_local double psa_base;
+extern thread_local int tl;
+extern thread_local int accCriterion;
+extern thread_local double worseningInterval;
+extern thread_local double accNoise;
 
 //old GLS params
-extern double glsPenaltyIncrement;
-extern int glsAspiration;
+extern thread_local double glsPenaltyIncrement;
+extern thread_local int glsAspiration;
 
 // actual ILS params;
-extern int pertubation_strength;
-extern double preprocessingSizeBound;
-extern double maxMBWeight;
-extern double glsSmooth;
-extern int glsInterval;
-extern int noise;
-extern double cutoff;
-
-extern double run_time_so_far;
-
-extern bool outputBestMPE;
-extern AssignmentManager* assignmentManager;
-extern double log_prob;
-extern int num_vars;
-extern int num_pots;
-extern bool* isgoodvar;
-extern struct fheap *heapOfGoodVars;
-extern int glsReal;
-extern int algo;
-extern double glsPenaltyMultFactor;
-
-extern ProbabilityTable** probTables;
-extern Variable** variables;
+extern thread_local int pertubation_strength;
+extern thread_local double preprocessingSizeBound;
+extern thread_local double maxMBWeight;
+extern thread_local double glsSmooth;
+extern thread_local int glsInterval;
+extern thread_local int noise;
+extern thread_local double cutoff;
+
+extern thread_local double run_time_so_far;
+
+extern thread_local bool outputBestMPE;
+extern thread_local AssignmentManager* assignmentManager;
+extern thread_local double log_prob;
+extern thread_local int num_vars;
+extern thread_local int num_pots;
+extern thread_local bool* isgoodvar;
+extern thread_local struct fheap *heapOfGoodVars;
+extern thread_local int glsReal;
+extern thread_local int algo;
+extern thread_local double glsPenaltyMultFactor;
+
+extern thread_local ProbabilityTable** probTables;
+extern thread_local Variable** variables;
 //extern AssignmentManager* assignmentManager;
 
 const int NUM_BP_VARS = 100000;
-extern int externalInitValues[NUM_BP_VARS];
+extern thread_local int externalInitValues[NUM_BP_VARS];
 
-extern bool verbose;
+extern thread_local bool verbose;
 
-extern daoopt::SLSWrapper* slsWrapper;
+extern thread_local daoopt::SLSWrapper* slsWrapper;
 
 }  // sls4mpe
 
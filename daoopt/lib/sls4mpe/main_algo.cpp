@@ -22,94 +22,96 @@ namespace sls4mpe {
 
 #define FORBIDDEN(var,val) (variables[(var)]->fixed || num_flip <= variables[(var)]->tabuValues[(val)]+tl || variables[(var)]->value == (val))
 
-int num_vars;
-int num_pots;
-int numVarValCombos;
-
-AssignmentManager* assignmentManager;
-ProblemReader* pR;
-MiniBucketElimination* mbeElim;
-ProbabilityTable** probTables;
-Variable** variables;
-int* mbAssignment;
-int* fakeEvidenceForMB;
-int numFakeEvidenceForMB;
-bool* isgoodvar;
-int* initValues;
-int externalInitValues[NUM_BP_VARS];
-int MAXVARS_IN_FACTOR = 30;
+thread_local int num_vars;
+thread_local int num_pots;
+thread_local int numVarValCombos;
+
+thread_local AssignmentManager* assignmentManager;
+thread_local ProblemReader* pR;
+thread_local MiniBucketElimination* mbeElim;
+thread_local ProbabilityTable** probTables;
+thread_local Variable** variables;
+thread_local int* mbAssignment;
+thread_local int* fakeEvidenceForMB;
+thread_local int numFakeEvidenceForMB;
+thread_local bool* isgoodvar;
+thread_local int* initValues;
+thread_local int externalInitValues[NUM_BP_VARS];
+thread_local int MAXVARS_IN_FACTOR = 30;
 
 /*********************************************/
 /* Main changing data structures			 */
 /*********************************************/
 
-int num_run;
-long num_flip;
-long num_iteration;
-int abort_flag;
-double log_prob;
-double last_log_prob;
-long last_steps;
-int *last_ils_value;
-int num_flipped_since_last_ils_solution;
-int *flipped_since_last_ils_solution;
-int *value_of_flipped_in_last_ils_solution;
-int *vns_pertubation_strength;
-int num_vns_pertubation_strength = 5;
-bool onlyConvertToBNT = false;
+thread_local int num_run;
+thread_local long num_flip;
+thread_local long num_iteration;
+thread_local int abort_flag;
+thread_local double log_prob;
+thread_local double last_log_prob;
+thread_local long last_steps;
+thread_local int *last_ils_value;
+thread_local int num_flipped_since_last_ils_solution;
+thread_local int *flipped_since_last_ils_solution;
+thread_local int *value_of_flipped_in_last_ils_solution;
+thread_local int *vns_pertubation_strength;
+thread_local int num_vns_pertubation_strength = 5;
+thread_local bool onlyConvertToBNT = false;
 
 //=== Variables we only need in one function, but which need allocation.
 
-int *best_vars;
-int *best_vals;
+thread_local int *best_vars;
+thread_local int *best_vals;
 
-double *single_goods;
-double *sample_probs;
+thread_local double *single_goods;
+thread_local double *sample_probs;
 
 
 /*****************************************************/
 /* Global flags and parameters with default values   */
 /*****************************************************/
-bool outputBestMPE = true;
-int maxRuns = 10;
+thread_local bool outputBestMPE = true;
+thread_local int maxRuns = 10;
 
-int maxIterations = BIG;
-double maxTime = BIG;
-long int maxSteps = BIG;
+thread_local int maxIterations = BIG;
+thread_local double maxTime = BIG;
+thread_local long int maxSteps = BIG;
 
-bool global_abort = false;
+std::atomic<bool> global_abort(false);
+thread_local const std::atomic<bool>* run_abort = NULL;
+thread_local long initial_seed = 1;
 
-int caching = CACHING_GOOD_VARS;
-int algo = ALGO_GLS; // ALGO_ILS
+thread_local int caching = CACHING_GOOD_VARS;
+thread_local int algo = ALGO_GLS; // ALGO_ILS
 
-int tl = 0;
-bool tl_rel = false;//true;
+thread_local int tl = 0;
+thread_local bool tl_rel = false;//true;
 
-int mbPertubation = 0;
-double mbInitWeight = 1e5;
-double mbInitWeightForHybrid = 1e4;
-double maxMBWeight = 1e7;
-double psp_base = 1;
-double psa_base = 1; // 1;
+thread_local int mbPertubation = 0;
+thread_local double mbInitWeight = 1e5;
+thread_local double mbInitWeightForHybrid = 1e4;
+thread_local double maxMBWeight = 1e7;
+thread_local double psp_base = 1;
+thread_local double psa_base = 1; // 1;
 
-double preprocessingSizeBound = 1000;
-double preprocessingTime;
+thread_local double preprocessingSizeBound = 1000;
+thread_local double preprocessingTime;
 
-int glsReal = 1;
-double glsPenaltyMultFactor = 10000;
-double glsPenaltyIncrement = 1.0;
-double glsSmooth = 0.999;
-int glsInterval = 200;
-int glsAspiration = 0;
+thread_local int glsReal = 1;
+thread_local double glsPenaltyMultFactor = 10000;
+thread_local double glsPenaltyIncrement = 1.0;
+thread_local double glsSmooth = 0.999;
+thread_local int glsInterval = 200;
+thread_local int glsAspiration = 0;
 
-double tmult = 1.01;
-double tdiv = 2;
-double tmin = 0.001;
-double e = 2.7182818285;
-double tbase = e;
-double T = 0.01;
+thread_local double tmult = 1.01;
+thread_local double tdiv = 2;
+thread_local double tmin = 0.001;
+thread_local double e = 2.7182818285;
+thread_local double tbase = e;
+thread_local double T = 0.01;
 
-bool verbose = false;
+thread_local bool verbose = false;
 
 /*
 int init_algo = INIT_RANDOM;
@@ -130,77 +132,77 @@ double accNoise = 0.01;
 
 
 ///*
-int init_algo = INIT_MB;
+thread_local int init_algo = INIT_MB;
 
 //=== Parameters of the pertubation.
-int pertubationType = PERTUBATION_RANDOM_POTS_RANDOM_INDEX; // 0:random vars with random outcome
-bool vns = false;
-bool pertubationFixVars = true;
-int pertubation_strength = 2;
-bool pertubation_rel = false;
+thread_local int pertubationType = PERTUBATION_RANDOM_POTS_RANDOM_INDEX; // 0:random vars with random outcome
+thread_local bool vns = false;
+thread_local bool pertubationFixVars = true;
+thread_local int pertubation_strength = 2;
+thread_local bool pertubation_rel = false;
 
 //=== Parameters of the acceptance criterion.
-int accCriterion = ACC_BETTER_RW;//ACC_RW_AFTER_N2;
-int restartNumFactor = 5;
-double worseningInterval = 5; // was absolute 100 and performed very well.
-double accNoise = 0.01;
+thread_local int accCriterion = ACC_BETTER_RW;//ACC_RW_AFTER_N2;
+thread_local int restartNumFactor = 5;
+thread_local double worseningInterval = 5; // was absolute 100 and performed very well.
+thread_local double accNoise = 0.01;
 //*/
 
 
-int noise = 40;
-double cutoff = 10;
+thread_local int noise = 40;
+thread_local double cutoff = 10;
 
-int start_iteration_of_current_try;
-int save_pertubation_strength = NOVALUE;
-int output_to_stdout = 0;
-int output_lm = 0;
-int output_trajectory = 0;
-int output_runstats = 0;
-int output_res = 0;
-int noout = 0;
-bool justStats;
+thread_local int start_iteration_of_current_try;
+thread_local int save_pertubation_strength = NOVALUE;
+thread_local int output_to_stdout = 0;
+thread_local int output_lm = 0;
+thread_local int output_trajectory = 0;
+thread_local int output_runstats = 0;
+thread_local int output_res = 0;
+thread_local int noout = 0;
+thread_local bool justStats;
 
 /********************************************************
          Program internal parameters.
  ********************************************************/
-int seedThisRun;
-int num_good_vars;
-int *good_vars; // good_vars[j] = var <=> Flipping var can increase log_prob.
-struct fheap *heapOfGoodVars;
+thread_local int seedThisRun;
+thread_local int num_good_vars;
+thread_local int *good_vars; // good_vars[j] = var <=> Flipping var can increase log_prob.
+thread_local struct fheap *heapOfGoodVars;
 
-int *vars_permuted;
-int num_vars_permuted;
+thread_local int *vars_permuted;
+thread_local int num_vars_permuted;
 
-int num_pots_flipped;
-int *pots_flipped;    // pots_flipped[j] = pot <=> pot has been flipped in current pertubation.
+thread_local int num_pots_flipped;
+thread_local int *pots_flipped;    // pots_flipped[j] = pot <=> pot has been flipped in current pertubation.
 
-long lastImprovingIteration;
-double best_logprob_this_try;
+thread_local long lastImprovingIteration;
+thread_local double best_logprob_this_try;
 /************************************/
 /* Statistics                       */
 /************************************/
-int inducedWidth; // along the min-degree ordering
-double inducedWeight; // along the min-degree ordering
-double run_time_so_far;
-double bestQualNotAccepted;
-int *bestNotAccepted;
+thread_local int inducedWidth; // along the min-degree ordering
+thread_local double inducedWeight; // along the min-degree ordering
+thread_local double run_time_so_far;
+thread_local double bestQualNotAccepted;
+thread_local int *bestNotAccepted;
 
-double overall_time_so_far;
-time_t timestamp_start;
+thread_local double overall_time_so_far;
+thread_local time_t timestamp_start;
 
-double init_time;
-double runInitTime;
+thread_local double init_time;
+thread_local double runInitTime;
 
-FILE *outfile = stdout;
-FILE *resfile;
-FILE *traj_it_file;
-FILE *traj_fl_file;
+thread_local FILE *outfile = stdout;
+thread_local FILE *resfile;
+thread_local FILE *traj_it_file;
+thread_local FILE *traj_fl_file;
 
-char network_filename[1000];
-char sls_filename[1000];
-char res_filename[1000];
-char traj_it_filename[1000];
-char traj_fl_filename[1000];
+thread_local char network_filename[1000];
+thread_local char sls_filename[1000];
+thread_local char res_filename[1000];
+thread_local char traj_it_filename[1000];
+thread_local char traj_fl_filename[1000];
 
 /********************************************************
  ========================================================
@@ -208,12 +210,84 @@ char traj_fl_filename[1000];
  ========================================================
  ********************************************************/
 
+/********************************************************
+           RESET PARAMETERS
+ Restores the defaults above. The engine state is per
+ thread, so a run would otherwise inherit the settings
+ of the previous run in the same thread.
+ ********************************************************/
+void reset_parameters(){
+	MAXVARS_IN_FACTOR = 30;
+	num_vns_pertubation_strength = 5;
+	onlyConvertToBNT = false;
+
+	outputBestMPE = true;
+	maxRuns = 10;
+	maxIterations = BIG;
+	maxTime = BIG;
+	maxSteps = BIG;
+	run_abort = NULL;
+	initial_seed = 1;
+
+	caching = CACHING_GOOD_VARS;
+	algo = ALGO_GLS;
+	tl = 0;
+	tl_rel = false;
+
+	mbPertubation = 0;
+	mbInitWeight = 1e5;
+	mbInitWeightForHybrid = 1e4;
+	maxMBWeight = 1e7;
+	psp_base = 1;
+	psa_base = 1;
+	preprocessingSizeBound = 1000;
+
+	glsReal = 1;
+	glsPenaltyMultFactor = 10000;
+	glsPenaltyIncrement = 1.0;
+	glsSmooth = 0.999;
+	glsInterval = 200;
+	glsAspiration = 0;
+
+	tmult = 1.01;
+	tdiv = 2;
+	tmin = 0.001;
+	tbase = e;
+	T = 0.01;
+
+	verbose = false;
+
+	init_algo = INIT_MB;
+	pertubationType = PERTUBATION_RANDOM_POTS_RANDOM_INDEX;
+	vns = false;
+	pertubationFixVars = true;
+	pertubation_strength = 2;
+	pertubation_rel = false;
+	accCriterion = ACC_BETTER_RW;
+	restartNumFactor = 5;
+	worseningInterval = 5;
+	accNoise = 0.01;
+
+	noise = 40;
+	cutoff = 10;
+	save_pertubation_strength = NOVALUE;
+	output_to_stdout = 0;
+	output_lm = 0;
+	output_trajectory = 0;
+	output_runstats = 0;
+	output_res = 0;
+	noout = 0;
+	justStats = false;
+	outfile = stdout;
+}
+
 /********************************************************
            INIT PROBLEM
  Initializes the problem once to begin with.
  ********************************************************/
 void first_init(){
-	seed = 1; // DON'T SET IT TO 0 !!! Thomas' random number generator will only return zeros then !!!
+	seed = initial_seed; // DON'T SET IT TO 0 !!! Thomas' random number generator will only return zeros then !!!
+	if (seed == 0) seed = 1;
 
 	//=== Init globals.
 	preprocessingTime = 0;
@@ -272,8 +346,6 @@ void deallocateVarsAndPTs(bool name) {
 void runAlgorithm(int **outBestAssignment, double *outLogLikelihood){
 	if(preprocessingSizeBound > 0) outputBestMPE = false;
 
-    global_abort = false;
-
 //	assignmentManager = new AssignmentManager();
 //	pR = new ProblemReader();
 	mbeElim = new MiniBucketElimination();
@@ -293,7 +365,7 @@ void runAlgorithm(int **outBestAssignment, double *outLogLikelihood){
 		anytime_mb();
 		end_run();
 	} else {
-		while ((!global_abort) && ! abort_flag && num_run < maxRuns) {
+		while ((!aborted()) && ! abort_flag && num_run < maxRuns) {
 			init_run();
 			switch(algo) {
 				case ALGO_GN:
@@ -339,8 +411,6 @@ void runAlgorithm(int **outBestAssignment, double *outLogLikelihood, bool& m_sol
 	m_num_trial = 1; // by default try at least once
 	m_time_elapsed = 0.0; // record global time for conveience
 
-	global_abort = false; // when this is true, while loop stops but we don't use this yet
-
 	/* sls4mpe initialization except creation of assingmnet manager, problem reader */
 	mbeElim = new MiniBucketElimination();
 	first_init();
@@ -353,8 +423,8 @@ void runAlgorithm(int **outBestAssignment, double *outLogLikelihood, bool& m_sol
 	double elapsed = difftime(now, timestamp_start);
 	fprintf(stdout, "Preprocessing for SLS complete: %i seconds\n", int(elapsed));
 
-	while ((!global_abort) && !abort_flag && num_run < maxRuns && !m_solution_found) { // maxRuns set to 1 or more
-	//while ((!global_abort) && !abort_flag && num_run < maxRuns) { // maxRuns set to 1 or more
+	while ((!aborted()) && !abort_flag && num_run < maxRuns && !m_solution_found) { // maxRuns set to 1 or more
+	//while ((!aborted()) && !abort_flag && num_run < maxRuns) { // maxRuns set to 1 or more
 #ifdef _DEBUG
 		std::cout << " sls debug run : " << m_num_trial << std::endl;
 #endif
@@ -553,8 +623,12 @@ void mb_ils_hybrid(){
 /*****************************************************/
 /* MAIN ALGORITHMS                                   */
 /*****************************************************/
+bool aborted(){
+	return global_abort || (run_abort && *run_abort);
+}
+
 bool lsContinue(){
-	return (!global_abort) && run_time_so_far < maxTime
+	return (!aborted()) && run_time_so_far < maxTime
 		  && num_flip < maxSteps
 			&& assignmentManager->runBestLogProb+EPS < assignmentManager->optimalLogMPEValue;
 }
@@ -725,7 +799,7 @@ bool lsContinueInc(double converge_rate){
 	std::cout << "converge_rate * assignmentManager->runBestTime : " << converge_rate * assignmentManager->runBestTime << std::endl;
 #endif
 
-	return (!global_abort) && run_time_so_far < maxTime
+	return (!aborted()) && run_time_so_far < maxTime
 		&& num_flip < maxSteps
 		&& assignmentManager->runBestLogProb + EPS < assignmentManager->optimalLogMPEValue
 		&& ((run_time_so_far - assignmentManager->runBestTime) < converge_rate * assignmentManager->runBestTime);
@@ -38,6 +38,7 @@ void allocateVarsAndPTs(bool name);
 void deallocateVarsAndPTs(bool name);
 void allocateMemoryForDataStructures(bool deleteFirst);
 void tearDown();
+void reset_parameters();
 void first_init();
 void read_problem(int argc,char *argv[]);
 
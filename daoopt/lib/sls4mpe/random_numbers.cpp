@@ -9,7 +9,7 @@
 
 namespace sls4mpe {
 
-long int seed;
+thread_local long int seed;
 
 double ran01( long *idum )
 /*    
@@ -17,7 +17,7 @@
 
 namespace sls4mpe {
 
-extern long seed;
+extern thread_local long seed;
 
 double ran01 ( long *idum );
 
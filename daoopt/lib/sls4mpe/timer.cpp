@@ -7,26 +7,39 @@
 
 #include "sls4mpe/timer.h"
 
+#include <chrono>
+
 namespace sls4mpe {
 
 /********************************************************
            IMPORTANT: Windows returns wall clock time,
 					            UNIX    returns CPU time.
+           (timer.h forces NT, so we measure wall clock
+            time everywhere; clock() would count the CPU
+            time of all concurrent SLS threads together.)
  ********************************************************/
 
 //=== When timer was initialized or elapsed seconds was called the last time.
-double lastTime;
+//=== Kept per thread, like the rest of the engine state.
+thread_local double lastTime;
 
 #ifndef NT
 	//! Data structure for retrieving net computation time information via library calls from the operating system. 
-	static struct rusage res;
+	static thread_local struct rusage res;
+	//=== Only count the calling thread, so concurrent runs don't eat each other's time budget.
+	#ifdef RUSAGE_THREAD
+		#define SLS_RUSAGE_WHO RUSAGE_THREAD
+	#else
+		#define SLS_RUSAGE_WHO RUSAGE_SELF
+	#endif
 #endif
 
 void start_timer(){
 	#ifdef NT
-		lastTime = clock();
+		lastTime = std::chrono::duration<double>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
 	#else
-    getrusage( RUSAGE_SELF, &res );
+    getrusage( SLS_RUSAGE_WHO, &res );
     lastTime = (double) res.ru_utime.tv_sec +
 		   (double) res.ru_stime.tv_sec +
 		   (double) res.ru_utime.tv_usec / 1000000.0 +
@@ -37,10 +50,11 @@ void start_timer(){
 double elapsed_seconds(){
 	double result = -1, thisTime = -1;
 	#ifdef NT
-		thisTime = clock();
-		result = (thisTime - lastTime) / CLOCKS_PER_SEC;;
+		thisTime = std::chrono::duration<double>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		result = thisTime - lastTime;
 	#else
-    getrusage( RUSAGE_SELF, &res );
+    getrusage( SLS_RUSAGE_WHO, &res );
     thisTime =
 			(double) res.ru_utime.tv_sec +
       (double) res.ru_stime.tv_sec +
@@ -36,11 +36,11 @@ bool AOStar::solve(size_t nodeLimit) {
 
   if (emergency_memory) delete[] emergency_memory;
 
-  if (timed_out_ || best_first_limit_reached_) {
+  if (m_timedOut || best_first_limit_reached_) {
     high_resolution_clock::time_point time_now = high_resolution_clock::now();
     double time_elapsed =
       duration_cast<duration<double>>(time_now - _time_start).count();
-    if (timed_out_) {
+    if (m_timedOut) {
       cout << "TIMED OUT at ";
     } else if (best_first_limit_reached_) {
       cout << "OUT OF MEMORY at ";
@@ -74,11 +74,13 @@ bool AOStar::DoSearch() {
     assert(tip_nodes_.size() > 0);
     high_resolution_clock::time_point time_now = high_resolution_clock::now();
     double time_elapsed =
-      duration_cast<duration<double>>(time_now - _time_start).count();
+      duration_cast<duration<double>>(time_now - m_timeStart).count();
     if (time_elapsed > m_options->maxTime) {
-      timed_out_ = true;
+      m_timedOut = true;
       return false;
     }
+    if (isAborted())
+      return false;
     ArrangeTipNodes();
     BFSearchNode* n = ChooseTipNode();
     ExpandAndRevise(n);
@@ -86,7 +88,9 @@ bool AOStar::DoSearch() {
 
   if (root->is_solved()) {
     solution_cost_ = root->getValue();
-    m_problem->updateUpperBound(heuristic_bound_, &(search_space_->stats));
+    // (with a weighted heuristic, the root value only bounds this search)
+    if (m_weight == 1.0)
+      m_problem->updateUpperBound(heuristic_bound_, &(search_space_->stats));
     m_problem->updateSolution(solution_cost_, &(search_space_->stats));
   }
 
@@ -351,7 +355,7 @@ bool AOStar::Revise(BFSearchNode* node) {
     if (change && node == search_space_->getRoot()) {
       if (heuristic_bound_ - q_value > 1e-10) {
         heuristic_bound_ = q_value;
-        if (m_options->algorithm != "aaobf") {
+        if (m_options->algorithm != "aaobf" && m_weight == 1.0) {
           high_resolution_clock::time_point now = high_resolution_clock::now();
           double t = duration_cast<duration<double>>(now - _time_start).count();
           if (prev_reported_time_ < 0 || t - prev_reported_time_ > 5) {
@@ -478,7 +482,6 @@ AOStar::AOStar(Problem* p, Pseudotree* pt, SearchSpace* space,
                      ProgramOptions* po)
 : Search(p, pt, space, heur, prop, po), global_search_index_(0),
   best_first_limit_reached_(false),
-  timed_out_(false),
   comp_node_ordering_heur_desc_fn_(NodeOrderingHeurDesc()) {
   search_space_ = dynamic_cast<BFSearchSpace*>(space);
   initSearch();
@@ -113,7 +113,6 @@ class AOStar : virtual public Search {
   std::vector<SearchNode*> tip_nodes_;
 
   bool best_first_limit_reached_;
-  bool timed_out_;
 
   BFSearchSpace* search_space_;
   size_t global_search_index_;
@@ -36,11 +36,13 @@ bool AnytimeAOStar::DoSearch() {
   while (!root->is_solved()) {
     high_resolution_clock::time_point time_now = high_resolution_clock::now();
     double time_elapsed =
-      duration_cast<duration<double>>(time_now - _time_start).count();
+      duration_cast<duration<double>>(time_now - m_timeStart).count();
     if (time_elapsed > m_options->maxTime) {
-      timed_out_ = true;
+      m_timedOut = true;
       return false;
     }
+    if (isAborted())
+      return false;
     BFSearchNode* next = nullptr;
     if (!tip_nodes_feasible_.empty()) {
       m_assignment = assignment_feasible_;
@@ -21,6 +21,11 @@ class BFSearchNode : public SearchNode {
     heur_updated_ = f;
   }
 
+  // best-first search doesn't cache ancestor pruning thresholds
+  void setAncestorBound(double d, size_t epoch) { }
+  double getAncestorBound() const { return ELEM_ZERO; }
+  size_t getAncestorBoundEpoch() const { return 0; }
+
   inline BFSearchNode* current_parent() const {
     return current_parent_;
   }
@@ -209,6 +214,10 @@ class BFSearchNodeAND : public BFSearchNode {
   double getInitialBound() const { assert(false); return 0; }
   void setComplexityEstimate(double d) { assert(false); }
   double getComplexityEstimate() const { assert(false); return 0; }
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
+  void setSubprobContext(const context_t& t) { assert(false); }
+  const context_t& getSubprobContext() const { assert(false); return emptyCtxt; }
+#endif
 
   void setCacheContext(const context_t& c) { }
   const context_t& getCacheContext() const { return SearchNode::emptyCtxt; }
@@ -253,6 +262,10 @@ class BFSearchNodeOR : public BFSearchNode {
 
   void setComplexityEstimate(double d) { assert(false); }
   double getComplexityEstimate() const { assert(false); return 0; }
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
+  void setSubprobContext(const context_t& t) { assert(false); }
+  const context_t& getSubprobContext() const { assert(false); return emptyCtxt; }
+#endif
 
   void getPST(vector<double>& pst) const;
 
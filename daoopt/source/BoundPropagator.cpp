@@ -28,9 +28,39 @@
 
 namespace daoopt {
 
-SearchNode* BoundPropagator::propagate(SearchNode* n,
-                                       vector<vector<bool>>& currentDomains,
-                                       bool reportSolution, SearchNode* upperLimit) {
+SearchNode* BoundPropagator::propagate(SearchNode* n, bool reportSolution, SearchNode* upperLimit) {
+  SearchNode* res;
+  // (there's no optimal assignment to a sum)
+  if (m_sumTask)
+    res = propagate<SumProduct, NoAssignment>(n, reportSolution, upperLimit);
+  else if (m_trackAssignment)
+    res = propagate<MaxProduct, TrackAssignment>(n, reportSolution, upperLimit);
+  else
+    res = propagate<MaxProduct, NoAssignment>(n, reportSolution, upperLimit);
+
+  // bound the delay of new solutions reaching the root
+  if (m_lazyInterval && !m_flushing && ++m_lazyCount >= m_lazyInterval)
+    flush(reportSolution);
+  return res;
+}
+
+
+void BoundPropagator::flush(bool reportSolution) {
+  m_flushing = true;
+  while (!m_deferred.empty()) {
+    SearchNode* n = m_deferred.back();
+    m_deferred.pop_back();
+    // only propagates values, nothing above n gets deleted
+    propagate(n, reportSolution, n);
+    // (values above the path to n changed, including n's ancestor bound)
+    m_space->boundEpoch += 1;
+  }
+  m_lazyCount = 0;
+  m_flushing = false;
+}
+
+template <class Semiring, class Assignment>
+SearchNode* BoundPropagator::propagate(SearchNode* n, bool reportSolution, SearchNode* upperLimit) {
 
   // these two pointers move upward in the search space, always one level
   // apart s.t. cur is the parent node of prev
@@ -40,14 +70,22 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
   // where .second will be deleted as a child of .first
   pair<SearchNode*,SearchNode*> highestDelete(NULL,NULL);
 
-  int numBacktracks = 0;
-  list<pair<SearchNode*, SearchNode*>> backtracks;
+  // earliest constraint propagation trail position among deleted AND nodes
+  size_t cpMark = ConstraintPropagator::NO_MARK;
 
   // 'prop' signals whether we are still propagating values in this call
   bool prop = true;
   // 'del' signals whether we are still deleting nodes in this call
   bool del = (upperLimit!=n) ? true : false;
 
+  // number of OR node values updated in this call; beyond the first one,
+  // cached ancestor pruning thresholds below them become too loose
+  int orUpdates = 0;
+
+  // the node the propagated values originate from; with lazy propagation,
+  // a deferred OR node resumes the propagation
+  SearchNode* src = n;
+
 #ifdef PARALLEL_STATIC
   count_t subCount = 0;
 #endif
@@ -79,7 +117,7 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
         NodeP* children = cur->getChildren();
         for (size_t i = 0; i < cur->getChildCountFull(); ++i) {
           if (children[i]) {
-            d OP_TIMESEQ children[i]->getValue();
+            d = Semiring::times(d, children[i]->getValue());
 //            cout << *children[i] << " : " << children[i]->getValue() << endl;
           }
         }
@@ -90,10 +128,6 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
 
         if ( ISNAN(d) ) {// || d == ELEM_ZERO ) { // not all OR children solved yet, propagation stops here
           prop = false;
-#ifndef NO_ASSIGNMENT
-          //          if (n->getValue() > ELEM_ZERO)  // TODO required?
-          propagateTuple(n, cur); // save (partial) opt. subproblem solution at current AND node
-#endif
         }
 
       }
@@ -105,26 +139,25 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
 #ifndef NO_CACHING
           // prev is OR node, try to cache
           if (m_doCaching && prev->isCachable() && !prev->isNotOpt() ) {
-#ifndef NO_ASSIGNMENT
-            if (m_space->cache->write(prev->getVar(), prev->getCacheInst(), prev->getCacheContext(), prev->getValue(), prev->getOptAssig() ) )
-#else
-            if (m_space->cache->write(prev->getVar(), prev->getCacheInst(), prev->getCacheContext(), prev->getValue() ) )
-#endif
+            if (writeCache(prev, Assignment::enabled))
             {
 #ifdef DEBUG
             cout << "prop finished. " << endl;
               ostringstream ss;
-              ss << "-Cached " << *prev << " with value " << prev->getValue()
-#ifndef NO_ASSIGNMENT
-              << " and opt. solution " << prev->getOptAssig()
-#endif
-              << endl;
+              ss << "-Cached " << *prev << " with value " << prev->getValue();
+              ss << endl;
               myprint(ss.str());
 #endif
             }
           }
 #endif
           highestDelete = make_pair(cur,prev);
+          // an exactly solved dead-end subproblem (OR leaves without
+          // children were learned from when they were generated)
+          if (m_cp && m_cp->isLearning() &&
+              prev->getValue() == Semiring::zero() && !prev->isNotOpt() &&
+              (!prev->isLeaf() || prev->isPruned()))
+            m_deadEnds.push_back(prev->getVar());
 #ifdef PARALLEL_STATIC
           subCount += prev->getSubCount();
           m_subCountCache = subCount;
@@ -150,9 +183,9 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
 //          cout << highestDelete.second->getHeur() << endl;
         } else {
           del = false;
-#ifdef LIKELIHOOD
-          prop = false;
-#endif
+          // a sum is only complete once all of its terms are
+          if (!Semiring::idempotent)
+            prop = false;
         }
 
       }
@@ -162,39 +195,33 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
       // ===========================================================================
 
       if (prop) {
-        double d = prev->getValue() OP_TIMES prev->getLabel(); // getValue includes subSolved
+        double d = Semiring::times(prev->getValue(), prev->getLabel()); // getValue includes subSolved
         DIAG( ostringstream ss; ss << "value to prop : "
                 << prev->getValue() << " + " << prev->getLabel() << " = " << d << endl; myprint(ss.str()); )
-#ifdef LIKELIHOOD
-        if ( ISNAN( cur->getValue() ) || cur->getValue() == ELEM_ZERO )
-          cur->setValue(d);
-        else
-          cur->setValue( OP_PLUS(d,cur->getValue()) );
-#else
-        if ((ISNAN( cur->getValue() ) || d > cur->getValue()) && !prev->isNotOpt()) {
+        if (!Semiring::idempotent) {
+          if ( ISNAN( cur->getValue() ) || cur->getValue() == Semiring::zero() )
+            cur->setValue(d);
+          else
+            cur->setValue( Semiring::plus(d,cur->getValue()) );
+        } else if ((ISNAN( cur->getValue() ) || d > cur->getValue()) && !prev->isNotOpt()) {
           cur->setValue(d); // update max. value
-#ifndef NO_ASSIGNMENT
-          if (m_doCaching && cur->isCachable()) {
-            DIAG(myprint("< Cachable OR node found\n"));
-            propagateTuple(n, cur);
-          }
-#endif
+          if (++orUpdates == 2)
+            m_space->boundEpoch += 1;
+          if (Assignment::enabled)
+            recordSolution(cur, prev);
 //          cout << d  << ": continue prop" << endl;
         } else {
 //          cout << d  << ": no more prop" << endl;
           prop = false; // no more value propagation upwards in this call
         }
-#endif /* LIKELIHOOD */
       }
 
       if (del) {
         if (prev->getChildCountAct() <= 1) { // prev has no or one children?
           highestDelete = make_pair(cur,prev);
 
-          if (cur->getType() == NODE_OR && prev->getType() == NODE_AND) {
-            ++numBacktracks;
-            backtracks.push_back(make_pair(cur, prev));
-          }
+          if (prev->getCPMark() < cpMark)
+            cpMark = prev->getCPMark();
 #ifdef PARALLEL_STATIC
           subCount += prev->getSubCount();
 #endif
@@ -207,9 +234,29 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
 //          cout << highestDelete.second->getHeur() << endl;
         } else {
           del = false;
-#ifdef LIKELIHOOD
+          if (!Semiring::idempotent)
+            prop = false;
+        }
+      }
+
+      // lazy propagation: an improved value of an unfinished subproblem isn't
+      // passed on until the subproblem is finished (or flush() is called)
+      if (m_lazyInterval && Semiring::idempotent &&
+          cur->getParent() && cur != m_space->subproblemLocal) {
+        bool finished = del && cur->getChildCountAct() <= 1 && cur != upperLimit;
+        bool deferred = !m_deferred.empty() && m_deferred.back() == cur;
+        if (m_flushing) {
+          // (flush() walks all deferred nodes, deepest first)
+        } else if (finished) {
+          if (deferred) {  // resume with the final value
+            m_deferred.pop_back();
+            prop = true;
+            src = cur;
+          }
+        } else if (prop) {
+          if (!deferred)
+            m_deferred.push_back(cur);
           prop = false;
-#endif
         }
       }
 
@@ -217,15 +264,11 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
       if (cur == m_space->subproblemLocal) {
         if (del) highestDelete = make_pair(cur,prev);
         DIAG(myprint("PROP reached ROOT\n"));
-        if (prop) {
-#ifndef NO_ASSIGNMENT
-          propagateTuple(n, cur);
-          if (reportSolution)
-            m_problem->updateSolution(cur->getValue(), cur->getOptAssig(), & m_space->stats, true);
-#else
-          if (reportSolution)
+        if (prop && reportSolution) {
+          if (Assignment::enabled)
+            reportAssignment(cur);
+          else
             m_problem->updateSolution(cur->getValue(), & m_space->stats, true);
-#endif
         }
         break;
       }
@@ -249,24 +292,26 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
   } while (cur); // until cur==NULL, i.e. 'parent' of root
 //  cout << "prop finished. " << endl;
 
-  // propagated up to root node, update tuple as well
+  // propagated up to root node, report with tuple if tracked
   if (prop || !cur) {
-#ifndef NO_ASSIGNMENT
-    propagateTuple(n,prev);
-    if (reportSolution)
-      m_problem->updateSolution(prev->getValue(), prev->getOptAssig(), & m_space->stats , true);
-#else
-    if (reportSolution)
-      m_problem->updateSolution(prev->getValue(), & m_space->stats, true);
-#endif
+    if (reportSolution) {
+      if (!Assignment::enabled)
+        m_problem->updateSolution(prev->getValue(), & m_space->stats, true);
+      else if (prop)  // (an unchanged value was reported before, or imported)
+        reportAssignment(prev);
+    }
+    if (reportSolution && prop && m_orderingStats)
+      m_orderingStats->recordIncumbent(src);
   }
 
   if (highestDelete.first) {
     SearchNode* parent = highestDelete.first;
     SearchNode* child = highestDelete.second;
     if(parent->getType() == NODE_AND) {
-      // Store value of OR node to be deleted into AND parent
+      // Store value (and solution) of OR node to be deleted into AND parent
       parent->addSubSolved(child->getValue());
+      if (Assignment::enabled)
+        parent->setSolution(joinSolutions(child->getSolution(), parent->getSolution()));
     }
 #ifdef PARALLEL_STATIC
     parent->addSubCount(subCount);
@@ -277,24 +322,18 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
     parent->addSubLeaves(subLeaves);
     parent->addSubLeafD(subLeafD);
 #endif
-    // Backtrack the SAT solver
-    if (numBacktracks > 0) {
-      assert(numBacktracks == (int)backtracks.size());
-      for (auto backtrack_node_pairs : backtracks) {
-        if (zchaff_solver_) {
-          if (!currentDomains.empty()) {
-            for (auto p : backtrack_node_pairs.second->changes()) {
-              currentDomains[p.first][p.second] = true;
-            }
-          }
-          zchaff_solver_->release_assignments();
-          zchaff_solver_->dlevel()--;
-        }
-      }
+    // undo constraint propagation below the highest deleted AND node
+    if (m_cp && cpMark != ConstraintPropagator::NO_MARK)
+      m_cp->backtrack(cpMark);
+    // (contexts that were partly undone by the backtrack are skipped)
+    for (int var : m_deadEnds) {
+      m_cp->learnDeadEnd(
+          var, m_space->pseudotree->getNode(var)->getFullContextVec());
     }
+    m_deadEnds.clear();
 
     // finally clean up, delete subproblem with unnecessary nodes from memory
-    parent->eraseChild(child);
+    removeChild(parent, child);
   }
 
   DIAG(myprint("! Prop done.\n"));
@@ -303,61 +342,40 @@ SearchNode* BoundPropagator::propagate(SearchNode* n,
 
 }
 
-#ifndef NO_ASSIGNMENT
-
-/* collects the joint assignment from 'start' upwards until 'end' and
- * records it into 'end' for later use */
-void BoundPropagator::propagateTuple(SearchNode* start, SearchNode* end) {
-  assert(start && end);
-  DIAG(ostringstream ss; ss << "< REC opt. assignment from " << *start << " to " << *end << endl; myprint(ss.str());)
-
-  int endVar = end->getVar();
-  const vector<int>& endSubprob = m_space->pseudotree->getNode(endVar)->getSubprobVars();
-
-  // get variable map for end node
-  const vector<int>& endVarMap = m_space->pseudotree->getNode(endVar)->getSubprobVarMap();
-  // allocate assignment in end node
-  vector<val_t>& assig = end->getOptAssig();
-  assig.resize(endSubprob.size(), UNKNOWN);
-
-  int curVar = UNKNOWN, curVal = UNKNOWN;
-  for (SearchNode* cur=start; cur!=end; cur=cur->getParent()) {
-    curVar = cur->getVar();
-
-    if (cur->getType() == NODE_AND) {
-//      cout << "curVar: " << curVar << endl;
-      curVal = cur->getVal();
-//      cout << assig << endl;
-      if (curVal!=UNKNOWN)
-        /*
-        if (curVal != assig[endVarMap.at(curVar)]) {
-          cout << assig[endVarMap.at(curVar)] << "->" << curVal << endl;
-        }
-        */
-        assig.at(endVarMap.at(curVar)) = curVal;
-    }
-
-    if (cur->getOptAssig().size()) {
-      // check previously saved partial assignment
-      const vector<int>& curSubprob = m_space->pseudotree->getNode(cur->getVar())->getSubprobVars();
-      vector<int>::const_iterator itVar = curSubprob.begin();
-      vector<val_t>::const_iterator itVal = cur->getOptAssig().begin();
-
-      for(; itVar!= curSubprob.end(); ++itVar, ++itVal ) {
-        if (*itVal != UNKNOWN)
-          assig[endVarMap[*itVar]] = *itVal;
-      }
+/* records the solution of OR node 'n' through its AND child 'c', which
+ * consists of the solutions of c's solved child subproblems and the current
+ * ones of the remaining children */
+void BoundPropagator::recordSolution(SearchNode* n, SearchNode* c) {
+  assert(n->getType() == NODE_OR && c->getType() == NODE_AND);
+  // (in depth-first search, only the child on the current path is unsolved)
+  SolutionRef first, rest = c->getSolution();
+  NodeP* children = c->getChildren();
+  for (size_t i = 0; i < c->getChildCountFull(); ++i) {
+    if (!children[i])
+      continue;
+    if (first)
+      rest = joinSolutions(children[i]->getSolution(), rest);
+    else
+      first = children[i]->getSolution();
+  }
+  n->setSolution(makeSolution(n->getVar(), c->getVal(), first, rest));
+}
 
-      // clear optimal assignment of AND node, since now propagated upwards
-      if (cur->getType() == NODE_AND)
-        cur->clearOptAssig(); // TODO correct ?
-    }
-  } // end for
 
-  DIAG(ostringstream ss; ss << "< Tuple for "<< *end << " after recording: " << (end->getOptAssig()) << endl; myprint(ss.str());)
+bool BoundPropagator::writeCache(SearchNode* n, bool withSolution) {
+  return withSolution
+      ? m_space->cache->write(n->getVar(), n->getCacheInst(), n->getCacheContext(), n->getValue(), n->getSolution())
+      : m_space->cache->write(n->getVar(), n->getCacheInst(), n->getCacheContext(), n->getValue());
 }
 
 
-#endif // NO_ASSIGNMENT
+/* assembles the assignment recorded at (root) node n and reports it along
+ * with n's value */
+void BoundPropagator::reportAssignment(SearchNode* n) {
+  vector<val_t> tuple;
+  assignSolution(n->getSolution(), m_space->pseudotree, n->getVar(), tuple);
+  DIAG(ostringstream ss; ss << "< Tuple for "<< *n << ": " << tuple << endl; myprint(ss.str());)
+  m_problem->updateSolution(n->getValue(), tuple, & m_space->stats, true);
+}
 
 }  // namespace daoopt
@@ -27,23 +27,41 @@
 #include "SearchSpace.h"
 #include "SearchNode.h"
 #include "Pseudotree.h"
+#include "ProgramOptions.h"
 #ifdef PARALLEL_STATIC
 #include "Statistics.h"
 #endif
 
-#include "zchaff/zchaff_solver.h"
+#include "ConstraintPropagator.h"
+#include "OrderingPolicy.h"
 
 namespace daoopt {
 
+/* policies for BoundPropagator::propagate(): record optimal subproblem
+ * assignments along with the values (-track_assignment) or not */
+struct TrackAssignment { static const bool enabled = true; };
+struct NoAssignment { static const bool enabled = false; };
+
 class BoundPropagator {
 
 protected:
 
   bool m_doCaching;
+  bool m_sumTask;  // sum over solutions (task pr) instead of maximizing
+  bool m_trackAssignment;  // record optimal assignments (-track_assignment)
   Problem*     m_problem;
   SearchSpace* m_space;
 
-  zchaff::CSolver* zchaff_solver_;
+  ConstraintPropagator* m_cp;  // constraint propagation engine, if any
+  vector<int> m_deadEnds;      // variables of deleted OR nodes with value zero
+                               //   (to learn nogoods from)
+  OrderingStats* m_orderingStats;  // notified of new incumbents, if set
+
+  size_t m_lazyInterval;  // leaves between flushes of deferred values (0: eager)
+  size_t m_lazyCount;     // leaves propagated since the last flush
+  bool m_flushing;        // currently flushing deferred values
+  vector<SearchNode*> m_deferred;  // OR nodes on the current path whose improved
+                                   // values weren't passed on yet, deepest last
 
 #ifdef PARALLEL_STATIC
   count_t m_subCountCache;
@@ -71,13 +89,31 @@ public:
    * @n: the search node to be propagated
    * @reportSolution: should root updates be reported to problem instance?
    */
-  SearchNode* propagate(SearchNode* n,
-                        vector<vector<bool>>& currentDomains,
-                        bool reportSolution = false, SearchNode* upperLimit = NULL);
-
-  inline void setSatSolver(zchaff::CSolver* zc) {
-    zchaff_solver_ = zc;
-  }
+  SearchNode* propagate(SearchNode* n, bool reportSolution = false, SearchNode* upperLimit = NULL);
+
+  /* the same, combining OR node values in the given semiring (see
+   * Semiring.h) and recording assignments according to the given policy;
+   * the above dispatches on the task and -track_assignment */
+  template <class Semiring, class Assignment>
+  SearchNode* propagate(SearchNode* n, bool reportSolution, SearchNode* upperLimit);
+
+  /* sets the constraint propagation engine whose trail is to be backtracked
+   * when AND nodes are removed from the search space */
+  void setConstraintPropagator(ConstraintPropagator* cp) { m_cp = cp; }
+
+  /* sets the statistics to be told about the nodes new incumbents were
+   * propagated from */
+  void setOrderingStats(OrderingStats* s) { m_orderingStats = s; }
+
+  /* enables lazy propagation (for depth-first search only): the improved
+   * value of an OR node whose subproblem is still being explored is passed
+   * further up only once the subproblem is finished, combining the updates
+   * from all its leaves. Below the OR node the deferred values couldn't
+   * prune anything its own value doesn't. To keep the reporting of new
+   * solutions timely, flush() is called every 'interval' leaves. */
+  void setLazy(size_t interval) { m_lazyInterval = interval; }
+  /* propagates all deferred values up to the root */
+  void flush(bool reportSolution = true);
 
 #ifdef PARALLEL_STATIC
   const SubproblemStats& getSubproblemStatsCache() const { return m_subStatsCache; }
@@ -93,17 +129,30 @@ public:
   const pair<double,double>& getBoundsCache() const { return m_subBoundsCache; }
 #endif
 
-#ifndef NO_ASSIGNMENT
 private:
-  void propagateTuple(SearchNode* start, SearchNode* end);
-#endif
+  /* records the solution of OR node n through AND child c (see Solution.h) */
+  void recordSolution(SearchNode* n, SearchNode* c);
+  /* reports the value of n as a new solution, with the recorded assignment */
+  void reportAssignment(SearchNode* n);
 
 protected:
   virtual bool isMaster() const { return false; }
+  /* writes the value (and solution, if 'withSolution') of OR node n to the
+   * cache, returns true if an entry was written */
+  virtual bool writeCache(SearchNode* n, bool withSolution);
+  /* removes the fully propagated subproblem 'child' below 'parent' */
+  virtual void removeChild(SearchNode* parent, SearchNode* child) {
+    parent->eraseChild(child);
+  }
 
 public:
   BoundPropagator(Problem* p, SearchSpace* s, bool doCaching = true)
-    : m_doCaching(doCaching), m_problem(p), m_space(s), zchaff_solver_(nullptr)
+    : m_doCaching(doCaching),
+      m_sumTask(s && s->options && s->options->task == TASK_PR),
+      m_trackAssignment(s && s->options && s->options->trackAssignment),
+      m_problem(p), m_space(s), m_cp(NULL),
+      m_orderingStats(NULL),
+      m_lazyInterval(0), m_lazyCount(0), m_flushing(false)
 #if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
   , m_subCountCache(0)
 #endif
@@ -32,92 +32,79 @@ namespace daoopt {
 
 void BoundPropagatorMaster::operator() () {
 
-  bool allDone = false;
-  size_t noPropagated = 0;
+  // leaf nodes and subproblem roots to propagate next
+  vector<SearchNode*> nodes;
+  nodes.reserve(m_spaceMaster->maxThreads);
 
-  try { while (!allDone) {
+  try { while (true) {
 
+    m_spaceMaster->waitPropagate.wait(
+        [this]() { return hasSolved() || allDone(); });
+
+    nodes.clear();
     SearchNode* n = NULL;
+    while (m_spaceMaster->leaves.tryPop(n)) {
+      // new leaf node to propagate
+      nodes.push_back(n);
+    }
     Subproblem* sp = NULL;
-    bool hasMore = false;
-    noPropagated = 0;
-    boost::thread* tp = NULL;
+    while (m_spaceMaster->solved.tryPop(sp)) {
+      // new externally solved subproblem
+      nodes.push_back(sp->root); // root node of subproblem
 
-    do {
+      // collect subproblem statistics
       {
-        GETLOCK(m_spaceMaster->mtx_solved, lk);
-
-        while( m_spaceMaster->solved.empty() && m_spaceMaster->leaves.empty() ) {
-          CONDWAIT(m_spaceMaster->cond_solved, lk);
-        }
-
-        if (m_spaceMaster->leaves.size()) {
-          // new leaf node to propagate
-          n = m_spaceMaster->leaves.front();
-          m_spaceMaster->leaves.pop();
-        } else if (m_spaceMaster->solved.size()) {
-          // new externally solved subproblem
-          sp = m_spaceMaster->solved.front();
-          n = sp->root; // root node of subproblem
-
-          // collect subproblem statistics
-          {
-//            myprint("Adding subproblem to statistics\n");
-            GETLOCK(m_spaceMaster->mtx_stats, lk2);
-//            myprint("Acquired mutex\n");
-            m_spaceMaster->avgStats->addSubprob(sp);
-          }
-
-          { // clean up processing thread
-            GETLOCK(m_spaceMaster->mtx_activeThreads, lk2);
-            map< Subproblem*, boost::thread* >::iterator it = m_spaceMaster->activeThreads.find(sp);
-            if (it!=m_spaceMaster->activeThreads.end()) {
-              // tp = m_space->activeThreads.find(p)->second;
-              tp = it->second;
-              m_spaceMaster->activeThreads.erase(sp);
-              tp->join();
-              delete tp;
-            }
-          }
-
-          delete sp;
-          m_spaceMaster->solved.pop();
-        }
-
-      } // mtx_solved released
-
-      { // actual propagation
-        GETLOCK(m_spaceMaster->mtx_space, lk);
-        propagate(n, true);
-        ++noPropagated;
+        GETLOCK(m_spaceMaster->mtx_stats, lk);
+        m_spaceMaster->avgStats->addSubprob(sp);
       }
 
-      { //check if there's more to propagate
-        GETLOCK(m_spaceMaster->mtx_solved, lk);
-        hasMore = !m_spaceMaster->solved.empty() || !m_spaceMaster->leaves.empty();
+      { // clean up processing thread
+        GETLOCK(m_spaceMaster->mtx_activeThreads, lk);
+        map< Subproblem*, boost::thread* >::iterator it = m_spaceMaster->activeThreads.find(sp);
+        if (it!=m_spaceMaster->activeThreads.end()) {
+          boost::thread* tp = it->second;
+          m_spaceMaster->activeThreads.erase(it);
+          tp->join();
+          delete tp;
+        }
       }
 
-    } while (hasMore);
+      delete sp;
+    }
 
+    if (nodes.empty()) {
+      if (allDone())
+        break;
+      continue;
+    }
 
+    { // actual propagation, the whole batch under a single lock
+      GETLOCK(m_spaceMaster->mtx_space, lk);
+      for (vector<SearchNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it)
+        propagate(*it, true);
+    }
 
-    { // TODO: Make sure race condition can't happen
-      GETLOCK(m_spaceMaster->mtx_searchDone,lk);
-      if (m_spaceMaster->searchDone) { // search process done?
-        GETLOCK(m_spaceMaster->mtx_activeThreads,lk2);
-        if (m_spaceMaster->activeThreads.empty()) { // no more processing threads
-          allDone = true;
-        }
-      } else { // search not done, notify
-        { // notify the search that the buffer is open again
-          GETLOCK(m_spaceMaster->mtx_allowedThreads,lk);
-          m_spaceMaster->allowedThreads += noPropagated;
-          m_spaceMaster->cond_allowedThreads.notify_one();
-        }
+    { // the batch's cache entries, before the search goes on
+      GETLOCK(m_spaceMaster->mtx_cache, lk);
+      for (vector<CacheWrite>::iterator it = m_cacheWrites.begin(); it != m_cacheWrites.end(); ++it) {
+        if (it->withSolution)
+          m_space->cache->write(it->var, it->inst, it->ctxt, it->value, it->sol);
+        else
+          m_space->cache->write(it->var, it->inst, it->ctxt, it->value);
       }
     }
+    m_cacheWrites.clear();
 
-  } // overall while(!allDone) loop
+    // notify the search that the buffer is open again
+    m_spaceMaster->allowedThreads += nodes.size();
+    m_spaceMaster->waitAllowed.notify();
+
+    // free the solved subproblems while the search continues
+    for (vector<SearchNode*>::iterator it = m_removed.begin(); it != m_removed.end(); ++it)
+      delete *it;
+    m_removed.clear();
+
+  } // overall while(true) loop
 
   myprint("\t!!! PROP done !!!\n");
 
@@ -127,6 +114,36 @@ void BoundPropagatorMaster::operator() () {
 
 }
 
+
+bool BoundPropagatorMaster::writeCache(SearchNode* n, bool withSolution) {
+  // (a table reset in the meantime makes the write a no-op, as for any late
+  // write, see CacheTable)
+  CacheWrite w = { n->getVar(), n->getCacheInst(), n->getCacheContext(),
+                   n->getValue(), withSolution, n->getSolution() };
+  m_cacheWrites.push_back(w);
+  return false;  // not written yet
+}
+
+
+void BoundPropagatorMaster::removeChild(SearchNode* parent, SearchNode* child) {
+  // (unreachable from the search space once detached)
+  m_removed.push_back(parent->detachChild(child));
+}
+
+
+bool BoundPropagatorMaster::hasSolved() const {
+  return !m_spaceMaster->leaves.empty() || !m_spaceMaster->solved.empty();
+}
+
+
+bool BoundPropagatorMaster::allDone() const {
+  // (the search queues its last leaf/subproblem before setting searchDone)
+  if (!m_spaceMaster->searchDone || hasSolved())
+    return false;
+  GETLOCK(m_spaceMaster->mtx_activeThreads, lk);
+  return m_spaceMaster->activeThreads.empty();  // no more processing threads
+}
+
 }  // namespace daoopt
 
 #endif /* PARALLEL_DYNAMIC */
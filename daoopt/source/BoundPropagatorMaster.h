@@ -36,12 +36,33 @@ protected:
   /* same as m_space, but different type */
   SearchSpaceMaster* m_spaceMaster;
 
+  /* a cache entry from the current batch, written once mtx_space is released */
+  struct CacheWrite {
+    int var;
+    size_t inst;
+    context_t ctxt;
+    double value;
+    bool withSolution;
+    SolutionRef sol;
+  };
+  vector<CacheWrite> m_cacheWrites;
+  /* the subproblems removed by the current batch, freed without any lock */
+  vector<SearchNode*> m_removed;
+
 public:
   /* threading operator for master process */
   void operator () ();
 
 protected:
   bool isMaster() const { return true; }
+  /* queue cache entries and removed subproblems for after the batch */
+  bool writeCache(SearchNode* n, bool withSolution);
+  void removeChild(SearchNode* parent, SearchNode* child);
+  /* true if there are solved leaves or subproblems to propagate */
+  bool hasSolved() const;
+  /* true if the search is done and all its leaves and subproblems have
+   * been propagated */
+  bool allDone() const;
 
 public:
   /* simple constructor */
@@ -41,10 +41,8 @@ void BranchAndBound::reset(SearchNode* p) {
     if (p->getChildren())
       p = p->getChildren()[0];
   }
-#ifdef ANYTIME_DEPTH
   while (!m_stackDive.empty())
     m_stackDive.pop();
-#endif
   while (!m_stack.empty())
       m_stack.pop();
   m_stack.push(p);
@@ -54,12 +52,10 @@ void BranchAndBound::reset(SearchNode* p) {
 
 SearchNode* BranchAndBound::nextNode() {
   SearchNode* n = NULL;
-#ifdef ANYTIME_DEPTH
   if (m_stackDive.size()) {
     n = m_stackDive.top();
     m_stackDive.pop();
   }
-#endif
   if (!n && m_stack.size()) {
     n = m_stack.top();
     m_stack.pop();
@@ -84,14 +80,14 @@ bool BranchAndBound::doExpand(SearchNode* n) {
     myprint (ss.str());
 #endif
 
-#if defined(ANYTIME_DEPTH)
-    // reverse iterator needed since dive step reverses subproblem order
-    for (vector<SearchNode*>::reverse_iterator it=m_expand.rbegin(); it!=m_expand.rend(); ++it)
-      m_stackDive.push(*it);
-#else
-    for (vector<SearchNode*>::iterator it = m_expand.begin(); it != m_expand.end(); ++it)
-      m_stack.push(*it);
-#endif
+    if (m_dive) {
+      // reverse iterator needed since dive step reverses subproblem order
+      for (vector<SearchNode*>::reverse_iterator it=m_expand.rbegin(); it!=m_expand.rend(); ++it)
+        m_stackDive.push(*it);
+    } else {
+      for (vector<SearchNode*>::iterator it = m_expand.begin(); it != m_expand.end(); ++it)
+        m_stack.push(*it);
+    }
 
   } else {  // OR node
 
@@ -102,11 +98,11 @@ bool BranchAndBound::doExpand(SearchNode* n) {
       DIAG( ostringstream ss; ss << '\t' << *it << ": " << *(*it) << " (l=" << (*it)->getLabel() << ")" << endl; myprint(ss.str()); )
     } // for loop
     DIAG (ostringstream ss; ss << "\tGenerated " << n->getChildCountFull() <<  " child AND nodes" << endl; myprint(ss.str()); )
-#ifdef ANYTIME_DEPTH
-    // pull last node from normal stack for dive
-    m_stackDive.push(m_stack.top());
-    m_stack.pop();
-#endif
+    if (m_dive) {
+      // pull last node from normal stack for dive
+      m_stackDive.push(m_stack.top());
+      m_stack.pop();
+    }
 
   } // if over node type
 
@@ -133,19 +129,27 @@ bool BranchAndBound::solve(size_t nodeLimit) {
   size_t limit = nodeLimit > 0 ? nodeLimit : 0;
   SearchNode* n = this->nextLeaf();
   while(n && (nodeLimit == 0 || limit-- > 0)) {
-    m_prop->propagate(n, current_domains_, true); // true = report solutions
+    m_prop->propagate(n, true); // true = report solutions
     if (nodeLimit == 0 || limit > 0) {
       n = this->nextLeaf();
     }
   }
-  return !n ? true : false;
+  m_prop->flush(); // values deferred by lazy propagation
+  return !n && !m_timedOut;
 }
 
 
 BranchAndBound::BranchAndBound(Problem* prob, Pseudotree* pt,
     SearchSpace* space, Heuristic* heur, BoundPropagator* prop,
     ProgramOptions *po) :
-   Search(prob,pt,space,heur,prop,po) {
+   Search(prob,pt,space,heur,prop,po), m_dive(po && po->dive) {
+  // diving leaves subproblems behind on the regular stack, whose ancestors'
+  // sibling subproblems may get solved in the meantime
+  if (m_dive)
+    m_incrementalPruning = false;
+  // deferring values relies on depth-first exploration as well
+  if (m_prop && !m_dive && !m_sumTask && po && po->lazyProp > 0)
+    m_prop->setLazy(po->lazyProp);
 #ifndef NO_CACHING
   // Init context cache table
   if (!m_space->cache)
@@ -33,9 +33,11 @@ namespace daoopt {
 class BranchAndBound : virtual public Search {
 
 protected:
-#ifdef ANYTIME_DEPTH
+  /* "subproblem dive" (-dive): performs a dive guided by the heuristic
+   * into every new (sub)subproblem, will ideally yield better anytime
+   * performance */
+  bool m_dive;
   stack<SearchNode*> m_stackDive; // first stack for initial dives
-#endif
   stack<SearchNode*> m_stack; // The DFS stack of nodes
 
 protected:
@@ -58,11 +60,7 @@ public:
 
 
 inline bool BranchAndBound::isDone() const {
-#if defined ANYTIME_DEPTH
   return (m_stack.empty() && m_stackDive.empty());
-#else
-  return m_stack.empty();
-#endif
 }
 
 }  // namespace daoopt
@@ -36,16 +36,21 @@ bool BranchAndBoundMaster::findInitialParams(count_t& limitN) const {
 
   Pseudotree pt(*m_pseudotree);
   SearchSpace sp(&pt, m_space->options);
-
-  BranchAndBound bab(m_problem, &pt, &sp, m_heuristic);
-
-  bab.updateSolution( lowerBound(m_space->root)
-#ifndef NO_ASSIGNMENT
-  , m_space->root->getOptAssig()
+  sp.stats.numORVar.resize(pt.getN(), 0);
+  sp.stats.numANDVar.resize(pt.getN(), 0);
+  sp.stats.numProcORVar.resize(pt.getN(), 0);
+  sp.stats.numProcANDVar.resize(pt.getN(), 0);
+
+  BoundPropagator prop(m_problem, &sp, !m_options->nocaching);
+  BranchAndBound bab(m_problem, &pt, &sp, m_heuristic, &prop, m_options);
+#ifndef NO_HEURISTIC
+  bab.finalizeHeuristic();
 #endif
-  );
 
-  BoundPropagator prop(m_problem,&sp);
+  vector<val_t> tuple;
+  if (m_space->root->getSolution())
+    assignSolution(m_space->root->getSolution(), m_pseudotree, m_space->root->getVar(), tuple);
+  bab.updateSolution( lowerBound(m_space->root), tuple );
 
   int maxSubRootDepth = pt.getHeight();
   int maxSubRootHeight = 0;
@@ -94,11 +99,7 @@ bool BranchAndBoundMaster::findInitialParams(count_t& limitN) const {
   m_spaceMaster->avgStats->init(maxSubRootDepth, maxSubRootHeight, maxSubCount, maxSubLeaves, maxSubLeafD, lbound, ubound);
 
   if (! bab.nextLeaf()) {
-    this->updateSolution(bab.getCurOptValue()
-#ifndef NO_ASSIGNMENT
-    , bab.getCurOptTuple()
-#endif
-    );
+    this->updateSolution(bab.getCurOptValue(), bab.getCurOptTuple());
     return true; // solved within time limit
   }
 
@@ -113,16 +114,22 @@ void BranchAndBoundMaster::solveLocal(SearchNode* node) const {
 
   Pseudotree pt(*m_pseudotree);
   SearchSpace sp(&pt, m_space->options);
+  sp.stats.numORVar.resize(pt.getN(), 0);
+  sp.stats.numANDVar.resize(pt.getN(), 0);
+  sp.stats.numProcORVar.resize(pt.getN(), 0);
+  sp.stats.numProcANDVar.resize(pt.getN(), 0);
 
-  BranchAndBound bab(m_problem, &pt, &sp, m_heuristic);
+  BoundPropagator prop(m_problem, &sp, !m_options->nocaching);
+  BranchAndBound bab(m_problem, &pt, &sp, m_heuristic, &prop, m_options);
 
   vector<double> pst;
   node->getPST(pst); // gets the partial solution tree (bottom-up)
   reverse(pst.begin(), pst.end()); // reverse to make it top-down
 
   bab.restrictSubproblem(node->getVar(), m_assignment , pst );
-
-  BoundPropagator prop(m_problem,&sp);
+#ifndef NO_HEURISTIC
+  bab.finalizeHeuristic();
+#endif
 
   SearchNode* n = bab.nextLeaf();
   while (n) {
@@ -133,9 +140,7 @@ void BranchAndBoundMaster::solveLocal(SearchNode* node) const {
   double mpeCost = bab.getCurOptValue();
   node->setValue(mpeCost);
 
-#ifndef NO_ASSIGNMENT
-  node->setOptAssig(bab.getCurOptTuple());
-#endif
+  node->setSolution(bab.getCurOptTuple());
 
   node->setLeaf();
 
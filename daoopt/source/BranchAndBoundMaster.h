@@ -48,14 +48,17 @@ protected:
   void solveLocal(SearchNode*) const;
 
 public:
-  BranchAndBoundMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* space, Heuristic* heur) ;
+  BranchAndBoundMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* space, Heuristic* heur,
+                       BoundPropagator* prop, ProgramOptions* po) ;
 
 };
 
 /* Inline definitions */
 
-inline BranchAndBoundMaster::BranchAndBoundMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* space, Heuristic* heur) :
-    Search(prob, pt,space, heur), SearchMaster(prob,pt,space,heur), BranchAndBound(prob,pt,space,heur) {}
+inline BranchAndBoundMaster::BranchAndBoundMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* space, Heuristic* heur,
+                                                  BoundPropagator* prop, ProgramOptions* po) :
+    Search(prob, pt, space, heur, prop, po), SearchMaster(prob, pt, space, heur, prop, po),
+    BranchAndBound(prob, pt, space, heur, prop, po) {}
 
 }  // namespace daoopt
 
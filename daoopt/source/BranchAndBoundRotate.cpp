@@ -150,12 +150,12 @@ bool BranchAndBoundRotate::solve(size_t nodeLimit) {
   size_t limit = nodeLimit > 0 ? nodeLimit : 0;
   SearchNode* n = this->nextLeaf();
   while (n && (nodeLimit == 0 || limit-- > 0)) {
-    m_prop->propagate(n, current_domains_, true); // true = report solutions
+    m_prop->propagate(n, true); // true = report solutions
     if (nodeLimit == 0 || limit > 0) {
       n = this->nextLeaf();
     }
   }
-  return !n ? true : false;
+  return !n && !m_timedOut;
 }
 
 
@@ -165,6 +165,8 @@ BranchAndBoundRotate::BranchAndBoundRotate(Problem* prob, Pseudotree* pt,
     SearchSpace* space, Heuristic* heur, BoundPropagator* prop,
     ProgramOptions* po) :
    Search(prob,pt,space,heur,prop,po), m_reasonCnt(3,0) {
+  // rotating between stacks doesn't explore depth-first
+  m_incrementalPruning = false;
 #ifndef NO_CACHING
   // Init context cache table
   if (!m_space->cache)
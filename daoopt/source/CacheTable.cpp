@@ -25,10 +25,7 @@
 
 namespace daoopt {
 
-#ifndef NO_ASSIGNMENT
-  const pair<const double, const vector<val_t> > CacheTable::NOT_FOUND = make_pair(ELEM_NAN, vector<val_t>());
-#else
   const double CacheTable::NOT_FOUND = ELEM_NAN;
-#endif
+  const cache_assig_entry CacheTable::NOT_FOUND_ASSIG = make_pair(ELEM_NAN, SolutionRef());
 
 }  // namespace daoopt
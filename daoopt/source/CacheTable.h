@@ -26,6 +26,7 @@
 
 #include "_base.h"
 #include "utils.h"
+#include "Solution.h"
 
 #include <vector>
 #include <string>
@@ -33,15 +34,19 @@
 
 namespace daoopt {
 
-#ifndef NO_ASSIGNMENT
-typedef boost::unordered_map<const context_t,
-                             const pair<const double, const vector<val_t>
-                             >> context_hash_map;
-#else
 typedef boost::unordered_map<const context_t,
                              const double> context_hash_map;
-#endif
+/* entries that include the optimal subproblem solution */
+typedef pair<const double, const SolutionRef> cache_assig_entry;
+typedef boost::unordered_map<const context_t,
+                             const cache_assig_entry> context_assig_hash_map;
 
+/*
+ * Stores subproblem values by context, for each variable. Values written with
+ * an optimal solution (cf. -track_assignment) are kept in separate tables,
+ * so that the value-only tables don't pay for the solution records; search
+ * uses either one or the other kind.
+ */
 class CacheTable {
 
 private:
@@ -51,24 +56,31 @@ private:
   vector<size_t> m_instCounter;
 #endif
   vector< context_hash_map* > m_tables;
+  vector< context_assig_hash_map* > m_assigTables;
 
 protected:
-#ifndef NO_ASSIGNMENT
-  static const pair<const double, const vector<val_t> > NOT_FOUND;
-#else
   static const double NOT_FOUND;
-#endif
+  static const cache_assig_entry NOT_FOUND_ASSIG;
+
+protected:
+  /* common implementation of the write() variants */
+  template <class Map>
+  bool writeEntry(vector<Map*>& tables, int n, size_t inst, const context_t& ctxt,
+                  const typename Map::mapped_type& entry);
+  template <class Map>
+  const typename Map::mapped_type& readEntry(const vector<Map*>& tables, int n, size_t inst,
+                                             const context_t& ctxt,
+                                             const typename Map::mapped_type& notFound) const;
 
 public:
-#ifndef NO_ASSIGNMENT
-  virtual bool write(int n, size_t inst, const context_t& ctxt, double v, const vector<val_t>& sol);
-  virtual const pair<const double, const vector<val_t> >& read(int n, size_t inst, const context_t& ctxt) const;
-#else
   virtual bool write(int n, size_t inst, const context_t& ctxt, double v);
-  virtual const double read(int n, size_t inst, const context_t& ctxt) const;
-#endif
+  virtual double read(int n, size_t inst, const context_t& ctxt) const;
+  virtual bool write(int n, size_t inst, const context_t& ctxt, double v, const SolutionRef& sol);
+  virtual const cache_assig_entry& readAssig(int n, size_t inst, const context_t& ctxt) const;
 
   virtual void reset(int n);
+  /* removes all entries, but keeps the tables' memory for reuse */
+  virtual void clear();
 #ifdef PARALLEL_DYNAMIC
   virtual size_t getInstCounter(int n) const;
 #else
@@ -90,15 +102,13 @@ public:
 class UnCacheTable : public CacheTable  {
 public:
 
-#ifndef NO_ASSIGNMENT
-  bool write(int n, size_t inst, const context_t& ctxt, double v, const vector<val_t>& sol) { return false; }
-  const pair<const double, const vector<val_t> >& read(int n, size_t inst, const context_t& ctxt) const { return NOT_FOUND; }
-#else
   bool write(int n, size_t inst, const context_t& ctxt, double v) { return false; }
-  const double read(int n, size_t inst, const context_t& ctxt) const { return NOT_FOUND; }
-#endif
+  double read(int n, size_t inst, const context_t& ctxt) const { return NOT_FOUND; }
+  bool write(int n, size_t inst, const context_t& ctxt, double v, const SolutionRef& sol) { return false; }
+  const cache_assig_entry& readAssig(int n, size_t inst, const context_t& ctxt) const { return NOT_FOUND_ASSIG; }
 
   void reset(int n) {}
+  void clear() {}
 #ifdef PARALLEL_DYNAMIC
   size_t getInstCounter(int n) const { return 0; }
 #else
@@ -119,12 +129,9 @@ public:
 
 /* inserts a value into the respective cache table, throws an int if
  * insert non successful (memory limit or index out of bounds) */
-#ifndef NO_ASSIGNMENT
-inline bool CacheTable::write(int n, size_t inst, const context_t& ctxt, double v, const vector<val_t>& sol)
-#else
-inline bool CacheTable::write(int n, size_t inst, const context_t& ctxt, double v)
-#endif 
-{
+template <class Map>
+inline bool CacheTable::writeEntry(vector<Map*>& tables, int n, size_t inst, const context_t& ctxt,
+                                   const typename Map::mapped_type& entry) {
   assert(n < m_size);
 #ifdef PARALLEL_DYNAMIC
   // check instance counter
@@ -132,61 +139,74 @@ inline bool CacheTable::write(int n, size_t inst, const context_t& ctxt, double
     return false; // mismatch, don't cache
 #endif
 
-  // NaN is reserved, replace with zero
-  if (ISNAN(v))
-    v = -ELEM_ZERO;
-
   // create hash table if needed
-  if (!m_tables[n]) {
-    m_tables[n] = new context_hash_map;
+  if (!tables[n]) {
+    tables[n] = new Map;
 #if defined HASH_GOOGLE_DENSE || defined HASH_GOOGLE_SPARSE
-    m_tables[n]->set_deleted_key(" ");
+    tables[n]->set_deleted_key(" ");
 #endif
 #ifdef HASH_GOOGLE_DENSE
-    m_tables[n]->set_empty_key("");
+    tables[n]->set_empty_key("");
 #endif
   }
   // this will write only if entry not present yet
-#ifndef NO_ASSIGNMENT
-  m_tables[n]->insert( context_hash_map::value_type(ctxt, make_pair(v,sol) ) );
-#else
-  m_tables[n]->insert( context_hash_map::value_type(ctxt, v) );
-#endif
+  tables[n]->insert( typename Map::value_type(ctxt, entry) );
   return true;
 }
 
+inline bool CacheTable::write(int n, size_t inst, const context_t& ctxt, double v) {
+  // NaN is reserved, replace with zero
+  if (ISNAN(v))
+    v = -ELEM_ZERO;
+  return writeEntry(m_tables, n, inst, ctxt, v);
+}
 
-/* tries to read a value from a table, throws an int (UNKNOWN) if not found */
-#ifndef NO_ASSIGNMENT
-inline const pair<const double, const vector<val_t> >& CacheTable::read(int n, size_t inst, const context_t& ctxt) const 
-#else
-inline const double CacheTable::read(int n, size_t inst, const context_t& ctxt) const 
-#endif 
-{
+inline bool CacheTable::write(int n, size_t inst, const context_t& ctxt, double v, const SolutionRef& sol) {
+  if (ISNAN(v))
+    v = -ELEM_ZERO;
+  return writeEntry(m_assigTables, n, inst, ctxt, cache_assig_entry(v, sol));
+}
+
+
+/* tries to read a value from a table, returns 'notFound' if not found */
+template <class Map>
+inline const typename Map::mapped_type& CacheTable::readEntry(
+    const vector<Map*>& tables, int n, size_t inst, const context_t& ctxt,
+    const typename Map::mapped_type& notFound) const {
 
   assert(n < m_size);
   // does cache table exist?
-  if (!m_tables[n])
-    return NOT_FOUND;
+  if (!tables[n])
+    return notFound;
 #ifdef PARALLEL_DYNAMIC
   // check instance counter
   if (m_instCounter[n] != inst)
-    return NOT_FOUND; // mismatch, abort
+    return notFound; // mismatch, abort
 #endif
   // look for actual entry
-  context_hash_map::const_iterator it = m_tables[n]->find(ctxt);
-  if (it == m_tables[n]->end())
-    return NOT_FOUND;
+  typename Map::const_iterator it = tables[n]->find(ctxt);
+  if (it == tables[n]->end())
+    return notFound;
   return it->second;
 }
 
+inline double CacheTable::read(int n, size_t inst, const context_t& ctxt) const {
+  return readEntry(m_tables, n, inst, ctxt, NOT_FOUND);
+}
+
+inline const cache_assig_entry& CacheTable::readAssig(int n, size_t inst, const context_t& ctxt) const {
+  return readEntry(m_assigTables, n, inst, ctxt, NOT_FOUND_ASSIG);
+}
+
 
 inline void CacheTable::reset(int n) {
   assert(n<m_size);
-  if (m_tables[n]) {
+  if (m_tables[n] || m_assigTables[n]) {
 //    m_tables[n]->clear();
     delete m_tables[n];
     m_tables[n] = NULL;
+    delete m_assigTables[n];
+    m_assigTables[n] = NULL;
     m_full = false;
     DIAG(oss ss;  ss << "Reset cache table " << n << endl; myprint(ss.str());)
   }
@@ -196,6 +216,14 @@ inline void CacheTable::reset(int n) {
 #endif
 }
 
+inline void CacheTable::clear() {
+  for (int n=0; n<m_size; ++n) {
+    if (m_tables[n]) m_tables[n]->clear();
+    if (m_assigTables[n]) m_assigTables[n]->clear();
+  }
+  m_full = false;
+}
+
 #ifdef PARALLEL_DYNAMIC
 inline size_t CacheTable::getInstCounter(int n) const {
   assert(n<m_size);
@@ -205,20 +233,23 @@ inline size_t CacheTable::getInstCounter(int n) const {
 
 inline CacheTable::CacheTable(int size) :
 #ifdef PARALLEL_DYNAMIC
-    m_full(false), m_size(size), m_instCounter(size,0), m_tables(size)
+    m_full(false), m_size(size), m_instCounter(size,0), m_tables(size), m_assigTables(size)
 #else
-    m_full(false), m_size(size), m_tables(size)
+    m_full(false), m_size(size), m_tables(size), m_assigTables(size)
 #endif 
 {
-  for (int i=0; i<size; ++i)
+  for (int i=0; i<size; ++i) {
     m_tables[i] = NULL;
+    m_assigTables[i] = NULL;
+  }
 }
 
 inline void CacheTable::printStats() const {
   ostringstream ss;
   ss << "Cache statistics:" ;
-  for (vector< context_hash_map * >::const_iterator it=m_tables.begin(); it!=m_tables.end(); ++it) {
-    if (*it) ss << " " << (*it)->size();
+  for (int i=0; i<m_size; ++i) {
+    if (m_tables[i]) ss << " " << m_tables[i]->size();
+    else if (m_assigTables[i]) ss << " " << m_assigTables[i]->size();
     else     ss << " .";
   }
   ss << endl;
@@ -228,6 +259,8 @@ inline void CacheTable::printStats() const {
 inline CacheTable::~CacheTable() {
   for (vector< context_hash_map * >::iterator it=m_tables.begin(); it!=m_tables.end(); ++it)
     if (*it) delete *it;
+  for (vector< context_assig_hash_map * >::iterator it=m_assigTables.begin(); it!=m_assigTables.end(); ++it)
+    if (*it) delete *it;
 }
 
 #if defined WINDOWS or defined __APPLE__
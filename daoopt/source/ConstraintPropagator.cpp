@@ -0,0 +1,480 @@
+/*
+ * ConstraintPropagator.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ConstraintPropagator.h"
+
+#include "Function.h"
+#include "Problem.h"
+#include "Pseudotree.h"
+
+namespace daoopt {
+
+ConstraintPropagator::ConstraintPropagator(Problem* p, Pseudotree* pt) :
+    m_problem(p), m_pseudotree(pt), m_root(NONE),
+    m_maxNogoods(0), m_maxNogoodSize(0), m_numLiveNogoods(0),
+    m_numAssign(0), m_numRemoved(0), m_numConflicts(0),
+    m_numLearned(0), m_numNogoodsDeleted(0), m_numNogoodsDiscarded(0),
+    m_numNogoodRemoved(0) {
+  assert(p && pt);
+}
+
+
+void ConstraintPropagator::setNogoodLimit(size_t limit, size_t maxSize) {
+  m_maxNogoods = limit;
+  m_maxNogoodSize = maxSize;
+}
+
+
+bool ConstraintPropagator::init() {
+  int n = m_problem->getN();
+
+  // set up full domains
+  m_bitOffset.resize(n);
+  m_domSize.resize(n);
+  m_fixedVal.assign(n, NONE);
+  m_parent.assign(n, NONE);
+  for (int var = 0; var < n; ++var) {
+    const PseudotreeNode* parent = m_pseudotree->getNode(var)->getParent();
+    if (parent)
+      m_parent[var] = parent->getVar();
+  }
+  m_root = m_pseudotree->getRoot()->getVar();
+  m_numWipeouts.assign(n, 0);
+  size_t words = 0;
+  for (int var = 0; var < n; ++var) {
+    m_bitOffset[var] = words;
+    m_domSize[var] = m_problem->getDomainSize(var);
+    words += (m_domSize[var] + 63) / 64;
+  }
+  m_bits.assign(words, 0);
+  m_valOffset.resize(n);
+  size_t vals = 0;
+  for (int var = 0; var < n; ++var) {
+    m_valOffset[var] = vals;
+    vals += m_domSize[var];
+  }
+  m_reason.assign(vals, REASON_ROOT);
+  m_level.assign(n, 0);
+  m_varNogoods.assign(n, vector<int>());
+  for (int var = 0; var < n; ++var) {
+    for (int val = 0; val < m_domSize[var]; ++val)
+      m_bits[m_bitOffset[var] + (val >> 6)] |= ((uint64_t) 1) << (val & 63);
+  }
+
+  // collect functions with zero entries, unary ones are applied right away
+  m_varConstraints.assign(n, vector<int>());
+  vector<pair<int,int> > unaryZeros;
+  for (const Function* f : m_problem->getFunctions()) {
+    if (f->getArity() == 0)
+      continue;
+    const double* table = f->getTable();
+    bool hasZero = false;
+    for (size_t i = 0; i < f->getTableSize() && !hasZero; ++i)
+      hasZero = (table[i] == ELEM_ZERO);
+    if (!hasZero)
+      continue;
+    if (f->getArity() == 1) {
+      int var = f->getScopeVec()[0];
+      for (size_t i = 0; i < f->getTableSize(); ++i) {
+        if (table[i] == ELEM_ZERO)
+          unaryZeros.push_back(make_pair(var, (int) i));
+      }
+      continue;
+    }
+    Constraint c;
+    c.fn = f;
+    c.scope = f->getScopeVec();
+    c.strides.resize(c.scope.size());
+    size_t offset = 1;
+    for (int i = c.scope.size() - 1; i >= 0; --i) {
+      c.strides[i] = offset;
+      offset *= m_problem->getDomainSize(c.scope[i]);
+    }
+    int id = m_constraints.size();
+    m_constraints.push_back(c);
+    for (int var : c.scope)
+      m_varConstraints[var].push_back(id);
+  }
+
+  m_numUnfixed.resize(m_constraints.size());
+  for (size_t i = 0; i < m_constraints.size(); ++i)
+    m_numUnfixed[i] = m_constraints[i].scope.size();
+
+  // variables with unary domains are fixed from the start
+  for (int var = 0; var < n; ++var) {
+    if (m_domSize[var] == 1) {
+      m_fixedVal[var] = 0;
+      for (int c : m_varConstraints[var])
+        --m_numUnfixed[c];
+      m_queue.push_back(var);
+    }
+  }
+
+  bool ok = true;
+  for (const pair<int,int>& z : unaryZeros) {
+    if (inDomain(z.first, z.second))
+      ok = remove(z.first, z.second, REASON_ROOT) && ok;
+  }
+  ok = ok && propagate();
+
+  // root level changes are permanent
+  m_trail.clear();
+  m_conflictVars.clear();
+  return ok;
+}
+
+
+bool ConstraintPropagator::assign(int var, int val) {
+  ++m_numAssign;
+  if (!inDomain(var, val)) {
+    ++m_numConflicts;
+    return false;
+  }
+  if (m_domSize[var] == 1)
+    return true;  // fixed already, nothing changes
+  // new level
+  m_levelMarks.push_back(m_trail.size());
+  m_levelVars.push_back(var);
+  m_levelVals.push_back(val);
+  int domSize = m_problem->getDomainSize(var);
+  for (int v = 0; v < domSize && m_domSize[var] > 1; ++v) {
+    if (v != val && inDomain(var, v))
+      remove(var, v, REASON_ASSIGN);
+  }
+  if (propagate())
+    return true;
+  if (m_maxNogoods)
+    learn();
+  return false;
+}
+
+
+void ConstraintPropagator::backtrack(mark_t m) {
+  assert(m <= m_trail.size());
+  while (m_trail.size() > m) {
+    const Removal& r = m_trail.back();
+    int var = r.var;
+    m_bits[m_bitOffset[var] + (r.val >> 6)] |= ((uint64_t) 1) << (r.val & 63);
+    int size = ++m_domSize[var];
+    if (size == 1) {
+      countWipeout(var, -1);
+    } else if (size == 2) {  // no longer fixed
+      m_fixedVal[var] = NONE;
+      for (int c : m_varConstraints[var])
+        ++m_numUnfixed[c];
+    }
+    m_trail.pop_back();
+  }
+  while (!m_levelMarks.empty() && m_levelMarks.back() >= m) {
+    m_levelMarks.pop_back();
+    m_levelVars.pop_back();
+    m_levelVals.pop_back();
+  }
+  m_queue.clear();
+  m_conflictVars.clear();
+}
+
+
+bool ConstraintPropagator::remove(int var, int val, int reason) {
+  assert(inDomain(var, val));
+  m_bits[m_bitOffset[var] + (val >> 6)] &= ~(((uint64_t) 1) << (val & 63));
+  Removal r = { var, val };
+  m_trail.push_back(r);
+  m_reason[m_valOffset[var] + val] = reason;
+  ++m_numRemoved;
+  int size = --m_domSize[var];
+  if (size == 1) {  // var becomes fixed
+    m_fixedVal[var] = findFixedVal(var);
+    m_level[var] = m_levelMarks.size();
+    for (int c : m_varConstraints[var])
+      --m_numUnfixed[c];
+    m_queue.push_back(var);
+  } else if (size == 0) {
+    countWipeout(var, 1);
+    if (m_maxNogoods && m_conflictVars.empty()) {
+      for (int v = 0; v < m_problem->getDomainSize(var); ++v)
+        addReason(var, v);
+    }
+    return false;
+  }
+  return true;
+}
+
+
+void ConstraintPropagator::countWipeout(int var, int d) {
+  for (; var != NONE; var = m_parent[var])
+    m_numWipeouts[var] += d;
+}
+
+
+bool ConstraintPropagator::propagate() {
+  if (isWipedOut()) {
+    ++m_numConflicts;
+    m_queue.clear();
+    return false;
+  }
+  for (size_t q = 0; q < m_queue.size(); ++q) {
+    int fixedVar = m_queue[q];
+    for (int id : m_varNogoods[fixedVar]) {
+      if (!propagateNogood(id)) {
+        ++m_numConflicts;
+        m_queue.clear();
+        return false;
+      }
+    }
+    for (int id : m_varConstraints[fixedVar]) {
+      int unfixed = m_numUnfixed[id];
+      if (unfixed > 1)
+        continue;
+      const Constraint& c = m_constraints[id];
+      // table index of the fixed part of the scope
+      size_t idx = 0, stride = 0;
+      int freeVar = NONE;
+      for (size_t i = 0; i < c.scope.size(); ++i) {
+        int v = c.scope[i];
+        if (m_fixedVal[v] == NONE) {
+          freeVar = v;
+          stride = c.strides[i];
+        } else {
+          idx += m_fixedVal[v] * c.strides[i];
+        }
+      }
+      const double* table = c.fn->getTable();
+      if (freeVar == NONE) {  // fully fixed, check for zero
+        if (table[idx] == ELEM_ZERO) {
+          if (m_maxNogoods)
+            m_conflictVars = c.scope;
+          ++m_numConflicts;
+          m_queue.clear();
+          return false;
+        }
+        continue;
+      }
+      // forward check the remaining variable
+      int domSize = m_problem->getDomainSize(freeVar);
+      for (int val = 0; val < domSize; ++val) {
+        if (table[idx + val * stride] == ELEM_ZERO && inDomain(freeVar, val)) {
+          if (!remove(freeVar, val, id)) {
+            ++m_numConflicts;
+            m_queue.clear();
+            return false;
+          }
+          if (m_fixedVal[freeVar] != NONE)
+            break;  // picked up again from the queue
+        }
+      }
+    }
+  }
+  m_queue.clear();
+  return true;
+}
+
+
+bool ConstraintPropagator::propagateNogood(int id) {
+  Nogood& ng = m_nogoods[id];
+  const pair<int,int>* open = NULL;
+  for (const pair<int,int>& lit : ng.lits) {
+    int fixed = m_fixedVal[lit.first];
+    if (fixed == NONE) {
+      if (open || !inDomain(lit.first, lit.second))
+        return true;  // two open assignments, or one that can't happen
+      open = &lit;
+    } else if (fixed != lit.second) {
+      return true;  // satisfied
+    }
+  }
+  ++ng.hits;
+  if (!open) {  // all assignments hold
+    m_conflictVars.clear();
+    for (const pair<int,int>& lit : ng.lits)
+      m_conflictVars.push_back(lit.first);
+    return false;
+  }
+  ++m_numNogoodRemoved;
+  return remove(open->first, open->second, REASON_NOGOOD - id);
+}
+
+
+void ConstraintPropagator::addReason(int var, int val) {
+  int reason = m_reason[m_valOffset[var] + val];
+  if (reason >= 0) {
+    for (int v : m_constraints[reason].scope) {
+      if (v != var)
+        m_conflictVars.push_back(v);
+    }
+  } else if (reason <= REASON_NOGOOD) {
+    for (const pair<int,int>& lit : m_nogoods[REASON_NOGOOD - reason].lits) {
+      if (lit.first != var)
+        m_conflictVars.push_back(lit.first);
+    }
+  } else if (reason == REASON_ASSIGN) {
+    m_conflictVars.push_back(var);  // the assignment itself
+  }
+  // REASON_ROOT holds unconditionally
+}
+
+
+void ConstraintPropagator::learn() {
+  // Expand the variables fixed at the current level into the reasons for
+  // their fixing, until only the assigned variable of that level is left;
+  // variables from earlier levels are kept as they are.
+  int curLevel = m_levelMarks.size();
+  int curVar = (curLevel > 0) ? m_levelVars.back() : NONE;
+  vector<pair<int,int> > lits;
+  vector<int> levels;
+  vector<bool> seen(m_problem->getN(), false);
+  vector<int> stack;
+  stack.swap(m_conflictVars);
+  while (!stack.empty()) {
+    int var = stack.back();
+    stack.pop_back();
+    if (seen[var])
+      continue;
+    seen[var] = true;
+    int level = m_level[var];
+    if (m_fixedVal[var] == NONE) {
+      // an assigned variable whose domain got wiped out afterwards
+      assert(level > 0 && m_levelVars[level - 1] == var);
+      lits.push_back(make_pair(var, m_levelVals[level - 1]));
+      levels.push_back(level);
+      continue;
+    }
+    if (level == 0)
+      continue;  // holds unconditionally
+    if (level < curLevel || var == curVar) {
+      lits.push_back(make_pair(var, m_fixedVal[var]));
+      levels.push_back(level);
+      continue;
+    }
+    for (int v = 0; v < m_problem->getDomainSize(var); ++v) {
+      if (!inDomain(var, v))
+        addReason(var, v);
+    }
+    stack.insert(stack.end(), m_conflictVars.begin(), m_conflictVars.end());
+    m_conflictVars.clear();
+  }
+  if (lits.empty())
+    return;
+  if (lits.size() > m_maxNogoodSize) {
+    ++m_numNogoodsDiscarded;
+    return;
+  }
+  sort(levels.begin(), levels.end());
+  int lbd = unique(levels.begin(), levels.end()) - levels.begin();
+  addNogood(lits, lbd);
+}
+
+
+void ConstraintPropagator::learnDeadEnd(int var, const vector<int>& context) {
+  if (!m_maxNogoods)
+    return;
+  m_conflictVars.clear();
+  for (int v : context) {
+    if (m_fixedVal[v] == NONE)
+      return;  // not a complete context assignment
+    m_conflictVars.push_back(v);
+  }
+  for (int sv : m_pseudotree->getNode(var)->getSubprobVars()) {
+    for (int v = 0; v < m_problem->getDomainSize(sv); ++v) {
+      if (!inDomain(sv, v))
+        addReason(sv, v);
+    }
+  }
+  learn();
+}
+
+
+void ConstraintPropagator::addNogood(const vector<pair<int,int> >& lits,
+                                     int lbd) {
+  int id;
+  if (m_freeNogoods.empty()) {
+    id = m_nogoods.size();
+    m_nogoods.push_back(Nogood());
+  } else {
+    id = m_freeNogoods.back();
+    m_freeNogoods.pop_back();
+  }
+  Nogood& ng = m_nogoods[id];
+  ng.lits = lits;
+  ng.lbd = lbd;
+  ng.hits = 0;
+  for (const pair<int,int>& lit : lits)
+    m_varNogoods[lit.first].push_back(id);
+  ++m_numLiveNogoods;
+  ++m_numLearned;
+  if (m_numLiveNogoods > m_maxNogoods)
+    reduceNogoods();
+}
+
+
+bool ConstraintPropagator::isLocked(int id) const {
+  for (const pair<int,int>& lit : m_nogoods[id].lits) {
+    if (!inDomain(lit.first, lit.second) &&
+        m_reason[m_valOffset[lit.first] + lit.second] == REASON_NOGOOD - id)
+      return true;
+  }
+  return false;
+}
+
+
+void ConstraintPropagator::reduceNogoods() {
+  // deletion candidates, worst first: high LBD, then few hits
+  vector<pair<pair<int,count_t>,int> > cand;
+  for (size_t id = 0; id < m_nogoods.size(); ++id) {
+    const Nogood& ng = m_nogoods[id];
+    if (!ng.lits.empty() && !isLocked(id))
+      cand.push_back(make_pair(make_pair(-ng.lbd, ng.hits), id));
+  }
+  sort(cand.begin(), cand.end());
+  size_t target = m_maxNogoods / 2;
+  vector<bool> deleted(m_nogoods.size(), false);
+  for (size_t i = 0; i < cand.size() && m_numLiveNogoods > target; ++i) {
+    int id = cand[i].second;
+    vector<pair<int,int> >().swap(m_nogoods[id].lits);
+    deleted[id] = true;
+    m_freeNogoods.push_back(id);
+    --m_numLiveNogoods;
+    ++m_numNogoodsDeleted;
+  }
+  for (vector<int>& ngs : m_varNogoods) {
+    size_t j = 0;
+    for (size_t i = 0; i < ngs.size(); ++i) {
+      if (!deleted[ngs[i]])
+        ngs[j++] = ngs[i];
+    }
+    ngs.resize(j);
+  }
+  // age the survivors
+  for (Nogood& ng : m_nogoods)
+    ng.hits /= 2;
+}
+
+
+int ConstraintPropagator::findFixedVal(int var) const {
+  size_t words = (m_problem->getDomainSize(var) + 63) / 64;
+  for (size_t w = 0; w < words; ++w) {
+    uint64_t b = m_bits[m_bitOffset[var] + w];
+    if (b)
+      return w * 64 + __builtin_ctzll(b);
+  }
+  assert(false);
+  return NONE;
+}
+
+}  // namespace daoopt
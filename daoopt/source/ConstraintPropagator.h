@@ -0,0 +1,219 @@
+/*
+ * ConstraintPropagator.h
+ *
+ *  Incremental constraint propagation over the determinism (zero
+ *  entries) of the problem functions, used by AOBB with -cp_type=UNIT.
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSTRAINTPROPAGATOR_H_
+#define CONSTRAINTPROPAGATOR_H_
+
+#include "_base.h"
+
+#include <stdint.h>
+
+namespace daoopt {
+
+class Function;
+class Problem;
+class Pseudotree;
+
+/*
+ * Propagates the zero entries of the function tables, with the same strength
+ * as unit resolution over the nogood encoding (one boolean per variable/value
+ * pair): once all but one variable in a function's scope are fixed, values of
+ * the remaining variable that yield a zero entry are removed; a variable whose
+ * domain shrinks to a single value counts as fixed in turn.
+ *
+ * Domains are bitsets with a count of live values per variable, so wipe-outs
+ * are detected the moment they occur. They are counted per subproblem, i.e.
+ * for every pseudo tree node over the variables in its subtree. Every change
+ * is recorded on a trail; search records the trail position (mark()) before
+ * assigning a node and backtracks by restoring it, which undoes exactly the
+ * changes made since.
+ * This requires the nodes to be retracted in LIFO order, i.e. depth-first
+ * AND/OR search.
+ *
+ * Optionally, nogoods are learned from dead-ends: every removal records its
+ * reason (the constraint or nogood that forced it, or the assignment), so a
+ * conflict -- or an OR node whose values are all inconsistent -- can be traced
+ * back to a small set of variable assignments that cannot be extended. As in
+ * CDCL, only the variables fixed since the last assignment are expanded into
+ * their reasons. Learned nogoods take part in propagation just like the
+ * constraints; their number is bounded, and when the limit is exceeded the
+ * ones with the highest LBD (number of distinct assignment levels) and the
+ * fewest propagations since the last cleanup are deleted.
+ */
+class ConstraintPropagator {
+
+ public:
+  typedef size_t mark_t;
+  static const mark_t NO_MARK = (mark_t) -1;
+
+ protected:
+  /* a function with at least one zero entry */
+  struct Constraint {
+    const Function* fn;
+    vector<int> scope;       // same order as the function's table
+    vector<size_t> strides;  // table offset per scope position
+  };
+
+  /* trail entry, records the removal of value 'val' from variable 'var' */
+  struct Removal {
+    int var;
+    int val;
+  };
+
+  /* learned nogood, the assignments in 'lits' can't hold together */
+  struct Nogood {
+    vector<pair<int,int> > lits;  // (var,val) pairs
+    int lbd;                      // number of distinct levels of 'lits'
+    count_t hits;                 // propagations/conflicts since last cleanup
+  };
+
+  /* special removal reasons, constraint ids are >= 0 and nogood ids are
+   * encoded as REASON_NOGOOD - id */
+  enum { REASON_ROOT = -1, REASON_ASSIGN = -2, REASON_NOGOOD = -3 };
+
+  Problem* m_problem;
+  Pseudotree* m_pseudotree;
+
+  vector<Constraint> m_constraints;
+  vector<vector<int> > m_varConstraints;  // constraints per variable
+  vector<int> m_numUnfixed;  // per constraint, number of scope vars not fixed
+
+  vector<uint64_t> m_bits;     // domain bitsets, all variables back to back
+  vector<size_t> m_bitOffset;  // first word of each variable's bitset
+  vector<int> m_domSize;       // number of live values per variable
+  vector<int> m_fixedVal;      // value of fixed variables, NONE otherwise
+  vector<int> m_parent;        // pseudo tree parent per variable (or NONE)
+  vector<int> m_numWipeouts;   // per variable, number of empty domains in
+                               //   its pseudo tree subtree
+  int m_root;                  // pseudo tree root variable
+
+  vector<Removal> m_trail;
+  vector<int> m_queue;  // newly fixed variables, pending propagation
+
+  /* nogood learning, only active with m_maxNogoods > 0 */
+  size_t m_maxNogoods;          // bound on the number of stored nogoods
+  size_t m_maxNogoodSize;       // longer nogoods are not stored
+  vector<size_t> m_valOffset;   // first entry of each variable in m_reason
+  vector<int> m_reason;         // why a value was removed, per (var,val)
+  vector<int> m_level;          // assignment level at which a var was fixed
+  vector<mark_t> m_levelMarks;  // trail position at the start of each level
+  vector<int> m_levelVars;      // variable assigned at each level
+  vector<int> m_levelVals;      // and its value
+  vector<Nogood> m_nogoods;
+  vector<int> m_freeNogoods;    // ids of deleted nogoods, for reuse
+  size_t m_numLiveNogoods;
+  vector<vector<int> > m_varNogoods;  // nogood ids per variable
+  vector<int> m_conflictVars;   // variables involved in the last conflict
+
+  /* statistics */
+  count_t m_numAssign;
+  count_t m_numRemoved;
+  count_t m_numConflicts;
+  count_t m_numLearned;
+  count_t m_numNogoodsDeleted;
+  count_t m_numNogoodsDiscarded;  // exceeded m_maxNogoodSize
+  count_t m_numNogoodRemoved;     // values removed by nogoods
+
+ public:
+  /* enables nogood learning, keeping at most 'limit' nogoods with no more
+   * than 'maxSize' assignments each. Call before init(). */
+  void setNogoodLimit(size_t limit, size_t maxSize);
+
+  /* builds the constraint structures and propagates the unary constraints
+   * and initially fixed variables. Returns false if this already wipes out
+   * a domain, i.e. the problem has no solution with non-zero cost. */
+  bool init();
+
+  /* number of (non-nullary) functions with zero entries */
+  size_t getConstraintCount() const { return m_constraints.size(); }
+
+  /* current trail position, to be passed to backtrack() */
+  mark_t mark() const { return m_trail.size(); }
+
+  /* fixes var to val and propagates, returns false on a domain wipe-out */
+  bool assign(int var, int val);
+
+  /* undoes all changes recorded since the given trail position */
+  void backtrack(mark_t m);
+
+  /* true if nogoods are learned (see setNogoodLimit()) */
+  bool isLearning() const { return m_maxNogoods > 0; }
+
+  /* to be called when the subproblem rooted at var has no solution, i.e.,
+   * none of the values of var can be extended; since this is a property of
+   * the current assignment to the variables in 'context', a nogood is
+   * learned over those (plus the reasons for any values of the subproblem's
+   * variables that were removed by propagation). Assignments below var must
+   * have been undone already. */
+  void learnDeadEnd(int var, const vector<int>& context);
+
+  /* true iff val is still in the domain of var */
+  bool inDomain(int var, int val) const;
+
+  /* true if some domain is currently empty */
+  bool isWipedOut() const { return m_numWipeouts[m_root] > 0; }
+  /* true if some domain in the subproblem rooted at var is currently empty */
+  bool isWipedOut(int var) const { return m_numWipeouts[var] > 0; }
+
+  count_t getAssignCount() const { return m_numAssign; }
+  count_t getRemovedCount() const { return m_numRemoved; }
+  count_t getConflictCount() const { return m_numConflicts; }
+  count_t getLearnedCount() const { return m_numLearned; }
+  count_t getNogoodDeletedCount() const { return m_numNogoodsDeleted; }
+  count_t getNogoodDiscardedCount() const { return m_numNogoodsDiscarded; }
+  count_t getNogoodRemovedCount() const { return m_numNogoodRemoved; }
+  size_t getNogoodCount() const { return m_numLiveNogoods; }
+
+ protected:
+  /* removes val from var's domain (recorded on the trail), returns false
+   * if the domain becomes empty */
+  bool remove(int var, int val, int reason);
+  /* processes the queue of newly fixed variables until fixpoint/conflict */
+  bool propagate();
+  /* checks a nogood once one of its variables got fixed */
+  bool propagateNogood(int id);
+  /* adds the variables behind the removal of val from var to the conflict */
+  void addReason(int var, int val);
+  /* derives a nogood from m_conflictVars and stores it */
+  void learn();
+  void addNogood(const vector<pair<int,int> >& lits, int lbd);
+  /* deletes unlocked nogoods until at most half the limit are left */
+  void reduceNogoods();
+  bool isLocked(int id) const;
+  /* finds the single remaining value in a domain of size one */
+  int findFixedVal(int var) const;
+  /* adds d to the wipe-out count of var's subproblem and its ancestors' */
+  void countWipeout(int var, int d);
+
+ public:
+  ConstraintPropagator(Problem* p, Pseudotree* pt);
+};
+
+/* Inline definitions */
+
+inline bool ConstraintPropagator::inDomain(int var, int val) const {
+  return (m_bits[m_bitOffset[var] + (val >> 6)] >> (val & 63)) & 1;
+}
+
+}  // namespace daoopt
+
+#endif /* CONSTRAINTPROPAGATOR_H_ */
@@ -25,21 +25,11 @@
 #define DEFS_H_
 
 /******************************************************************
- * define NO_ASSIGNMENT to turn *off* MPE tuple computation, which
- * will speed up computation time
+ * NOTE: MPE tuple computation (formerly turned off by NO_ASSIGNMENT) and
+ * the AOBB "subproblem dive" (formerly ANYTIME_DEPTH) are selected at
+ * runtime, through the -track_assignment and -dive options.
  */
 
-#define NO_ASSIGNMENT
-
-/*****************************************************************/
-
-/******************************************************************
- * define LIKELIHOOD to compute likelihood instead of MPE
- * (HIGHLY EXPERIMENTAL)
- */
-
-//#define LIKELIHOOD
-
 /*****************************************************************/
 
 /******************************************************************
@@ -58,16 +48,6 @@
 
 /*****************************************************************/
 
-/*
- * define ANYTIME_DEPTH to enable "subproblem dive" with plain AOBB: performs
- * dive guided by mini bucket for every new (sub)subproblem, will ideally
- * yield better anytime performance.
- */
-
-//#define ANYTIME_DEPTH
-
-/*****************************************************************/
-
 
 /*****************************************************************/
 
@@ -86,6 +66,15 @@
 
 /*****************************************************************/
 
+/*****************************************************************
+ * define VALIDATE_PRUNING to check each pruning decision made against
+ * the cached ancestor thresholds by climbing to the root (slow)
+ */
+
+//#define VALIDATE_PRUNING
+
+/*****************************************************************/
+
 /******************************************************************
  * alias for val_t, the data type for variable values: larger types
  * allow higher max. domain size but use more memory. Set to exactly
@@ -108,18 +97,6 @@ typedef short val_t;
 /*****************************************************************/
 
 
-/* disable threading, tuple computation, and pruning for likelihood computation */
-#ifdef LIKELIHOOD
-  #define NO_ASSIGNMENT
-  #define NO_HEURISTIC
-  #ifndef NOTHREADS
-    #define NOTHREADS
-  #endif
-  #ifdef ANYTIME_DEPTH
-    #undef ANYTIME_DEPTH
-  #endif
-#endif
-
 /* disable parallelism if NOTHREADS is defined */
 #ifdef NOTHREADS
   #undef PARALLEL_DYNAMIC
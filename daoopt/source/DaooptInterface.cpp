@@ -207,6 +207,11 @@ double DaooptInterface::estimate(size_t sampleSize) const {
   return m_main->runEstimation(sampleSize);
 }
 
+bool DaooptInterface::estimateSize(size_t probes, SearchEstimate* est) const {
+  assert(m_initialized && m_preprocessed);
+  return m_main->runKnuthEstimation(probes, est);
+}
+
 bool DaooptInterface::solve(size_t nodeLimit) {
   assert(m_initialized && m_preprocessed);
   if (!m_main->runSearch(nodeLimit))
@@ -216,9 +221,27 @@ bool DaooptInterface::solve(size_t nodeLimit) {
   return true;
 }
 
+bool DaooptInterface::updateEvidence(const map<int,int>& delta) {
+  assert(m_initialized && m_preprocessed);
+  map<int,val_t> evid;
+  for (map<int,int>::const_iterator it = delta.begin(); it != delta.end(); ++it)
+    evid[it->first] = (it->second < 0) ? val_t(NONE) : val_t(it->second);
+  if (!m_main->updateEvidence(evid))
+    return false;
+  if (!m_main->runLDS())
+    return false;
+  if (!m_main->finishPreproc())
+    return false;
+  return true;
+}
+
+bool DaooptInterface::serve(const string& endpoint) {
+  assert(m_initialized && m_preprocessed);
+  return m_main->serve(endpoint);
+}
+
 double DaooptInterface::getSolution(vector<int>* assignment) const {
   double cost = m_main->getSolution();
-#ifndef NO_ASSIGNMENT
   if (assignment != NULL) {
 //    const vector<val_t>& assg = m_main->getSolutionAssg();
     vector<val_t> assg ;
@@ -228,7 +251,6 @@ double DaooptInterface::getSolution(vector<int>* assignment) const {
       assignment->push_back((int) *it);
     }
   }
-#endif
   return cost;
 }
 
@@ -51,6 +51,12 @@ public:
   // solved completely during estimation.
   double estimate(size_t sampleSize = 20000) const;
 
+  // Estimate the size of the search space (OR and AND nodes expanded by
+  // AOBB) from the given number of random probes, run in parallel threads
+  // (cf. -threads). Takes milliseconds, but requires a static mini bucket
+  // heuristic. Returns false on error.
+  bool estimateSize(size_t probes, SearchEstimate* est) const;
+
   // Solve the problem. Only do <limit> node expansions at a time (0=unlimited),
   // returns true if solved to completion, false otherwise.
   // To emulate anytime behavior, run with nodeLimit 10k or so and interleave
@@ -63,6 +69,17 @@ public:
   int stopSLS(void) ;
   bool execSLS(int nSlsIter, int slsTimePerIter);
 
+  // Updates the evidence of the preprocessed problem: maps variables of the
+  // original problem to their new evidence value (-1 retracts evidence).
+  // Only the parts of the heuristic that depend on the changed variables are
+  // recompiled, the search starts over. Returns true on success.
+  bool updateEvidence(const map<int,int>& delta);
+
+  // Keeps the preprocessed problem resident and answers MPE queries with
+  // different evidence, read from stdin ("-") or a Unix socket at the given
+  // path, until end of input or "quit" (see Main::serve()).
+  bool serve(const string& endpoint);
+
   // Gets the current best known solution. Also stores the corresponding
   // assignment in the referenced vector (if != null).
   double getSolution(vector<int>* assignment = NULL) const;
@@ -0,0 +1,283 @@
+/*
+ * EventFeed.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EventFeed.h"
+#include "SearchSpace.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std::chrono;
+
+namespace daoopt {
+
+extern high_resolution_clock::time_point _time_start;  // from Main.cpp
+
+/* how long the writer sleeps at most before looking at the queue (covers
+ * notifications that arrive while it's about to sleep) */
+static const milliseconds WRITER_POLL(100);
+
+EventFeed::EventFeed() :
+    m_binary(false), m_assignment(false), m_fd(-1), m_socket(false),
+    m_failed(false), m_queue(QUEUE_SIZE), m_dropped(0), m_closing(false) {}
+
+
+bool EventFeed::open(const string& target, const string& format,
+                     bool assignment) {
+  assert(m_fd == -1 && !m_writer.joinable());
+  if (format == "binary") {
+    m_binary = true;
+  } else if (format != "json") {
+    cerr << "Unknown event feed format " << format
+         << ", expected json or binary." << endl;
+    return false;
+  }
+  m_assignment = assignment;
+
+  const string unixPrefix = "unix:";
+  struct stat st;
+  if (target.compare(0, unixPrefix.size(), unixPrefix) == 0) {
+    string path = target.substr(unixPrefix.size());
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+      cerr << "Invalid event feed socket path " << path << endl;
+      return false;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd == -1 || connect(m_fd, (sockaddr*) &addr, sizeof(addr)) != 0) {
+      cerr << "Connecting event feed to " << path << " failed: "
+           << strerror(errno) << endl;
+      if (m_fd != -1)
+        ::close(m_fd);
+      m_fd = -1;
+      return false;
+    }
+    m_socket = true;
+  } else if (stat(target.c_str(), &st) == 0 && S_ISFIFO(st.st_mode)) {
+    m_fifo = target;
+    // a reader that goes away would raise SIGPIPE on the next write
+    signal(SIGPIPE, SIG_IGN);
+  } else {
+    m_fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_fd == -1) {
+      cerr << "Opening event feed " << target << " failed: "
+           << strerror(errno) << endl;
+      return false;
+    }
+  }
+
+  m_writer = std::thread(&EventFeed::writerLoop, this);
+  return true;
+}
+
+
+void EventFeed::push(FeedEvent* e) {
+  if (!m_writer.joinable() || !m_queue.tryPush(e)) {
+    delete e;
+    ++m_dropped;
+    return;
+  }
+  m_cond.notify_one();
+}
+
+
+FeedEvent* EventFeed::newEvent(char type, double lower, double upper,
+                               const SearchStats* stats) const {
+  FeedEvent* e = new FeedEvent;
+  e->type = type;
+  e->solved = false;
+  e->time = duration_cast<duration<double> >(
+      high_resolution_clock::now() - _time_start).count();
+  e->numOR = stats ? stats->numExpOR : 0;
+  e->numAND = stats ? stats->numExpAND : 0;
+  e->lower = lower;
+  e->upper = upper;
+  return e;
+}
+
+
+void EventFeed::post(char type, double lower, double upper,
+                     const SearchStats* stats,
+                     const vector<val_t>* assignment) {
+  if (m_closing)
+    return;
+  FeedEvent* e = newEvent(type, lower, upper, stats);
+  if (m_assignment && assignment)
+    e->assignment = *assignment;
+  push(e);
+}
+
+
+void EventFeed::finish(double lower, double upper, const SearchStats* stats,
+                       bool solved) {
+  if (m_closing)
+    return;
+  FeedEvent* e = newEvent(EVENT_END, lower, upper, stats);
+  e->solved = solved;
+  push(e);
+  close();
+}
+
+
+void EventFeed::close() {
+  if (m_writer.joinable()) {
+    m_closing = true;
+    m_cond.notify_one();
+    m_writer.join();
+  }
+  if (m_fd != -1) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  FeedEvent* e;
+  while (m_queue.tryPop(e))
+    delete e;
+}
+
+
+static void appendJsonNumber(double x, string& out) {
+  if (!std::isfinite(x)) {
+    out += "null";
+    return;
+  }
+  oss ss;
+  ss << std::setprecision(20) << x;
+  out += ss.str();
+}
+
+template <class T>
+static void appendBinary(const T& x, string& out) {
+  out.append(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+void EventFeed::encode(const FeedEvent& e, string& out) const {
+  if (m_binary) {
+    appendBinary<uint8_t>(e.type, out);
+    appendBinary<uint8_t>(e.solved ? 1 : 0, out);
+    appendBinary<uint16_t>(0, out);
+    appendBinary<uint32_t>(e.type == EVENT_END ? m_dropped.load()
+                                               : e.assignment.size(), out);
+    appendBinary<double>(e.time, out);
+    appendBinary<uint64_t>(e.numOR, out);
+    appendBinary<uint64_t>(e.numAND, out);
+    appendBinary<double>(e.lower, out);
+    appendBinary<double>(e.upper, out);
+    for (val_t v : e.assignment)
+      appendBinary<int32_t>(v, out);
+    return;
+  }
+
+  oss ss;
+  ss << "{\"event\":\"" << (e.type == EVENT_SOLUTION ? "solution" :
+                            e.type == EVENT_BOUND ? "bound" : "end")
+     << "\",\"time\":" << e.time << ",\"or\":" << e.numOR
+     << ",\"and\":" << e.numAND << ",\"lower\":";
+  out += ss.str();
+  appendJsonNumber(e.lower, out);
+  out += ",\"upper\":";
+  appendJsonNumber(e.upper, out);
+  if (e.type == EVENT_END) {
+    oss se;
+    se << ",\"solved\":" << (e.solved ? "true" : "false")
+       << ",\"dropped\":" << m_dropped.load();
+    out += se.str();
+  }
+  if (!e.assignment.empty()) {
+    out += ",\"assignment\":[";
+    for (size_t i = 0; i < e.assignment.size(); ++i) {
+      if (i)
+        out += ',';
+      out += std::to_string((int) e.assignment[i]);
+    }
+    out += ']';
+  }
+  out += "}\n";
+}
+
+
+bool EventFeed::writeAll(const string& out) {
+  size_t done = 0;
+  while (done < out.size()) {
+    ssize_t n = m_socket ?
+        send(m_fd, out.data() + done, out.size() - done, MSG_NOSIGNAL) :
+        write(m_fd, out.data() + done, out.size() - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    done += n;
+  }
+  return true;
+}
+
+
+void EventFeed::writerLoop() {
+  if (!m_fifo.empty()) {
+    // wait for a reader to open the FIFO (or for close())
+    while (m_fd == -1 && !m_closing) {
+      m_fd = ::open(m_fifo.c_str(), O_WRONLY | O_NONBLOCK);
+      if (m_fd != -1) {
+        // writes may block the writer thread, just not the search
+        fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_NONBLOCK);
+        break;
+      }
+      if (errno != ENXIO) {  // (ENXIO: no reader yet)
+        m_failed = true;
+        break;
+      }
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_cond.wait_for(lk, WRITER_POLL);
+    }
+  }
+
+  string buf;
+  FeedEvent* e;
+  while (true) {
+    bool closing = m_closing;  // (read before draining the queue)
+    while (m_queue.tryPop(e)) {
+      if (!m_failed && m_fd != -1)
+        encode(*e, buf);
+      delete e;
+    }
+    if (!buf.empty()) {
+      if (!writeAll(buf) && !m_failed) {
+        m_failed = true;
+        myprint("Event feed closed by the consumer.\n");
+      }
+      buf.clear();
+    }
+    if (closing)
+      break;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_cond.wait_for(lk, WRITER_POLL,
+                    [this]() { return m_closing || !m_queue.empty(); });
+  }
+}
+
+}  // namespace daoopt
@@ -0,0 +1,133 @@
+/*
+ * EventFeed.h
+ *
+ *  Streams solution and bound updates to an external consumer (file, FIFO
+ *  or local socket) as newline-delimited JSON or binary records
+ *  (-event_feed).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTFEED_H_
+#define EVENTFEED_H_
+
+#include "_base.h"
+
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace daoopt {
+
+class SearchStats;
+
+/* event types (also the type byte of binary records) */
+#define EVENT_SOLUTION 'u'  // new incumbent
+#define EVENT_BOUND 'h'     // new upper bound
+#define EVENT_END 'e'       // end of the run
+
+/* one update, as queued for the writer thread */
+struct FeedEvent {
+  char type;
+  bool solved;          // (end event) solved to optimality?
+  double time;          // seconds since the start of the run
+  size_t numOR;         // OR/AND nodes expanded so far
+  size_t numAND;
+  double lower;         // solution cost and upper bound (log10 scale,
+  double upper;         //   as in the "u"/"h" output lines)
+  vector<val_t> assignment;  // (optional) incumbent, incl. evidence
+};
+
+/*
+ * The search thread only copies the update into a FeedEvent and pushes it
+ * onto a lock-free RingBuffer; a writer thread encodes and writes whatever
+ * has accumulated, one write per batch. If the consumer falls so far behind
+ * that the buffer fills up, updates are dropped (and counted in the end
+ * event) rather than blocking the search.
+ *
+ * Targets:
+ * - "unix:<path>" connects to a local stream socket;
+ * - an existing FIFO is opened by the writer thread (so the run doesn't
+ *   wait for the reader to show up, updates queue in the meantime);
+ * - anything else is created (truncated) as a regular file.
+ * If the consumer goes away, the feed stops without affecting the run.
+ *
+ * JSON records are single lines, e.g.
+ *   {"event":"solution","time":0.52,"or":1234,"and":2345,
+ *    "lower":-21.77,"upper":-20.1,"assignment":[0,1,...]}
+ * with null for unknown (non-finite) bounds; the end event adds "solved"
+ * and "dropped". Binary records are little-endian (host order), 48 bytes
+ * plus the assignment:
+ *   uint8 type, uint8 flags (1: solved), uint16 reserved, uint32 n,
+ *   double time, uint64 or, uint64 and, double lower, double upper,
+ *   int32 assignment[n]
+ * (the end event reports the dropped count in place of n, without values).
+ */
+class EventFeed {
+
+ protected:
+  bool m_binary;       // binary records instead of JSON
+  bool m_assignment;   // include the incumbent assignment
+  int m_fd;            // target file descriptor (-1 if not open)
+  bool m_socket;
+  string m_fifo;       // FIFO to open in the writer thread, if any
+  bool m_failed;       // set by the writer once the target fails
+
+  RingBuffer<FeedEvent*> m_queue;
+  std::atomic<size_t> m_dropped;
+  std::atomic<bool> m_closing;
+  std::mutex m_mtx;    // (only for the writer's sleep)
+  std::condition_variable m_cond;
+  std::thread m_writer;
+
+  /* number of queued events */
+  static const size_t QUEUE_SIZE = 4096;
+
+ protected:
+  void writerLoop();
+  void encode(const FeedEvent& e, string& out) const;
+  /* writes out completely, returns false on error */
+  bool writeAll(const string& out);
+  FeedEvent* newEvent(char type, double lower, double upper,
+                      const SearchStats* stats) const;
+  /* queues e (or drops it if the queue is full) */
+  void push(FeedEvent* e);
+
+ public:
+  /* opens the target and starts the writer thread, returns false (with a
+   * message on cerr) if the target can't be opened */
+  bool open(const string& target, const string& format, bool assignment);
+  bool wantsAssignment() const { return m_assignment; }
+
+  /* queues an update; never blocks */
+  void post(char type, double lower, double upper,
+            const SearchStats* stats, const vector<val_t>* assignment);
+  /* queues the end event, then writes all pending events and closes */
+  void finish(double lower, double upper, const SearchStats* stats,
+              bool solved);
+  /* writes all pending events and closes the target */
+  void close();
+
+  EventFeed();
+  ~EventFeed() { close(); }
+};
+
+}  // namespace daoopt
+
+#endif /* EVENTFEED_H_ */
@@ -196,7 +196,7 @@ void FGLPMBEHybrid::getLabelAll(int var, const vector<val_t> &assignment,
 mex::vector<mex::Factor> FGLPMBEHybrid::copyFactors(void) {
   mex::vector<mex::Factor> fs(m_problem->getC());
   for (int i = 0; i < m_problem->getC(); ++i)
-    fs[i] = m_problem->getFunctions()[i]->asFactor().exp();
+    m_problem->getFunctions()[i]->toFactor(fs[i], true);
   return fs;
 }
 
@@ -217,7 +217,7 @@ void FGLPMBEHybrid::rewriteFactors(const vector<mex::Factor> &factors) {
     newFunctions.push_back(new FunctionBayes(f, m_problem, scope, tablePtr,
                                              factors[f].nrStates()));
     newFunctions[f]
-        ->fromFactor(log(factors[f]));  // write in log factor functions
+        ->fromFactor(factors[f], true);  // write in log factor functions
   }
   double *table1 = new double[1];
   table1[0] = m_problem->globalConstInfo();
@@ -32,7 +32,6 @@ namespace daoopt {
 Function::Function(const int& id, Problem* p, const set<int>& scope, double* T, const size_t& size) :
   m_id(id), m_problem(p), m_table(T), m_tableSize(size),
   m_scopeS(scope), m_scopeV(scope.begin(), scope.end()) {
-#ifdef PRECOMP_OFFSETS
   m_offsets.resize(scope.size());
   size_t offset = 1;
   vector<int>::reverse_iterator rit; vector<size_t>::reverse_iterator ritOff;
@@ -40,47 +39,84 @@ Function::Function(const int& id, Problem* p, const set<int>& scope, double* T,
     *ritOff = offset;
     offset *= m_problem->getDomainSize(*rit);
   }
-#endif
 }
 
+/* Copies a table between the daoopt layout (last scope variable has stride 1)
+ * and the mex layout (first variable has stride 1), both over the scope in
+ * increasing variable order, applying op to each value. Walks the mex layout
+ * linearly and tracks the daoopt index with an odometer, so no per-entry
+ * index conversion is needed. */
+template <class Op>
+static void transposeTable(const vector<int>& scope, const Problem* p,
+                           const double* src, double* dst, bool toMex,
+                           Op op) {
+  size_t n = scope.size();
+  vector<size_t> dom(n), off(n), digit(n, 0);
+  size_t total = 1;
+  for (int k = n - 1; k >= 0; --k) {
+    dom[k] = p->getDomainSize(scope[k]);
+    off[k] = total;
+    total *= dom[k];
+  }
+  if (n <= 1) {  // layouts coincide
+    for (size_t j = 0; j < total; ++j) dst[j] = op(src[j]);
+    return;
+  }
+  size_t idx = 0;
+  for (size_t j = 0; j < total; ++j) {
+    if (toMex) dst[j] = op(src[idx]);
+    else dst[idx] = op(src[j]);
+    for (size_t k = 0; k < n; ++k) {
+      idx += off[k];
+      if (++digit[k] < dom[k]) break;
+      digit[k] = 0;
+      idx -= dom[k] * off[k];
+    }
+  }
+}
+
+struct OpCopy { double operator()(double x) const { return x; } };
+struct OpExp { double operator()(double x) const { return std::exp(x); } };
+struct OpLog { double operator()(double x) const { return std::log(x); } };
+
 /* ATI: convert between mex/Factor representation and daoopt Function representation */
 mex::Factor Function::asFactor() {
-  mex::VarSet vs;
-  for (vector<int>::iterator it=m_scopeV.begin();it!=m_scopeV.end();++it) vs+=mex::Var(*it,m_problem->getDomainSize(*it));
-  mex::Factor F(vs, 0.0); //m_table);
-  mex::vector<mex::Var> ord(vs.begin(),vs.end());
-  mex::permuteIndex pi(ord,true);
-  for (size_t j=0;j<F.numel();j++) F[j]=m_table[pi.convert(j)]; //F[pi.convertLinearIndex(j)]=m_table[j];
+  mex::Factor F;
+  toFactor(F);
   return F;
 }
 void Function::fromFactor(const mex::Factor& F) {
+  fromFactor(F, false);
+}
+
+void Function::toFactor(mex::Factor& F, bool exponentiate) const {
   mex::VarSet vs;
-  for (vector<int>::iterator it=m_scopeV.begin();it!=m_scopeV.end();++it) vs+=mex::Var(*it,m_problem->getDomainSize(*it));
-  assert( vs == F.vars() );
-
-  mex::vector<mex::Var> ord(F.vars().begin(),F.vars().end());
-  mex::permuteIndex pi(ord,true);
-  //cout << F.numel() << endl;
-//  for (size_t j=0;j<F.numel();++j) cout << F[j] << endl;
-  for (size_t j=0;j<F.numel();j++) m_table[pi.convert(j)] = F[j]; //m_table[j] = F[pi.convertLinearIndex(j)];
+  for (vector<int>::const_iterator it=m_scopeV.begin();it!=m_scopeV.end();++it) vs+=mex::Var(*it,m_problem->getDomainSize(*it));
+  mex::Factor G(vs, 0.0);
+  if (exponentiate)
+    transposeTable(m_scopeV, m_problem, m_table, &G[0], true, OpExp());
+  else
+    transposeTable(m_scopeV, m_problem, m_table, &G[0], true, OpCopy());
+  F.swap(G);
+}
+
+void Function::fromFactor(const mex::Factor& F, bool logarithm) {
+  assert(F.nrStates() == m_tableSize);
+  assert(F.vars().nvar() == m_scopeV.size());
+  if (logarithm)
+    transposeTable(m_scopeV, m_problem, F.table(), m_table, false, OpLog());
+  else
+    transposeTable(m_scopeV, m_problem, F.table(), m_table, false, OpCopy());
 }
 
 /* returns the table entry for the assignment (input is vector of val_t) */
 double Function::getValue(const vector<val_t>& assignment) const {
 //  assert(isInstantiated(assignment)); // make sure scope is fully instantiated
-#ifdef PRECOMP_OFFSETS
   size_t idx = 0;
   vector<int>::const_iterator it=m_scopeV.begin();
   vector<size_t>::const_iterator itOff=m_offsets.begin();
   for (; it!=m_scopeV.end(); ++it, ++itOff)
     idx += assignment[*it] * (*itOff);
-#else
-  size_t idx = 0, offset=1;
-  for (vector<int>::const_reverse_iterator rit=m_scopeV.rbegin(); rit!=m_scopeV.rend(); ++rit) {
-    idx += assignment[*rit] * offset;
-    offset *= m_problem->getDomainSize(*rit);
-  }
-#endif
   assert(idx < m_tableSize);
   return m_table[idx];
 }
@@ -91,7 +127,6 @@ void Function::getValues(const vector<val_t>& assignment, int var, vector<double
   out.resize((int) m_problem->getDomainSize(var));
   // compute fixed portion of index, cache offset for var
   size_t idx = 0, varOffset = 0;
-#ifdef PRECOMP_OFFSETS
   vector<int>::const_iterator it=m_scopeV.begin();
   vector<size_t>::const_iterator itOff=m_offsets.begin();
   for (; it!=m_scopeV.end(); ++it, ++itOff) {
@@ -100,16 +135,6 @@ void Function::getValues(const vector<val_t>& assignment, int var, vector<double
     else
       varOffset = *itOff;
   }
-#else
-  size_t offset = 1;
-  for (vector<int>::const_reverse_iterator rit=m_scopeV.rbegin(); rit!=m_scopeV.rend(); ++rit) {
-    if (*rit != var)
-      idx += assignment[*rit] * offset;
-    else
-      varOffset = offset;
-    offset *= m_problem->getDomainSize(*rit);
-  }
-#endif
   // look up and store entries for each value of var
   for (size_t i=0; i < out.size(); ++i) {
     out[i] = m_table[idx];
@@ -121,38 +146,18 @@ void Function::getValues(const vector<val_t>& assignment, int var, vector<double
 /* returns the table entry for the assignment (input is vector of pointers to val_t) */
 double Function::getValuePtr(const vector<val_t*>& tuple) const {
   assert(tuple.size() == m_scopeV.size()); // make sure tuple size matches scope size
-#ifdef PRECOMP_OFFSETS
   size_t idx = 0;
   for (size_t i=0; i<m_scopeV.size(); ++i)
     idx += *(tuple[i]) * m_offsets[i];
-#else
-  size_t idx = 0, offset=1;
-  vector<int>::const_reverse_iterator rit=m_scopeV.rbegin();
-  vector<val_t*>::const_reverse_iterator ritTup = tuple.rbegin();
-  for (; rit!=m_scopeV.rend(); ++rit,++ritTup) {
-    idx += *(*ritTup) * offset;
-    offset *= m_problem->getDomainSize(*rit);
-  }
-#endif
   assert(idx < m_tableSize);
   return m_table[idx];
 }
 
 void Function::setValuePtr(const vector<val_t*>& tuple, double value) {
   assert(tuple.size() == m_scopeV.size()); // make sure tuple size matches scope size
-#ifdef PRECOMP_OFFSETS
   size_t idx = 0;
   for (size_t i=0; i<m_scopeV.size(); ++i)
     idx += *(tuple[i]) * m_offsets[i];
-#else
-  size_t idx = 0, offset=1;
-  vector<int>::const_reverse_iterator rit=m_scopeV.rbegin();
-  vector<val_t*>::const_reverse_iterator ritTup = tuple.rbegin();
-  for (; rit!=m_scopeV.rend(); ++rit,++ritTup) {
-    idx += *(*ritTup) * offset;
-    offset *= m_problem->getDomainSize(*rit);
-  }
-#endif
   assert(idx < m_tableSize);
   m_table[idx] = value;
 }
@@ -24,9 +24,6 @@
 #ifndef FUNCTION_H_
 #define FUNCTION_H_
 
-/* define to enable precomputation of the offsets for value lookup */
-#define PRECOMP_OFFSETS
-
 #include "_base.h"
 #include "utils.h"
 #include "mex/include/VarSet.h"
@@ -51,9 +48,7 @@ protected:
   set<int> m_scopeS;      // Scope of the function as set
   vector<int> m_scopeV;   // Scope in vector form
 
-#ifdef PRECOMP_OFFSETS
   vector<size_t> m_offsets;  // Precomputed offsets for value lookup
-#endif
 
   /* Tightness related information */
   size_t m_tightness;     // number of valid entries in table
@@ -105,11 +100,20 @@ public:
 	/* ATI: convert between mex/Factor and daoopt/Function representations */
 	mex::Factor asFactor();
 	void fromFactor(const mex::Factor&);
+  /* same, but fills F in place (its previous contents are discarded) and
+   * optionally applies exp() resp. log() to the values on the fly, saving
+   * the intermediate factor copies of asFactor().exp() and the like */
+  void toFactor(mex::Factor& F, bool exponentiate = false) const;
+  void fromFactor(const mex::Factor& F, bool logarithm);
 
   void setTableValue(int idx, double val) {
     m_table[idx] = val;
   }
 
+  /* for a table in memory the function doesn't own (e.g. a mapped file),
+   * to be called before the function is deleted */
+  void detachTable() { m_table = NULL; }
+
 protected:
   /* main work for substitution: computes new scope, new table and table size
    * and stores them in the three non-const argument references */
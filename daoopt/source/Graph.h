@@ -25,16 +25,12 @@
 #define GRAPH_H_
 
 /* uncomment to use separate edge list, uses more memory but
- * speeds up the hasEdge() queries */
+ * speeds up the hasEdge() queries (when there's no adjacency matrix) */
 //#define USE_EDGE_LIST
-/* uncomment to use adjacency matrix, uses even more memory but
- * yields fastest hasEdge() queries */
-#define USE_ADJ_MATRIX
-
-/* use at most one of adj. matrix or edge list, prefer matrix */
-#ifdef USE_ADJ_MATRIX
-#undef USE_EDGE_LIST
-#endif
+/* an adjacency matrix, which uses even more memory but yields fastest
+ * hasEdge() queries, is kept unless it would exceed this number of
+ * entries (bits) */
+#define ADJ_MATRIX_MAX_ENTRIES (size_t(1) << 30)  // 128 MByte
 
 
 /* class to be used for the neighbor sets, either hash_map or map
@@ -65,11 +61,11 @@ typedef pair<int,int> Edge;
  * node. It could could thus represent a directed graph, but
  * in the implementation edges and their reverse edges are
  * kept in sync.
- * If USE_EDGE_LIST is defined, a global list of edges is
- * maintained as well, to speed up hasEdge() queries.
- * It USE_ADJ_MATRIX is defined, an adjacency matrix is
- * maintained, speeding up hasEdge() queries, but at increased
- * memory cost.
+ * If the graph is small enough (cf. ADJ_MATRIX_MAX_ENTRIES),
+ * an adjacency matrix is maintained, speeding up hasEdge()
+ * queries, but at increased memory cost. Otherwise, if
+ * USE_EDGE_LIST is defined, a global list of edges is
+ * maintained for the same purpose.
  */
 class Graph {
 protected:
@@ -77,10 +73,9 @@ protected:
 #ifdef USE_EDGE_LIST
   SETCLASS<Edge> m_edges;                 // Edge list
 #endif
-#ifdef USE_ADJ_MATRIX
-  int m_n;
+  size_t m_n;
+  bool m_useMatrix;                       // maintain the adjacency matrix?
   vector<bool> m_matrix;                  // Adjacency matrix
-#endif
 
   int m_statNumNodes;                      // No. of vertices
   int m_statNumEdges;                      // No. of edges
@@ -130,17 +125,17 @@ public:
  ****************************/
 
 /* Constructor */
-inline Graph::Graph(const int& n) : m_statNumNodes(0), m_statNumEdges(0) {
+inline Graph::Graph(const int& n) :
+    m_n(n), m_useMatrix(size_t(n) * n <= ADJ_MATRIX_MAX_ENTRIES),
+    m_statNumNodes(0), m_statNumEdges(0) {
 #if defined HASH_GOOGLE_DENSE || defined HASH_GOOGLE_SPARSE
   m_neighbors.set_deleted_key(UNKNOWN);
 #endif
 #ifdef HASH_GOOGLE_DENSE
   m_neighbors.set_empty_key(UNKNOWN-1);
 #endif
-#ifdef USE_ADJ_MATRIX
-  m_n = n;
-  m_matrix.resize(n*n);
-#endif
+  if (m_useMatrix)
+    m_matrix.resize(m_n*m_n);
 }
 
 
@@ -226,9 +221,8 @@ inline bool Graph::hasNode(const int& i) {
 
 /* returns TRUE iff edge between nodes i and j exists */
 inline bool Graph::hasEdge(const int& i, const int& j) {
-#ifdef USE_ADJ_MATRIX
-  return m_matrix[i*m_n+j];
-#endif
+  if (m_useMatrix)
+    return m_matrix[i*m_n+j];
 #ifdef USE_EDGE_LIST
   if (i<j) return m_edges.find(make_pair(i,j)) != m_edges.end();
   else return m_edges.find(make_pair(j,i)) != m_edges.end();
@@ -252,9 +246,8 @@ inline void Graph::addAdjacency(const int& i, const int& j) {
   set<int>& s = it->second;
   //if (s.find(j) == s.end())  // TODO check not required?
     s.insert(j);
-#ifdef USE_ADJ_MATRIX
-  m_matrix[i*m_n+j] = 1;
-#endif
+  if (m_useMatrix)
+    m_matrix[i*m_n+j] = 1;
 }
 
 
@@ -264,9 +257,8 @@ inline void Graph::removeAdjacency(const int& i, const int& j) {
   if (iti != m_neighbors.end()) {
     iti->second.erase(j);
   }
-#ifdef USE_ADJ_MATRIX
-  m_matrix[i*m_n+j] = 0;
-#endif
+  if (m_useMatrix)
+    m_matrix[i*m_n+j] = 0;
 }
 
 
@@ -97,6 +97,17 @@ public:
 	  return false;
   }
 
+  /* Rebuilds the heuristic after the functions over the given variables
+   * changed (e.g. through new evidence). Implementations can reuse the
+   * parts of the previous compilation that don't depend on the changes,
+   * by default the heuristic is built from scratch.
+   * Returns the memory size of the heuristic instance, like build().
+   */
+  virtual size_t rebuild(const std::vector<int>& changedVars,
+                         const std::vector<val_t>* assignment = NULL) {
+    return build(assignment, true);
+  }
+
   /* Reads and writes heuristic from/to specified file.
    * Should return true/false on success or failure, respectively.
    */
@@ -143,6 +154,12 @@ public:
    */
   virtual bool isAccurate() { return false; }
 
+  /* Returns true if the query functions (getHeur(), getLabel() etc.) may be
+   * called by several searches in different threads at once, i.e. they
+   * don't modify the instance. Default false.
+   */
+  virtual bool isThreadSafe() const { return false; }
+
   virtual double getHeurCompTime() const { return m_heurCompTime; }
   virtual double getHeurRootCompTime() const { return m_heurRootCompTime; }
 
@@ -165,6 +182,10 @@ inline bool Heuristic::calculatePruning(int var, SearchNode* node,
 
   if (curPSTVal <= curOR->getValue()) return true;
 
+  // use the ancestors' threshold if the search has cached it
+  if (curOR->getAncestorBoundEpoch() != 0)
+    return curPSTVal <= curOR->getAncestorBound();
+
   SearchNode *curAND = NULL;
 
   while (curOR->getParent()) {
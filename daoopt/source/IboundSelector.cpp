@@ -0,0 +1,126 @@
+/*
+ * IboundSelector.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IboundSelector.h"
+#include "KnuthEstimator.h"
+
+#include <chrono>
+using namespace std::chrono;
+
+namespace daoopt {
+
+/* upper bound and incumbent closer than this (log10) count as equal */
+static const double GAP_EPSILON = 1e-6;
+
+IboundSelector::IboundSelector(Problem* p, Pseudotree* pt,
+                               ProgramOptions* po,
+                               const vector<val_t>* assignment,
+                               size_t probes) :
+    m_problem(p), m_pseudotree(pt), m_options(po), m_assignment(assignment),
+    m_probes(max<size_t>(probes, 1)), m_built(false) {
+  assert(p && pt && po);
+}
+
+
+void IboundSelector::log(const string& msg) const {
+  myprint("i-bound selection: " + msg + "\n");
+}
+
+
+int IboundSelector::select(MiniBucketElim* mbe, int maxIbound,
+                           double incumbent) {
+  assert(mbe);
+  int threads = max(1, m_options->threads);
+  int best = NONE, last = NONE;
+  double bestTotal = 0;
+  double measured = 0;      // build time at the last built i-bound
+  size_t measuredSize = 0;  // its table size
+  int worse = 0;
+  // (simulating resets the tables)
+  MiniBucketElim sizer(m_problem, m_pseudotree, m_options, 1);
+
+  for (int i = 1; i <= maxIbound; ++i) {
+    sizer.setIbound(i);
+    size_t size = sizer.build(m_assignment, false);
+    double mbytes = (size / (1024 * 1024.0)) * sizeof(double);
+    oss ss;
+    ss << "i=" << i << ": " << mbytes << " MBytes";
+    if (m_options->memlimit != NONE && mbytes > m_options->memlimit) {
+      ss << ", over the memory limit";
+      log(ss.str());
+      break;
+    }
+    if (best != NONE && measuredSize &&
+        measured * size / measuredSize > bestTotal) {
+      ss << ", build predicted to take longer than " << bestTotal
+         << " seconds";
+      log(ss.str());
+      break;
+    }
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    mbe->setIbound(i);
+    mbe->build(m_assignment, true);
+    double build = duration_cast<duration<double> >(
+        high_resolution_clock::now() - start).count();
+    measured = build;
+    measuredSize = max<size_t>(size, 1);
+    last = i;
+    ss << ", built in " << build << " seconds";
+
+    double gap = ELEM_NAN;
+    if (!ISNAN(incumbent)) {
+      gap = mbe->getGlobalUB() OP_DIVIDE incumbent;
+      ss << ", gap " << gap;
+    }
+
+    KnuthEstimator estimator(m_problem, m_pseudotree, mbe);
+    estimator.setBound(incumbent);
+    estimator.setCaching(!m_options->nocaching);
+    estimator.setSeed(m_options->seed);
+    SearchEstimate est = estimator.run(m_probes, threads);
+    double perNode = (est.msec / 1000) * threads / max<size_t>(est.visited, 1);
+    double total = build + est.nodes * perNode;
+    ss << ", 10^" << log10(est.nodes) << " nodes, predicted total " << total
+       << " seconds";
+    log(ss.str());
+
+    if (best == NONE || total < bestTotal) {
+      best = i;
+      bestTotal = total;
+      worse = 0;
+    } else if (++worse >= MAX_WORSE) {
+      break;
+    }
+    if (!ISNAN(gap) && gap <= GAP_EPSILON) {
+      log("upper bound matches the incumbent");
+      break;
+    }
+  }
+
+  if (best == NONE)
+    best = 1;  // not even i=1 fits, leave it to the memory limit
+  m_built = (best == last);
+  oss ss;
+  ss << "mini bucket i-bound " << best;
+  log(ss.str());
+  return best;
+}
+
+}  // namespace daoopt
@@ -0,0 +1,89 @@
+/*
+ * IboundSelector.h
+ *
+ *  Picks the mini bucket i-bound that minimizes the predicted total solve
+ *  time, i.e., heuristic compilation plus search (-ibound_select).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IBOUNDSELECTOR_H_
+#define IBOUNDSELECTOR_H_
+
+#include "_base.h"
+
+#include "MiniBucketElim.h"
+#include "Problem.h"
+#include "ProgramOptions.h"
+#include "Pseudotree.h"
+
+namespace daoopt {
+
+/*
+ * The i-bounds are tried in increasing order. For each one the heuristic is
+ * built and timed, and the accuracy it buys is measured in two ways:
+ * - the gap between its global upper bound and the incumbent (from SLS, if
+ *   any); if it closes, larger i-bounds can't reduce the search any further;
+ * - the size of the AOBB search space, estimated from random probes that
+ *   prune with the incumbent (see KnuthEstimator). The time per node is
+ *   calibrated from the probes themselves, which do the same heuristic
+ *   queries per node as AOBB (but none of its caching and propagation, so
+ *   the search time is rather underestimated).
+ * The predicted total time is the build time plus estimated nodes times time
+ * per node. Trials stop at the memory limit, once the build alone is
+ * predicted (from the table sizes) to take longer than the best total so
+ * far, or after two i-bounds in a row that don't improve it.
+ *
+ * Mini bucket partitions differ between i-bounds, so tables can't be carried
+ * over from one trial to the next. But if the trials run on the heuristic
+ * used for search (no FGLP/JGLP), its tables are kept when the last trial is
+ * the selected i-bound (see isBuilt()).
+ */
+class IboundSelector {
+
+ protected:
+  Problem* m_problem;
+  Pseudotree* m_pseudotree;
+  ProgramOptions* m_options;
+  const vector<val_t>* m_assignment;
+  size_t m_probes;  // per i-bound
+  bool m_built;     // was the selected i-bound the last one built?
+
+  /* i-bounds without improvement before the trials stop */
+  static const int MAX_WORSE = 2;
+
+ protected:
+  void log(const string& msg) const;
+
+ public:
+  /* returns the selected i-bound, at most maxIbound, building mbe for the
+   * trials (Main passes the search heuristic only if it's a plain
+   * MiniBucketElim without FGLP/JGLP, and a plain copy with FGLP/JGLP off
+   * otherwise, so no reparameterization runs in the trials); incumbent is
+   * the best known solution cost (ELEM_NAN for none). Table sizes are
+   * simulated on a separate instance, so mbe keeps the tables of its last
+   * trial. */
+  int select(MiniBucketElim* mbe, int maxIbound, double incumbent);
+  /* true if mbe holds the tables of the selected i-bound after select() */
+  bool isBuilt() const { return m_built; }
+
+  IboundSelector(Problem* p, Pseudotree* pt, ProgramOptions* po,
+                 const vector<val_t>* assignment, size_t probes);
+};
+
+}  // namespace daoopt
+
+#endif /* IBOUNDSELECTOR_H_ */
@@ -0,0 +1,239 @@
+/*
+ * KnuthEstimator.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KnuthEstimator.h"
+
+#include <boost/random/uniform_int.hpp>
+#include <chrono>
+#include <thread>
+using namespace std::chrono;
+
+namespace daoopt {
+
+KnuthEstimator::KnuthEstimator(Problem* p, Pseudotree* pt, Heuristic* h) :
+    m_problem(p), m_pseudotree(pt), m_heuristic(h), m_bound(ELEM_NAN),
+    m_caching(true), m_seed(1) {
+  assert(p && pt && h);
+  m_cap.resize(pt->getN(), std::numeric_limits<double>::infinity());
+  m_order.push_back(pt->getRoot()->getVar());
+  for (size_t i = 0; i < m_order.size(); ++i) {
+    PseudotreeNode* node = pt->getNode(m_order[i]);
+    for (PseudotreeNode* c : node->getChildren())
+      m_order.push_back(c->getVar());
+    // same condition as Search::doCaching(), for full contexts only
+    // (adaptive caching resets its tables, no fixed cap then)
+    PseudotreeNode* parent = node->getParent();
+    if (!parent || !parent->getParent())
+      continue;
+    const vector<int>& ctxt = node->getFullContextVec();
+    if (ctxt.size() > parent->getFullContextVec().size() ||
+        node->getCacheContextVec().size() != ctxt.size())
+      continue;
+    double size = 1;
+    for (int v : ctxt)
+      size *= m_problem->getDomainSize(v);
+    m_cap[m_order[i]] = size;
+  }
+}
+
+
+double KnuthEstimator::bounds(Prober& p, int var, vector<double>& f) const {
+  int dom = m_problem->getDomainSize(var);
+  f.resize(dom);
+  double best = ELEM_ZERO;
+  for (int i = 0; i < dom; ++i) {
+    p.assignment[var] = i;
+    double label = m_heuristic->getLabel(var, p.assignment, NULL);
+    if (label == ELEM_ZERO) {
+      f[i] = ELEM_ZERO;  // dead end
+      continue;
+    }
+    f[i] = label OP_TIMES m_heuristic->getHeur(var, p.assignment, NULL);
+    best = max(best, f[i]);
+  }
+  p.assignment[var] = UNKNOWN;
+  return best;
+}
+
+
+void KnuthEstimator::probeOR(Prober& p, int var, const vector<double>& f,
+                             double path, double w) const {
+  p.weightOR[var] = w;
+  ++p.visited;
+  // collect the children that would survive pruning
+  vector<int> alive;
+  for (size_t i = 0; i < f.size(); ++i) {
+    if (f[i] == ELEM_ZERO)
+      continue;
+    if (!ISNAN(m_bound) && (path OP_TIMES f[i]) <= m_bound)
+      continue;
+    alive.push_back(i);
+  }
+  if (alive.empty())
+    return;
+
+  boost::uniform_int<size_t> pick(0, alive.size() - 1);
+  p.assignment[var] = alive[pick(p.rng)];
+  double label = m_heuristic->getLabel(var, p.assignment, NULL);
+  probeAND(p, var, path OP_TIMES label, w * alive.size());
+  p.assignment[var] = UNKNOWN;
+}
+
+
+void KnuthEstimator::probeAND(Prober& p, int var, double path,
+                              double w) const {
+  p.weightAND[var] = w;
+  ++p.visited;
+  const vector<PseudotreeNode*>& children =
+      m_pseudotree->getNode(var)->getChildren();
+  if (children.empty())
+    return;
+
+  // bounds of all child subproblems first, each child's pruning depends
+  // on its siblings'
+  vector<vector<double> > f(children.size());
+  vector<double> h(children.size());
+  for (size_t j = 0; j < children.size(); ++j)
+    h[j] = bounds(p, children[j]->getVar(), f[j]);
+
+  for (size_t j = 0; j < children.size(); ++j) {
+    double rest = path;
+    for (size_t k = 0; k < children.size(); ++k) {
+      if (k != j)
+        rest OP_TIMESEQ h[k];
+    }
+    probeOR(p, children[j]->getVar(), f[j], rest, w);
+  }
+}
+
+
+double KnuthEstimator::dive(Prober& p, int var, const vector<double>& f) const {
+  int best = NONE;
+  for (size_t i = 0; i < f.size(); ++i) {
+    if (f[i] != ELEM_ZERO && (best == NONE || f[i] > f[best]))
+      best = i;
+  }
+  if (best == NONE)
+    return ELEM_ZERO;
+
+  p.assignment[var] = best;
+  double cost = m_heuristic->getLabel(var, p.assignment, NULL);
+  vector<double> fc;
+  for (PseudotreeNode* c : m_pseudotree->getNode(var)->getChildren()) {
+    bounds(p, c->getVar(), fc);
+    cost OP_TIMESEQ dive(p, c->getVar(), fc);
+    if (cost == ELEM_ZERO)
+      break;
+  }
+  p.assignment[var] = UNKNOWN;
+  return cost;
+}
+
+
+double KnuthEstimator::total(Prober& p) const {
+  double sum = 0;
+  for (int var : m_order) {
+    double w = p.weightOR[var];
+    if (w == 0)
+      continue;  // not reached by this probe
+    double c = w;
+    PseudotreeNode* parent = m_pseudotree->getNode(var)->getParent();
+    if (parent)
+      c = min(c, p.capAND[parent->getVar()]);
+    if (m_caching)
+      c = min(c, m_cap[var]);
+    p.capAND[var] = c * (p.weightAND[var] / w);
+    sum += c + p.capAND[var];
+    p.weightOR[var] = p.weightAND[var] = 0;
+  }
+  return sum;
+}
+
+
+void KnuthEstimator::runProbes(int seed, size_t i, size_t step,
+                               vector<double>* estimates,
+                               size_t* visited) const {
+  Prober p(seed, m_problem->getN(), m_pseudotree->getN());
+  int root = m_pseudotree->getRoot()->getVar();
+  vector<double> f;
+  bounds(p, root, f);
+  for (; i < estimates->size(); i += step) {
+    probeOR(p, root, f, ELEM_ONE, 1);
+    estimates->at(i) = total(p);
+  }
+  *visited = p.visited;
+}
+
+
+SearchEstimate KnuthEstimator::run(size_t probes, int threads) {
+  high_resolution_clock::time_point start = high_resolution_clock::now();
+  SearchEstimate res;
+  if (probes == 0)
+    return res;
+  threads = max(1, min(threads, (int) probes));
+
+  if (ISNAN(m_bound)) {
+    Prober p(0, m_problem->getN(), m_pseudotree->getN());
+    int root = m_pseudotree->getRoot()->getVar();
+    vector<double> f;
+    bounds(p, root, f);
+    double d = dive(p, root, f);
+    if (d != ELEM_ZERO)
+      m_bound = d;
+  }
+
+  // each thread writes its own entries
+  vector<double> estimates(probes, 0);
+  boost::minstd_rand rng(m_seed);
+  vector<int> seeds;
+  for (int t = 0; t < threads; ++t)
+    seeds.push_back(rng());
+  vector<size_t> visited(threads, 0);
+  if (threads == 1) {
+    runProbes(seeds[0], 0, 1, &estimates, &visited[0]);
+  } else {
+    vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+      workers.push_back(std::thread(&KnuthEstimator::runProbes, this,
+                                    seeds[t], (size_t) t, (size_t) threads,
+                                    &estimates, &visited[t]));
+    for (size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+  }
+
+  double sum = 0, sumSq = 0;
+  for (size_t i = 0; i < probes; ++i)
+    sum += estimates[i];
+  res.probes = probes;
+  for (int t = 0; t < threads; ++t)
+    res.visited += visited[t];
+  res.nodes = sum / probes;
+  for (size_t i = 0; i < probes; ++i)
+    sumSq += (estimates[i] - res.nodes) * (estimates[i] - res.nodes);
+  if (probes > 1)
+    res.stdErr = sqrt(sumSq / (probes - 1) / probes);
+  // (normal approximation; the tree has at least the root node)
+  res.lower = max(1.0, res.nodes - 1.96 * res.stdErr);
+  res.upper = res.nodes + 1.96 * res.stdErr;
+  res.msec = duration_cast<duration<double, std::milli> >(
+      high_resolution_clock::now() - start).count();
+  return res;
+}
+
+}  // namespace daoopt
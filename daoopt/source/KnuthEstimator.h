@@ -0,0 +1,132 @@
+/*
+ * KnuthEstimator.h
+ *
+ *  Estimates the size of the AOBB search space from random probes
+ *  (Knuth's estimator, applied to AND/OR search trees).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KNUTHESTIMATOR_H_
+#define KNUTHESTIMATOR_H_
+
+#include "_base.h"
+
+#include "Heuristic.h"
+#include "Problem.h"
+#include "Pseudotree.h"
+
+namespace daoopt {
+
+/* aggregated result of an estimation run (node counts are OR plus AND
+ * nodes expanded) */
+struct SearchEstimate {
+  size_t probes;  // number of probes
+  double nodes;   // estimated number of nodes (mean over the probes)
+  double stdErr;  // standard error of the mean
+  double lower;   // 95% confidence interval of the mean
+  double upper;
+  double msec;    // wall-clock time of the estimation
+  size_t visited; // nodes the probes themselves visited (over all threads)
+  SearchEstimate() : probes(0), nodes(0), stdErr(0), lower(0), upper(0),
+      msec(0), visited(0) {}
+};
+
+/*
+ * Each probe descends from the root of the AND/OR search tree: at an OR node
+ * it picks one of the AND children that survive pruning uniformly at random,
+ * at an AND node it follows all OR children (the independent subproblems of
+ * the pseudo tree). A node reached with weight w (the product of the numbers
+ * of surviving children along the way) stands for w nodes of the tree, so
+ * summing up the weights gives an unbiased estimate of the tree size. A probe
+ * costs about one heuristic query per value and variable.
+ *
+ * A child is pruned if the heuristic bound of the best solution through it
+ * (path cost, its own bound and the bounds of the open sibling subproblems
+ * above it) doesn't exceed the incumbent. Without one, the solution found by
+ * greedily following the heuristic is used. With caching, the estimated
+ * count of a variable's nodes is capped by the number of instantiations of
+ * its context if AOBB caches it (and by its parent's capped count).
+ *
+ * AOBB also prunes with improving incumbents and the exact values of solved
+ * siblings, so the estimate errs on the high side.
+ *
+ * The heuristic is queried without search nodes and from several threads
+ * at once, so it has to be thread-safe (see Heuristic::isThreadSafe()).
+ */
+class KnuthEstimator {
+
+ protected:
+  Problem* m_problem;
+  Pseudotree* m_pseudotree;
+  Heuristic* m_heuristic;
+  double m_bound;  // incumbent for pruning (ELEM_NAN for none)
+  bool m_caching;
+  int m_seed;      // seeds the probing threads' generators
+
+  vector<int> m_order;     // variables, parents before children
+  vector<double> m_cap;    // no. of cache entries per variable (inf if not cached)
+
+  /* state of one probing thread */
+  struct Prober {
+    boost::minstd_rand rng;
+    vector<val_t> assignment;
+    vector<double> weightOR;   // weights of the current probe's nodes
+    vector<double> weightAND;
+    vector<double> capAND;     // (scratch for total())
+    size_t visited;            // OR and AND nodes probed so far
+    Prober(int seed, int n, int vars) : rng(seed), assignment(n, UNKNOWN),
+        weightOR(vars, 0), weightAND(vars, 0), capAND(vars, 0), visited(0) {}
+  };
+
+ protected:
+  /* computes label times heuristic for each value of var into f,
+   * returns the maximum */
+  double bounds(Prober& p, int var, vector<double>& f) const;
+  /* the probe below the OR node for var, where f are its children's bounds,
+   * 'path' the bound contribution of the path and the open subproblems
+   * above, w the node's weight */
+  void probeOR(Prober& p, int var, const vector<double>& f, double path,
+               double w) const;
+  void probeAND(Prober& p, int var, double path, double w) const;
+  /* returns the cost of the greedy solution below the OR node for var
+   * (ELEM_ZERO if it runs into a dead end) */
+  double dive(Prober& p, int var, const vector<double>& f) const;
+  /* sums up the weights of the last probe, applying the cache caps, and
+   * clears them */
+  double total(Prober& p) const;
+  /* runs the probes i, i+step, ... and stores their estimates, adds the
+   * number of nodes visited to *visited */
+  void runProbes(int seed, size_t i, size_t step, vector<double>* estimates,
+                 size_t* visited) const;
+
+ public:
+  void setBound(double b) { m_bound = b; }
+  void setCaching(bool b) { m_caching = b; }
+  void setSeed(int s) { m_seed = s; }
+
+  /* runs the given number of probes, distributed over 'threads' threads
+   * (their generators are seeded from a local one, seeded with setSeed();
+   * results are reproducible for a given seed and thread count, and the
+   * global RNG is left alone) */
+  SearchEstimate run(size_t probes, int threads);
+
+  KnuthEstimator(Problem* p, Pseudotree* pt, Heuristic* h);
+};
+
+}  // namespace daoopt
+
+#endif /* KNUTHESTIMATOR_H_ */
@@ -86,7 +86,7 @@ bool LimitedDiscrepancy::doExpand(SearchNode* node) {
 #endif // DECOMPOSE_H_INTO_INDEPENDENT_SUBPROBLEMS
     for (val_t i=m_problem->getDomainSize(var)-1; i>=0; --i) {
       if (heur[2*i+1]!=ELEM_ZERO) // check precomputed label
-        pqueue.push(make_pair(heur[2*i],i));
+        pqueue.push(make_pair(heur[2*i + (m_labelOrder ? 1 : 0)],i));
       else {
         m_leafProfile.at(depth) += 1;
         m_space->stats.numDead += 1;
@@ -149,14 +149,17 @@ bool LimitedDiscrepancy::doCompleteProcessing(SearchNode* n) {
 bool LimitedDiscrepancy::solve(size_t nodeLimit) {
   SearchNode* n = this->nextLeaf();
   while(n) {
-    m_prop->propagate(n, current_domains_, true); // true = report solution
+    m_prop->propagate(n, true); // true = report solution
+    if (isAborted())
+      return false;
     n = this->nextLeaf();
   }
-  return !n ? true : false;
+  return !n && !m_timedOut;
 }
 
 LimitedDiscrepancy::LimitedDiscrepancy(Problem* prob, Pseudotree* pt, SearchSpace* space, Heuristic* heur, BoundPropagator* prop, ProgramOptions *po, size_t disc)
-  : Search(prob,pt,space,heur,prop,po), m_maxDisc(disc)
+  : Search(prob,pt,space,heur,prop,po), m_maxDisc(disc), m_discCache(0),
+    m_labelOrder(false)
 {
 
   SearchNode* first = this->initSearch();
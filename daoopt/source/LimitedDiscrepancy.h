@@ -38,6 +38,7 @@ class LimitedDiscrepancy : virtual public Search {
 protected:
   size_t m_maxDisc; // max. discrepancy
   size_t m_discCache; // caches the discrepancy of the last "next node"
+  bool m_labelOrder; // order values by label instead of heuristic estimate
 
   /* the stack of nodes, each with its discrepancy value */
   stack<pair<SearchNode*,size_t> > m_stack;
@@ -51,7 +52,12 @@ protected:
 
 public:
   void reset(SearchNode*);
+  /* runs until done or aborted (see setAbortFlag()), returns false
+   * in the latter case */
   bool solve(size_t nodeLimit);
+  /* the heuristic preference is by label, i.e. greedy w.r.t. the functions
+   * fully instantiated at the child, rather than by heuristic estimate */
+  void setLabelOrder(bool b) { m_labelOrder = b; }
   LimitedDiscrepancy(Problem* prob, Pseudotree* pt, SearchSpace* space,
       Heuristic* heur, BoundPropagator* prop, ProgramOptions *po, size_t disc);
   virtual ~LimitedDiscrepancy() {}
@@ -21,28 +21,88 @@
  *      Author: Lars Otten <lotten@ics.uci.edu>
  */
 
+// before any SLS header, which #defines WIN32
+#include <boost/asio.hpp>
+
 #include "Main.h"
 #include "DaooptInterface.h"
 #include "MiniBucketElim.h"
+#include "MiniBucketElimARP.h"
 #include "MiniBucketElimLH.h"
 #include "MiniBucketElimInc.h"
+#include "Portfolio.h"
 
 #include "UAI2012.h"
 
 #include "ARP/ARPall.hxx"
 
+#include <cerrno>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#include <boost/algorithm/string.hpp>
+#include <unistd.h>
 using namespace std::chrono;
 
 #define VERSIONINFO "1.1.2"
 
 namespace daoopt {
 
+/* unbuffered output to a file descriptor (the query answers on stdout) */
+class FdOutBuf : public std::streambuf {
+  int m_fd;
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    std::streamsize done = 0;
+    while (done < n) {
+      ssize_t w = ::write(m_fd, s + done, n - done);
+      if (w < 0 && errno == EINTR)
+        continue;
+      if (w <= 0)
+        break;
+      done += w;
+    }
+    return done;
+  }
+  int overflow(int c) override {
+    if (c == traits_type::eof())
+      return traits_type::not_eof(c);
+    char ch = c;
+    return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+  }
+ public:
+  explicit FdOutBuf(int fd) : m_fd(fd) {}
+};
+
 string UAI2012::filename = "";
 string out_bound_file = "";
 
 high_resolution_clock::time_point _time_start, _time_pre;
 
+/* weights of anytime weighted search this close to 1 end the schedule */
+#define WEIGHT_EPS 0.01
+
+/* parses a weight schedule for anytime weighted search (sqrt, sub:<step> or
+ * div:<factor>), returns false if invalid */
+static bool parseWeightSchedule(const string& spec, string* kind,
+                                double* step) {
+  size_t i = spec.find(':');
+  *kind = spec.substr(0, i);
+  *step = 0;
+  if (*kind == "sqrt")
+    return i == string::npos;
+  if (i == string::npos)
+    return false;
+  *step = atof(spec.c_str() + i + 1);
+  if (*kind == "sub")
+    return *step > 0;
+  if (*kind == "div")
+    return *step > 1;
+  return false;
+}
+
 bool Main::parseOptions(int argc, char** argv) {
   // Reprint command line
   for (int i = 0; i < argc; ++i) cout << argv[i] << ' ';
@@ -58,6 +118,7 @@ bool Main::parseOptions(int argc, char** argv) {
   rand::seed(opt->seed);
 
   m_options.reset(opt);
+  m_weight = m_options->weight;
 
   size_t idx = m_options->in_problemFile.find_last_of("/");
   UAI2012::filename = m_options->in_problemFile.substr(idx + 1) + ".MPE";
@@ -75,6 +136,67 @@ bool Main::setOptions(const ProgramOptions& options) {
 
   m_options.reset(opt);
   out_bound_file = m_options->out_boundFile;
+  // (assignments are only recorded if tracked)
+  if (opt->eventAssignment)
+    opt->trackAssignment = true;
+
+  if (!isValidTask(opt->task)) {
+    err_txt("Unknown task " + opt->task + ", expected mpe or pr.");
+    return false;
+  }
+  if (opt->task == TASK_PR) {
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
+    err_txt("Task pr is not supported in parallel builds.");
+    return false;
+#endif
+    if (opt->algorithm != "aobb") {
+      err_txt("Task pr requires algorithm aobb.");
+      return false;
+    }
+    // solutions found by LDS/SLS, external bounds and the portfolio's shared
+    // incumbent are (bounds on) the MPE value, not the sum
+    opt->lds = NONE;
+    opt->slsIter = 0;
+    opt->initialBound = ELEM_NAN;
+    opt->in_boundFile.clear();
+    opt->portfolio.clear();
+    // (and there is no optimal assignment to a sum)
+    opt->trackAssignment = false;
+  }
+  if (opt->weight > 1.0) {
+    string kind;
+    double step;
+    if (!parseWeightSchedule(opt->weightSchedule, &kind, &step)) {
+      err_txt("Invalid weight schedule " + opt->weightSchedule + ".");
+      return false;
+    }
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
+    err_txt("Weighted search is not supported in parallel builds.");
+    return false;
+#endif
+    if (opt->task == TASK_PR ||
+        (opt->algorithm != "aobb" && opt->algorithm != "aobf")) {
+      err_txt("Weighted search requires task mpe and algorithm aobb or aobf.");
+      return false;
+    }
+    if (!opt->portfolio.empty() || !opt->in_subproblemFile.empty()) {
+      err_txt("Weighted search is not supported with portfolios or subproblems.");
+      return false;
+    }
+  } else if (opt->weight != 1.0) {
+    err_txt("The search weight must be at least 1.");
+    return false;
+  }
+  m_weight = opt->weight;
+
+  m_schedule.reset();
+  if (opt->schedule) {
+    if (opt->maxTime == kint32max) {
+      err_txt("Scheduling requires a time limit (-max_time).");
+      return false;
+    }
+    m_schedule.reset(new Scheduler(opt->maxTime, opt->memlimit));
+  }
 
   return true;
 }
@@ -104,11 +226,25 @@ bool Main::setIboundOptions(int ibound) {
 
 bool Main::loadProblem() {
   m_problem.reset(new Problem);
+  m_problem->setTrackAssignment(m_options->trackAssignment);
+  if (!m_options->eventFeed.empty()) {
+    m_eventFeed.reset(new EventFeed);
+    if (!m_eventFeed->open(m_options->eventFeed, m_options->eventFormat,
+                           m_options->eventAssignment)) {
+      err_txt("Opening the event feed failed.");
+      return false;
+    }
+    m_problem->setEventFeed(m_eventFeed.get());
+  }
 
   // load problem file
   assert(m_options->in_problemFile != "" || m_options->problemSpec);
   string evid_string;
-  if (!m_options->evidSpec) {
+  if (!m_options->evidSpec && !m_options->in_evidenceFile.empty()) {
+    evid_string = getFileContents(m_options->in_evidenceFile.c_str());
+    m_options->evidSpec = &evid_string[0];
+    m_options->evidSpec_len = evid_string.size();
+  } else if (!m_options->evidSpec) {
     evid_string = "0\n";
     m_options->evidSpec = &evid_string[0];
     m_options->evidSpec_len = evid_string.size();
@@ -217,6 +353,8 @@ bool Main::findOrLoadOrdering() {
     cout << "Read elimination ordering from file " << m_options->in_orderingFile
          << " (" << w << '/' << m_pseudotree->getHeight() << ")." << endl;
   } else {
+    if (m_schedule)
+      m_schedule->planOrdering(m_options.get());
     if (m_options->order_timelimit == NONE)
       // compute at least one
       m_options->order_iterations = max(1, m_options->order_iterations);
@@ -226,36 +364,11 @@ bool Main::findOrLoadOrdering() {
   double timediff = 0.0;
   time_order_start = high_resolution_clock::now();
 
-  unique_ptr<ARE::Graph> cvo_graph;
-  unique_ptr<ARE::Graph> cvo_master_graph;
-  int temp_adj_var_space_exists = 0;
-  ARE::AdjVar** temp_adj_var_space_size_extra_array = nullptr;
-
-  if (m_options->order_cvo) {
-    vector< const vector<int>*> fn_signatures;
-    for (Function* f : m_problem->getFunctions()) {
-      fn_signatures.push_back(&f->getScopeVec());
-    }
-
-    cvo_master_graph.reset(new ARE::Graph());
-    cvo_master_graph->Create(m_problem->getN(), fn_signatures);
-    cvo_master_graph->RNG().seed(m_options->seed);
-    if (!cvo_master_graph->_IsValid) {
-      return false;
-    }
-    temp_adj_var_space_size_extra_array = new ARE::AdjVar*[1000];
-
-    cvo_master_graph->ComputeVariableEliminationOrder_Simple(0, INT_MAX, false,
-        DBL_MAX, false, true, 1, 1, 0.0, temp_adj_var_space_exists,
-        temp_adj_var_space_size_extra_array);
-    cvo_master_graph->ReAllocateEdges();
-    
-  }
   // Search for variable elimination ordering, looking for min. induced
   // width, breaking ties via pseudo tree height
   cout << "Searching for elimination ordering,";
   if (m_options->order_cvo) {
-    cout << " CVO,";
+    cout << " CVO, " << max(1, m_options->threads) << " threads,";
   }
 
   if (m_options->order_iterations != NONE)
@@ -266,37 +379,74 @@ bool Main::findOrLoadOrdering() {
 
   int iterCount = 0, sinceLast = 0;
   int remaining = m_options->order_iterations;
+  double lastImproved = 0.0;  // time of the last improvement
+
+  if (m_options->order_cvo) {
+    // CVO's control thread eliminates the easy variables once, then its
+    // worker threads run randomized min-fill from there; ties on width are
+    // broken by elimination tree height (= pseudo tree height) within CVO.
+    ARE::VarElimOrderComp::Order cvo_order;
+    // (heap allocated, the graphs within are large)
+    unique_ptr<ARE::VarElimOrderComp::CVOcontext> cvo_ptr(
+        new ARE::VarElimOrderComp::CVOcontext);
+    ARE::VarElimOrderComp::CVOcontext& cvo = *cvo_ptr;
+    vector<const vector<int>*> fn_signatures;
+    for (Function* f : m_problem->getFunctions()) {
+      fn_signatures.push_back(&f->getScopeVec());
+    }
+    cvo._OriginalGraph.Create(m_problem->getN(), fn_signatures);
+    if (!cvo._OriginalGraph._IsValid) {
+      return false;
+    }
+    cvo._BestOrder = &cvo_order;
+    cvo._ObjCode = ARE::VarElimOrderComp::Width;
+    cvo._SecondaryObjCode = ARE::VarElimOrderComp::BTheight;
+    cvo._AlgCode = ARE::VarElimOrderComp::MinFill;
+    cvo._nThreads = max(1, m_options->threads);
+    cvo._nRunsToDoMax = (m_options->order_iterations != NONE)
+        ? max(1, m_options->order_iterations) : INT_MAX;
+    cvo._TimeLimitInMilliSeconds = (m_options->order_timelimit != NONE)
+        ? 1000 * (int64_t) m_options->order_timelimit : 0;
+    cvo._nRandomPick = (m_options->cvo_n_random_pick > 0)
+        ? m_options->cvo_n_random_pick : 1;
+    cvo._eRandomPick = m_options->cvo_e_random_pick;
+    cvo._FindPracticalVariableOrder = false;
+    cvo._PrintStatus = false;
+    // seed based on daoopt's RNG; this keeps orderings deterministic subject
+    // to daoopt's seed (for a single thread; worker streams are seeded
+    // deterministically, but their interleaving is not).
+    cvo._RandomGeneratorSeed = rand::next();
+    if (cvo.Run() != 0 || cvo._nImprovements == 0) {
+      cout << " WARNING! (errorcode: " << cvo._ret << ")" << flush;
+    } else {
+      for (int i = 0; i < cvo._nImprovements; ++i) {
+        const ARE::VarElimOrderComp::ResultSnapShot& r = cvo._Improvements[i];
+        cout << " " << r._dt << "ms:" << r._width << '/' << r._height;
+      }
+      vector<int> elimCand(cvo_order._VarListInElimOrder,
+                           cvo_order._VarListInElimOrder + cvo_order._nVars);
+      // compare against an ordering from file or options, if any
+      Pseudotree ptCand(m_problem.get(), m_options->subprobOrder);
+      ptCand.build(g, elimCand, m_options->cbound);
+      if (ptCand.getWidth() < w ||
+          (ptCand.getWidth() == w &&
+           ptCand.getHeight() < m_pseudotree->getHeight())) {
+        elim = elimCand;
+        w = ptCand.getWidth();
+        m_pseudotree->build(g, elim, m_options->cbound);
+      }
+    }
+    iterCount = cvo._nRunsStarted;
+  }
 
-  while (true) {
+  while (!m_options->order_cvo) {
 
     if (m_options->order_iterations != NONE && remaining == 0) break;
 
     vector<int> elimCand;   // new ordering candidate
     bool improved = false;  // improved in this iteration?
-    int new_w;
-    if (m_options->order_cvo) {
-      cvo_graph.reset(new ARE::Graph());
-      *cvo_graph = *cvo_master_graph;
-      // seed based on daoopt's RNG; this lets us have deterministic iterations
-      // subject to daoopt's seed.
-      cvo_graph->RNG().seed(rand::next());
-      int width_limit = INT_MAX;
-      double space_limit = DBL_MAX;
-      new_w = cvo_graph->ComputeVariableEliminationOrder_Simple(
-          0, width_limit, false, space_limit, false, false, 10, 1, 0.0,
-          temp_adj_var_space_exists, temp_adj_var_space_size_extra_array);
-      if (new_w != 0) {
-        cout << "WARNING! (errorcode: " << new_w << ")" << endl;
-        new_w = INT_MAX;
-      } else {
-        new_w = cvo_graph->_VarElimOrderWidth;
-        elimCand.assign(cvo_graph->_VarElimOrder,
-                        cvo_graph->_VarElimOrder + cvo_graph->_nNodes);
-      }
-    } else {
-      new_w =
-          m_pseudotree->eliminate(g, elimCand, w, m_options->order_tolerance);
-    }
+    int new_w =
+        m_pseudotree->eliminate(g, elimCand, w, m_options->order_tolerance);
     if (new_w < w) {
       elim = elimCand;
       w = new_w;
@@ -330,11 +480,11 @@ bool Main::findOrLoadOrdering() {
     if (m_options->order_timelimit != NONE &&
         timediff > m_options->order_timelimit)
       break;
-  }
-  if (temp_adj_var_space_size_extra_array) {
-    for (int i = temp_adj_var_space_exists - 1; i >= 0; --i) {
-      delete[] temp_adj_var_space_size_extra_array[i];
-    }
+    if (improved)
+      lastImproved = timediff;
+    if (m_schedule &&
+        m_schedule->stopOrdering(iterCount, timediff, lastImproved))
+      break;
   }
   time_order_cur = high_resolution_clock::now();
   timediff = duration_cast<duration<double>>(time_order_cur - time_order_start)
@@ -415,26 +565,66 @@ bool Main::runSLS() {
   if (!m_options->in_subproblemFile.empty())
     return true;  // no SLS in case of subproblem processing
   if (m_options->slsIter <= 0) return true;
+
+  // finish any earlier (background) runs first
+  for (auto& sls : m_slsWrappers)
+    sls->stop();
+  joinSLS();
+  m_slsWrappers.clear();
+
+  if (m_schedule)
+    m_schedule->planSLS(m_options.get());
+
+  int threads = max(1, m_options->slsThreads);
+  vector<int> algos;
+  if (!m_options->slsAlgos.empty()) {
+    istringstream iss(m_options->slsAlgos);
+    int a;
+    while (iss >> a) {
+      algos.push_back(a);
+      iss.ignore(1);
+    }
+  }
+
   oss ss;
   ss << "Running SLS " << m_options->slsIter << " times for "
-     << m_options->slsTime << " seconds" << endl;
+     << m_options->slsTime << " seconds";
+  if (threads > 1)
+    ss << " (" << threads << " concurrent runs)";
+  if (m_options->slsBackground)
+    ss << " in background";
+  ss << endl;
   myprint(ss.str());
 
-  switch (m_options->slsAlgo) {
-    case 1:
-      m_slsWrapper.reset(new SLSWrapper());
-      break;
-    case 2:
-      m_slsWrapper.reset(new SLSWrapperHybrid());
-      break;
-    default:
-      m_slsWrapper.reset(new SLSWrapperInc(m_options->slsConvergeRate));
-      break;
+  for (int i = 0; i < threads; ++i) {
+    int algo = algos.empty() ? m_options->slsAlgo : algos[i % algos.size()];
+    SLSWrapper* sls = NULL;
+    switch (algo) {
+      case 1:
+        sls = new SLSWrapper();
+        break;
+      case 2:
+        sls = new SLSWrapperHybrid();
+        break;
+      default:
+        sls = new SLSWrapperInc(m_options->slsConvergeRate);
+        break;
+    }
+    // first run keeps sls4mpe's default seed, others draw from our RNG
+    long seed = (i == 0) ? 1 : 1 + rand::next();
+    sls->init(m_problem.get(), m_options->slsIter, m_options->slsTime, seed);
+    m_slsWrappers.push_back(std::unique_ptr<SLSWrapper>(sls));
   }
-  // m_slsWrapper.reset(new SLSWrapper());
 
-  m_slsWrapper->init(m_problem.get(), m_options->slsIter, m_options->slsTime);
-  m_slsWrapper->run();
+  if (threads == 1 && !m_options->slsBackground) {
+    m_slsWrappers[0]->run();
+  } else {
+    for (auto& sls : m_slsWrappers)
+      sls->start();
+    if (m_options->slsBackground)
+      return true;  // stopped and joined after search, cf. joinSLS()
+    joinSLS();
+  }
   myprint("SLS finished.\n");
 #endif
   return true;
@@ -445,6 +635,41 @@ bool Main::stopSLS() {
   return true;
 }
 
+void Main::joinSLS() {
+#ifdef ENABLE_SLS
+  for (auto& sls : m_slsWrappers)
+    sls->join();
+#endif
+}
+
+void Main::onTimeout() {
+#ifdef ENABLE_SLS
+  // background SLS would otherwise still be running while the process exits
+  stopSLS();
+  for (auto& sls : m_slsWrappers)
+    sls->stop();
+  joinSLS();
+#endif
+  finishEventFeed(false);
+}
+
+void Main::finishEventFeed(bool solved) const {
+  if (!m_eventFeed)
+    return;
+  // (a solved problem's bound is its solution cost)
+  double lower = SCALE_LOG(m_problem->getSolutionCost());
+  double upper = solved ? lower : SCALE_LOG(m_problem->getUpperBound());
+  m_eventFeed->finish(lower, upper, m_space ? &m_space->stats : NULL, solved);
+}
+
+bool Main::hasBackgroundSLS() const {
+#ifdef ENABLE_SLS
+  return m_options->slsBackground && !m_slsWrappers.empty();
+#else
+  return false;
+#endif
+}
+
 Heuristic* Main::newHeuristic(Problem* p, Pseudotree* pt, ProgramOptions* po) {
 #ifdef NO_HEURISTIC
   return new Unheuristic;
@@ -496,6 +721,8 @@ Heuristic* Main::newHeuristic(Problem* p, Pseudotree* pt, ProgramOptions* po) {
       po->aobf_subordering == "sampled_st_be") {
     return new MiniBucketElimLH(p, pt, po, po->ibound);
   }
+  if (po->arpMBEHeur)
+    return new MiniBucketElimARP(p, pt, po, po->ibound);
   if (po->incrementalJG)  // default value of the incrementalJG is false
     return new MiniBucketElimInc(p, pt, po, po->ibound);
   else
@@ -503,28 +730,26 @@ Heuristic* Main::newHeuristic(Problem* p, Pseudotree* pt, ProgramOptions* po) {
 #endif
 }
 
-bool Main::initDataStructs() {
+bool Main::initSearch(bool reuseSpace, bool keepCache) {
 
 // The main search space
 #ifdef PARALLEL_DYNAMIC
   m_space.reset(new SearchSpaceMaster(m_pseudotree.get(), m_options.get()));
 #else
-  if (m_options->algorithm == "aobb") {
+  if (reuseSpace && m_space && m_options->algorithm == "aobb") {
+    m_space->reset(keepCache);
+  } else if (m_options->algorithm == "aobb") {
     m_space.reset(new SearchSpace(m_pseudotree.get(), m_options.get()));
   } else if (m_options->algorithm == "aobf" ||
       m_options->algorithm == "aaobf") {
     m_space.reset(new BFSearchSpace(m_pseudotree.get(), m_options.get(),
                                     m_problem->getN()));
   }
+#endif
   m_space->stats.numORVar.resize(m_pseudotree->getN(), 0);
   m_space->stats.numANDVar.resize(m_pseudotree->getN(), 0);
   m_space->stats.numProcORVar.resize(m_pseudotree->getN(), 0);
   m_space->stats.numProcANDVar.resize(m_pseudotree->getN(), 0);
-#endif
-
-  // Heuristic is initialized here, built later in compileHeuristic()
-  m_heuristic.reset(
-      newHeuristic(m_problem.get(), m_pseudotree.get(), m_options.get()));
 
   m_prop.reset(new BoundPropagator(m_problem.get(), m_space.get(),
                                    !m_options->nocaching));
@@ -532,8 +757,8 @@ bool Main::initDataStructs() {
 // Main search engine
 #if defined PARALLEL_DYNAMIC
   m_search.reset(new BranchAndBoundMaster(m_problem.get(), m_pseudotree.get(),
-                                          m_space.get(),
-                                          m_heuristic.get()));  // TODO
+                                          m_space.get(), m_heuristic.get(),
+                                          m_prop.get(), m_options.get()));
 #elif defined PARALLEL_STATIC
   m_search.reset(new ParallelManager(m_problem.get(), m_pseudotree.get(),
                                      m_space.get(), m_heuristic.get()));
@@ -561,6 +786,22 @@ bool Main::initDataStructs() {
     return false;
   }
 #endif
+  m_search->setWeight(m_weight);
+  m_search->setTimeoutHandler([this]() { this->onTimeout(); });
+  if (m_serving)
+    m_search->setTimeLimit(m_queryStart, false);
+
+  return true;
+}
+
+bool Main::initDataStructs() {
+
+  // Heuristic is initialized here, built later in compileHeuristic()
+  m_heuristic.reset(
+      newHeuristic(m_problem.get(), m_pseudotree.get(), m_options.get()));
+
+  if (!initSearch())
+    return false;
 
   // Subproblem specified? If yes, restrict.
   if (!m_options->in_subproblemFile.empty()) {
@@ -676,19 +917,20 @@ bool Main::compileHeuristicAfterBuild() {
         return false;
       }
     } else if (!ISNAN(m_options->initialBound)) {
-#ifdef NO_ASSIGNMENT
+      if (m_options->trackAssignment) {
+        err_txt("Assignments are tracked, value-based bound not possible.");
+        return false;
+      }
       cout << "Setting external lower bound " << m_options->initialBound
            << endl;
       m_search->updateSolution(m_options->initialBound);
-#else
-      err_txt("Compiled with tuple support, value-based bound not possible.");
-      return false;
-#endif
     }
   }
 
 #ifndef NO_HEURISTIC
-  if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
+  if (m_options->task == TASK_PR) {
+    // the search sums over the whole space, regardless of the heuristic
+  } else if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
     m_solved = true;
     cout << endl << "--------- Solved during preprocessing ---------" << endl;
   } else if (m_heuristic->isAccurate()) {
@@ -762,8 +1004,54 @@ bool Main::compileHeuristic(int task) {
 bool Main::compileHeuristic() {
   m_options->ibound = min(m_options->ibound, m_pseudotree->getWidthCond());
   m_options->jglpi = min(m_options->jglpi, m_pseudotree->getWidthCond());
+  bool selected = false;  // heuristic already built by the i-bound selection?
+  if (m_schedule && !m_options->nosearch) {
+    m_schedule->planReparameterization(m_options.get());
+    MiniBucketElim* mbe = dynamic_cast<MiniBucketElim*>(m_heuristic.get());
+    if (mbe && m_options->in_minibucketFile.empty()) {
+      // time the configured heuristic itself, unless its build would run
+      // the reparameterization (which rewrites the functions) every trial
+      bool inPlace = m_options->mplp <= 0 && m_options->mplps <= 0 &&
+          m_options->jglp <= 0 && m_options->jglps <= 0;
+      ProgramOptions trialOpts(*m_options);
+      std::unique_ptr<Heuristic> trialHeur;
+      MiniBucketElim* trial = mbe;
+      if (!inPlace) {
+        trialOpts.mplp = trialOpts.jglp = 0;
+        trialOpts.mplps = trialOpts.jglps = 0;
+        trialHeur.reset(newHeuristic(m_problem.get(), m_pseudotree.get(),
+                                     &trialOpts));
+        trial = dynamic_cast<MiniBucketElim*>(trialHeur.get());
+        if (!trial) {
+          trialHeur.reset(new MiniBucketElim(m_problem.get(),
+                                             m_pseudotree.get(), &trialOpts,
+                                             1));
+          trial = static_cast<MiniBucketElim*>(trialHeur.get());
+        }
+      }
+      bool built = false;
+      int ibound = m_schedule->chooseIbound(
+          m_problem.get(), m_pseudotree.get(), trialOpts, trial,
+          &m_search->getAssignment(), m_options->ibound, &built);
+      if (ibound != m_options->ibound)
+        cout << "Schedule lowered the i-bound from " << m_options->ibound
+             << " to " << ibound << endl;
+      m_options->ibound = ibound;
+      mbe->setIbound(ibound);
+      selected = inPlace && built && m_options->iboundSelect <= 0;
+    }
+  }
+  if (m_options->iboundSelect > 0 && !m_options->nosearch) {
+    MiniBucketElim* mbe = dynamic_cast<MiniBucketElim*>(m_heuristic.get());
+    if (mbe && m_options->in_minibucketFile.empty()) {
+      // (with -schedule, within the i-bound its build time allows)
+      int maxIbound =
+          m_schedule ? m_options->ibound : m_pseudotree->getWidthCond();
+      selected = selectIbound(mbe, maxIbound);
+    }
+  }
   size_t sz = 0;
-  if (m_options->memlimit != NONE) {
+  if (m_options->memlimit != NONE && !selected) {
     sz =
         m_heuristic->limitSize(m_options->memlimit, &m_search->getAssignment());
     sz *= sizeof(double) / (1024 * 1024.0);
@@ -775,6 +1063,11 @@ bool Main::compileHeuristic() {
     cout << "Simulating mini bucket heuristic..." << endl;
     sz = m_heuristic->build(&m_search->getAssignment(),
                             false);  // false = just compute memory estimate
+  } else if (selected) {
+    cout << "Using mini bucket heuristic from "
+         << (m_options->iboundSelect > 0 ? "i-bound selection" : "schedule")
+         << endl;
+    sz = m_heuristic->getSize();
   } else {
     _time_pre = high_resolution_clock::now();
     bool mbFromFile = false;
@@ -816,19 +1109,20 @@ bool Main::compileHeuristic() {
         return false;
       }
     } else if (!ISNAN(m_options->initialBound)) {
-#ifdef NO_ASSIGNMENT
+      if (m_options->trackAssignment) {
+        err_txt("Assignments are tracked, value-based bound not possible.");
+        return false;
+      }
       cout << "Setting external lower bound " << m_options->initialBound
            << endl;
       m_search->updateSolution(m_options->initialBound);
-#else
-      err_txt("Compiled with tuple support, value-based bound not possible.");
-      return false;
-#endif
     }
   }
 
 #ifndef NO_HEURISTIC
-  if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
+  if (m_options->task == TASK_PR) {
+    // the search sums over the whole space, regardless of the heuristic
+  } else if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
     m_solved = true;
     cout << endl << "--------- Solved during preprocessing ---------" << endl;
   } else if (m_heuristic->isAccurate()) {
@@ -846,74 +1140,173 @@ bool Main::runLDS() {
   if (m_options->par_postOnly) return true;  // skip LDS for static post mode
 #endif
   // Run LDS if specified
-  if (m_options->lds != NONE) {
-    cout << "Running LDS with limit " << m_options->lds << endl;
-    scoped_ptr<SearchSpace> spaceLDS(
-        new SearchSpace(m_pseudotree.get(), m_options.get()));
-    spaceLDS->stats.numORVar.resize(m_pseudotree->getN());
-    spaceLDS->stats.numANDVar.resize(m_pseudotree->getN());
-    spaceLDS->stats.numProcORVar.resize(m_pseudotree->getN(), 0);
-    spaceLDS->stats.numProcANDVar.resize(m_pseudotree->getN(), 0);
-    unique_ptr<BoundPropagator> propLDS(new BoundPropagator(
-        m_problem.get(), spaceLDS.get(), false));  // doCaching = false
-    LimitedDiscrepancy lds(m_problem.get(), m_pseudotree.get(), spaceLDS.get(),
-                           m_heuristic.get(), propLDS.get(), m_options.get(),
-                           m_options->lds);
-    if (!m_options->in_subproblemFile.empty()) {
-      if (!lds.restrictSubproblem(m_options->in_subproblemFile)) {
-        err_txt("Subproblem restriction for LDS failed.");
-        return false;
-      }
+  if (m_options->lds == NONE)
+    return true;
+
+  if (m_schedule)
+    m_schedule->planLDS(m_options.get());
+
+  int threads = max(1, m_options->ldsThreads);
+  if (threads > 1 && !m_heuristic->isThreadSafe()) {
+    cout << "LDS: heuristic doesn't support concurrent probes, using one."
+         << endl;
+    threads = 1;
+  }
+
+  // probes as (discrepancy limit, order by label); a single one is the plain
+  // LDS, concurrent ones go through all limits up to the given one in both
+  // value orders, cheapest first, so that their early incumbents help prune
+  // the more expensive probes
+  vector<pair<int,bool> > probes;
+  if (threads == 1) {
+    probes.push_back(make_pair(m_options->lds, false));
+  } else {
+    for (int d = 0; d <= m_options->lds; ++d) {
+      probes.push_back(make_pair(d, false));
+      probes.push_back(make_pair(d, true));
     }
+    threads = min(threads, (int) probes.size());
+  }
+
+  oss ss;
+  ss << "Running LDS with limit " << m_options->lds;
+  if (threads > 1)
+    ss << " (" << probes.size() << " probes, " << threads
+       << " concurrent)";
+  if (m_options->ldsTime != NONE)
+    ss << " for at most " << m_options->ldsTime << " seconds";
+  ss << endl;
+  myprint(ss.str());
 
-    // load current best solution into LDS
-    if (lds.updateSolution(m_problem->getSolutionCost()
-#ifndef NO_ASSIGNMENT
-                           ,
-                           m_problem->getSolutionAssg()
+  std::atomic<bool> stop(false);
+  std::atomic<bool> ok(true);
+  std::atomic<size_t> nextProbe(0);
+  std::mutex mtx;
+  std::condition_variable cond;
+  int running = threads;
+
+  auto worker = [&]() {
+    size_t i;
+    while (!stop && (i = nextProbe++) < probes.size()) {
+      oss tag;
+      if (threads == 1)
+        tag << "LDS";
+      else
+        tag << "LDS probe " << probes[i].first
+            << (probes[i].second ? "/label" : "/heur");
+      if (!runLDSProbe(probes[i].first, probes[i].second, threads > 1,
+                       &stop, tag.str())) {
+        ok = false;
+        stop = true;
+      }
+#ifndef NO_HEURISTIC
+      // no need to go on once the incumbent is provably optimal
+      if (m_problem->getSolutionSnapshot() >= m_heuristic->getGlobalUB())
+        stop = true;
 #endif
-                           ))
-      cout << "LDS: Initial solution loaded." << endl;
+    }
+    std::lock_guard<std::mutex> lk(mtx);
+    --running;
+    cond.notify_all();
+  };
 
-    lds.finalizeHeuristic();
-    /*
-    SearchNode* n = lds.nextLeaf();
-    while (n) {
-      propLDS.propagate(n,true); // true = report solution
-      n = lds.nextLeaf();
+  if (threads == 1 && m_options->ldsTime == NONE) {
+    worker();
+  } else {
+    vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+      workers.push_back(std::thread(worker));
+    {
+      std::unique_lock<std::mutex> lk(mtx);
+      if (m_options->ldsTime == NONE)
+        cond.wait(lk, [&]() { return running == 0; });
+      else if (!cond.wait_for(lk, seconds(m_options->ldsTime),
+                              [&]() { return running == 0; }))
+        myprint("LDS: time budget exhausted.\n");
     }
-    */
-    lds.solve(0);
-    cout << "LDS: explored " << spaceLDS->stats.numExpOR << '/'
-         << spaceLDS->stats.numExpAND << " OR/AND nodes" << endl;
-    cout << "LDS: solution cost " << lds.getCurOptValue() << endl;
+    stop = true;
+    for (auto& w : workers)
+      w.join();
+  }
+  if (!ok)
+    return false;
+  if (threads > 1)
+    cout << "LDS: solution cost " << m_problem->getSolutionSnapshot() << endl;
 
 #ifndef NO_HEURISTIC
-    if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
-      m_solved = true;
-      cout << endl << "--------- Solved by LDS ---------" << endl;
-    }
-#endif
+  if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
+    m_solved = true;
+    cout << endl << "--------- Solved by LDS ---------" << endl;
   }
+#endif
 
   return true;
 }
 
+bool Main::runLDSProbe(int limit, bool byLabel, bool shared,
+                       const std::atomic<bool>* abort, const string& tag) {
+  scoped_ptr<SearchSpace> spaceLDS(
+      new SearchSpace(m_pseudotree.get(), m_options.get()));
+  spaceLDS->stats.numORVar.resize(m_pseudotree->getN());
+  spaceLDS->stats.numANDVar.resize(m_pseudotree->getN());
+  spaceLDS->stats.numProcORVar.resize(m_pseudotree->getN(), 0);
+  spaceLDS->stats.numProcANDVar.resize(m_pseudotree->getN(), 0);
+  unique_ptr<BoundPropagator> propLDS(new BoundPropagator(
+      m_problem.get(), spaceLDS.get(), false));  // doCaching = false
+  LimitedDiscrepancy lds(m_problem.get(), m_pseudotree.get(), spaceLDS.get(),
+                         m_heuristic.get(), propLDS.get(), m_options.get(),
+                         limit);
+  if (!m_options->in_subproblemFile.empty()) {
+    if (!lds.restrictSubproblem(m_options->in_subproblemFile)) {
+      err_txt("Subproblem restriction for LDS failed.");
+      return false;
+    }
+  }
+  lds.setLabelOrder(byLabel);
+  lds.setAbortFlag(abort);
+  lds.setTimeoutHandler([this]() { this->onTimeout(); });
+  if (m_serving)
+    lds.setTimeLimit(m_queryStart, false);
+  lds.setSolutionSync(shared);
+
+  // load current best solution into LDS
+  if (lds.importSolution() && !shared)
+    cout << tag << ": Initial solution loaded." << endl;
+
+  lds.finalizeHeuristic();
+  bool done = lds.solve(0);
+  oss ss;
+  ss << tag << ": explored " << spaceLDS->stats.numExpOR << '/'
+     << spaceLDS->stats.numExpAND << " OR/AND nodes" << (done ? "" : ", stopped")
+     << endl;
+  ss << tag << ": solution cost " << lds.getCurOptValue() << endl;
+  myprint(ss.str());
+  return true;
+}
+
 bool Main::finishPreproc() {
 
   // load current best solution from preprocessing into search instance
-  if (m_search->updateSolution(m_problem->getSolutionCost()
-#ifndef NO_ASSIGNMENT
-                               ,
-                               m_problem->getSolutionAssg()
-#endif
-                               ))
+  if (m_search->importSolution())
     cout << "Initial problem lower bound: " << m_search->curLowerBound()
          << endl;
+  // keep picking up solutions from SLS that runs alongside the search
+  m_search->setSolutionSync(hasBackgroundSLS());
 
 #ifndef NO_HEURISTIC
   if (!m_options->nosearch || m_options->force_compute_tables)
     m_search->finalizeHeuristic();
+  // the search only tightens the bound once it propagates up to the root
+  if (!m_options->nosearch)
+    m_problem->updateUpperBound(m_heuristic->getGlobalUB(), &m_space->stats,
+                                false);
+#endif
+
+#ifdef PARALLEL_DYNAMIC
+  // explores the top of the search space to set up the estimates for
+  // -auto_cutoff (might solve the problem right away)
+  if (!m_options->nosearch && m_search->init())
+    m_solved = true;
 #endif
 
 #ifdef PARALLEL_STATIC
@@ -929,10 +1322,223 @@ bool Main::finishPreproc() {
   double time_passed =
       duration_cast<duration<double>>(_time_pre - _time_start).count();
   cout << "Preprocessing complete: " << time_passed << " seconds" << endl;
+  if (m_schedule)
+    m_schedule->planSearch();
+
+  return true;
+}
+
+bool Main::updateEvidence(const map<int,val_t>& delta) {
+  if (m_options->mplp > 0 || m_options->mplps > 0 || m_options->jglp > 0 ||
+      m_options->jglps > 0 || m_options->fglpHeur || m_options->fglpMBEHeur) {
+    err_txt("Evidence updates need a problem without FGLP/JGLP reparameterization.");
+    return false;
+  }
+  if (!m_options->in_subproblemFile.empty()) {
+    err_txt("Evidence updates not supported for subproblems.");
+    return false;
+  }
+  if (hasBackgroundSLS()) {
+    err_txt("Evidence updates not possible while SLS runs alongside the search.");
+    return false;
+  }
+
+  vector<int> changed;
+  bool added = false;
+  if (!m_problem->updateEvidence(delta, changed, added))
+    return false;
+  for (map<int,val_t>::const_iterator it = delta.begin(); it != delta.end(); ++it) {
+    if (it->second == NONE)
+      m_queryEvidence.erase(it->first);
+    else
+      m_queryEvidence[it->first] = it->second;
+  }
+  if (added)
+    m_pseudotree->resetFunctionInfo(m_problem->getFunctions());
+  cout << "Evidence update changed " << changed.size() << " variable(s)" << endl;
+
+  // previous solutions don't apply anymore, start over with a fresh search
+  // (also if nothing changed, the last search may have been interrupted)
+  m_problem->resetSolution();
+  m_solved = false;
+  m_started = false;
+  m_weight = m_options->weight;
+  if (!initSearch(true))
+    return false;
+
+  if (!changed.empty()) {
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    size_t sz = m_heuristic->rebuild(changed, &m_search->getAssignment());
+    double time_passed = duration_cast<duration<double>>(
+        high_resolution_clock::now() - t).count();
+    cout << "\tMini bucket rebuilt in " << time_passed << " seconds, "
+         << (sz / (1024 * 1024.0)) * sizeof(double) << " MBytes" << endl;
+  }
+
+#ifndef NO_HEURISTIC
+  if (m_options->task == TASK_PR) {
+    // the search sums over the whole space, regardless of the heuristic
+  } else if (m_search->getCurOptValue() >= m_heuristic->getGlobalUB()) {
+    m_solved = true;
+    cout << endl << "--------- Solved during preprocessing ---------" << endl;
+  } else if (m_heuristic->isAccurate()) {
+    m_options->lds = 0;  // set LDS to 0 (sufficient given perfect heuristic)
+    m_solved = true;
+  }
+#endif
+
+  return true;
+}
+
+bool Main::reserveStdout() {
+  cout.flush();
+  fflush(stdout);
+  m_answerFd = dup(STDOUT_FILENO);
+  if (m_answerFd == -1 || dup2(STDERR_FILENO, STDOUT_FILENO) == -1) {
+    err_txt("Redirecting the output to stderr failed.");
+    return false;
+  }
+  return true;
+}
+
+bool Main::serve(const string& endpoint) {
+  // fails right away if the problem doesn't allow evidence updates
+  if (!updateEvidence(map<int,val_t>()))
+    return false;
+  // from now on, -max_time applies to each query
+  m_serving = true;
+
+  if (endpoint == "-") {
+    cout << "Serving queries from standard input" << endl;
+    if (m_answerFd != -1) {
+      FdOutBuf buf(m_answerFd);
+      std::ostream answers(&buf);
+      serveQueries(cin, answers);
+    } else {
+      serveQueries(cin, cout);
+    }
+    outputQueryLatencies();
+    finishEventFeed(false);
+    return true;
+  }
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+  using boost::asio::local::stream_protocol;
+  try {
+    boost::asio::io_service io;
+    ::unlink(endpoint.c_str());  // left over from an earlier session
+    stream_protocol::acceptor acceptor(io, stream_protocol::endpoint(endpoint));
+    cout << "Serving queries on socket " << endpoint << endl;
+    bool more = true;
+    while (more) {
+      stream_protocol::iostream conn;
+      acceptor.accept(*conn.rdbuf());
+      more = serveQueries(conn, conn);
+      outputQueryLatencies();
+    }
+    ::unlink(endpoint.c_str());
+  } catch (boost::system::system_error& e) {
+    err_txt(string("Socket error: ") + e.what());
+    finishEventFeed(false);
+    return false;
+  }
+  finishEventFeed(false);
+  return true;
+#else
+  err_txt("Unix sockets are not supported on this platform.");
+  return false;
+#endif
+}
+
+bool Main::serveQueries(istream& in, ostream& out) {
+  string line;
+  int id = 0;
+  while (getline(in, line)) {
+    boost::algorithm::trim(line);
+    if (line.empty())
+      continue;
+    if (line == "quit")
+      return false;
+    answerQuery(line, id++, out);
+  }
+  return true;
+}
 
+bool Main::answerQuery(const string& line, int id, ostream& out) {
+  high_resolution_clock::time_point t = high_resolution_clock::now();
+  m_queryStart = t;
+
+  map<int,val_t> evid;
+  istringstream is(line);
+  int n = 0, x, y;
+  bool ok = bool(is >> n) && n >= 0;
+  for (int i = 0; ok && i < n; ++i) {
+    ok = bool(is >> x >> y);
+    evid[x] = y;
+  }
+  if (!ok) {
+    cerr << "Malformed query: " << line << endl;
+    out << "q " << id << " error" << endl;
+    return false;
+  }
+
+  // only pass on the difference to the previous query's evidence
+  map<int,val_t> delta;
+  for (map<int,val_t>::const_iterator it = m_queryEvidence.begin(); it != m_queryEvidence.end(); ++it)
+    if (!evid.count(it->first))
+      delta[it->first] = NONE;
+  for (map<int,val_t>::const_iterator it = evid.begin(); it != evid.end(); ++it) {
+    map<int,val_t>::const_iterator itQ = m_queryEvidence.find(it->first);
+    if (itQ == m_queryEvidence.end() || itQ->second != it->second)
+      delta[it->first] = it->second;
+  }
+
+  if (!updateEvidence(delta)) {
+    out << "q " << id << " error" << endl;
+    return false;
+  }
+  ok = runLDS() && finishPreproc() && runSearch();
+  double ms = duration_cast<duration<double, std::milli> >(
+      high_resolution_clock::now() - t).count();
+  if (!ok) {
+    if (m_search->isTimedOut())
+      out << "q " << id << " timeout " << setprecision(6) << ms << endl;
+    else
+      out << "q " << id << " error" << endl;
+    return false;
+  }
+  m_queryTimes.push_back(ms);
+
+  ostringstream ss;
+  ss << "q " << id << ' ' << setprecision(12) << getSolution() << ' '
+     << setprecision(6) << ms;
+  if (m_options->trackAssignment) {
+    vector<val_t> assg;
+    getSolutionAssgOrg(assg);
+    ss << ' ' << assg.size();
+    for (vector<val_t>::const_iterator it = assg.begin(); it != assg.end(); ++it)
+      ss << ' ' << (int) *it;
+  }
+  out << ss.str() << endl;
   return true;
 }
 
+void Main::outputQueryLatencies() const {
+  if (m_queryTimes.empty())
+    return;
+  vector<double> t(m_queryTimes);
+  sort(t.begin(), t.end());
+  // nearest-rank percentiles
+  double p[] = {50, 90, 99};
+  cout << "Queries answered:\t" << t.size() << endl
+       << "Query latency (ms):\t";
+  for (int i = 0; i < 3; ++i) {
+    size_t r = (size_t) ceil(p[i] / 100 * t.size());
+    cout << 'p' << p[i] << ' ' << t[max(r, (size_t) 1) - 1] << " / ";
+  }
+  cout << "max " << t.back() << endl;
+}
+
 #ifdef PARALLEL_DYNAMIC
 /* dynamic master mode for distributed execution */
 bool Main::runSearchDynamic() {
@@ -1032,9 +1638,108 @@ bool Main::runSearchStatic() {
 /* sequential mode or worker mode for distributed execution */
 bool Main::runSearchWorker(size_t nodeLimit) {
   m_solved = m_search->solve(nodeLimit);
+  // a weighted search only completes an iteration of the schedule
+  while (m_solved && m_weight > 1.0) {
+    if (reportWeightedBound())
+      break;
+    m_solved = false;
+    if (!restartWeighted())
+      return false;
+    if (nodeLimit > 0)
+      break;  // (the next call continues with the new weight)
+    m_solved = m_search->solve(nodeLimit);
+  }
+  if (m_solved && hasBackgroundSLS()) {
+    // search is complete, background SLS can't contribute anymore
+    stopSLS();
+    joinSLS();
+    myprint("SLS finished.\n");
+  }
   return m_solved;
 }
 
+bool Main::reportWeightedBound() {
+  double cost = m_problem->getSolutionCost();
+  ostringstream ss;
+  ss << "Weighted search with w=" << m_weight << " done, solution "
+     << std::setprecision(20) << SCALE_LOG(cost);
+  if (m_search->isWeightBounded() && !ISNAN(cost) && cost <= ELEM_ONE) {
+    // the optimal cost is at most 'cost' to the power of 1/w
+#ifdef USE_LOG
+    double bound = cost / m_weight;
+#else
+    double bound = pow(cost, 1.0 / m_weight);
+#endif
+    m_problem->updateLowerUpperBound(cost, bound, &m_space->stats);
+    ss << ", upper bound " << SCALE_LOG(m_problem->getUpperBound());
+  } else {
+    ss << " (no bound, the problem has function values above 1)";
+  }
+  ss << endl;
+  myprint(ss.str());
+
+  double ub = m_problem->getUpperBound();
+  return !ISNAN(cost) && !ISNAN(ub) && (cost >= ub || fabs(cost - ub) < 1e-10);
+}
+
+double Main::nextWeight(double w) const {
+  string kind;
+  double step;
+  parseWeightSchedule(m_options->weightSchedule, &kind, &step);
+  if (kind == "sqrt")
+    w = sqrt(w);
+  else if (kind == "sub")
+    w -= step;
+  else
+    w /= step;
+  return (w < 1.0 + WEIGHT_EPS) ? 1.0 : w;
+}
+
+bool Main::restartWeighted() {
+  m_weight = nextWeight(m_weight);
+  // the values of subproblems solved without pruning below remain valid
+  SearchStats stats = m_space->stats;
+  if (!initSearch(true, true))
+    return false;
+  m_space->stats = stats;
+
+  m_search->importSolution();
+  m_search->setSolutionSync(hasBackgroundSLS());
+#ifndef NO_HEURISTIC
+  m_search->finalizeHeuristic();
+#endif
+  cout << "Restarting search with w=" << m_weight << endl;
+  return true;
+}
+
+#if !defined PARALLEL_DYNAMIC && !defined PARALLEL_STATIC
+/* portfolio mode: the main configuration and the ones given by
+ * -portfolio search in parallel, sharing the problem and its incumbent */
+bool Main::runSearchPortfolio() {
+  vector<pair<string, ProgramOptions> > configs;
+  if (!Portfolio::parse(m_options->portfolio, *m_options, &configs)) {
+    err_txt("Invalid portfolio specification.");
+    return false;
+  }
+  Portfolio portfolio(m_problem.get());
+  portfolio.addMain(m_search.get(), m_heuristic.get(), m_space.get());
+  for (size_t i = 0; i < configs.size(); ++i)
+    portfolio.addMember(configs[i].first, configs[i].second,
+                        m_pseudotree.get());
+  cout << "Running portfolio of " << (configs.size() + 1)
+       << " configurations" << endl;
+
+  m_solved = portfolio.run();
+  portfolio.outputStats();
+  if (m_solved && hasBackgroundSLS()) {
+    stopSLS();
+    joinSLS();
+    myprint("SLS finished.\n");
+  }
+  return m_solved;
+}
+#endif
+
 bool Main::outputStats() const {
   if (m_options->nosearch) {
     cout << "Found '-no_search', full search skipped, exiting." << endl;
@@ -1065,6 +1770,14 @@ bool Main::outputStats() const {
     cout << "Pruned nodes:       " << m_space->stats.numPruned << endl;
     cout << "Deadend nodes:      " << m_space->stats.numDead << endl;
     cout << "Deadend nodes (CP): " << m_space->stats.numDeadCP << endl;
+    const ConstraintPropagator* cp = m_search->getConstraintPropagator();
+    if (cp && cp->getLearnedCount()) {
+      cout << "Nogoods learned:    " << cp->getLearnedCount()
+           << " (" << cp->getNogoodCount() << " kept, "
+           << cp->getNogoodDeletedCount() << " deleted, "
+           << cp->getNogoodDiscardedCount() << " too long)" << endl;
+      cout << "Nogood removals:    " << cp->getNogoodRemovedCount() << endl;
+    }
 
 #ifdef PARALLEL_STATIC
     if (m_options->par_preOnly && m_solved) {
@@ -1123,6 +1836,8 @@ bool Main::outputStats() const {
   }
 #endif
 
+  finishEventFeed(m_solved);
+
   cout << endl;
   return true;
 }
@@ -1181,19 +1896,7 @@ bool Main::start() const {
 #endif
   version += boost::lexical_cast<std::string>(sizeof(val_t) * 8);
 
-#ifdef NO_ASSIGNMENT
-  version += ") w/o assig.";
-#else
-  version += ") w. assig.";
-#endif
-
-#if defined(ANYTIME_DEPTH)
-  version += " /dive";
-#endif
-
-#if defined LIKELIHOOD
-  version += " /likelihood";
-#endif
+  version += ")";
 
   ostringstream oss;
 
@@ -1222,11 +1925,19 @@ bool Main::outputInfo() const {
 
   ostringstream oss;
   oss << "+ algorithm:\t" << m_options->algorithm << endl;
+  if (m_options->task == TASK_PR)
+    oss << "+ task:\t\tpr (probability of evidence)" << endl;
+  if (m_options->trackAssignment)
+    oss << "+ assignment:\ttracked" << endl;
   oss << "+ i-bound:\t" << m_options->ibound << endl << "+ j-bound:\t"
       << m_options->cbound << endl << "+ Memory limit:\t" << m_options->memlimit
       << endl << "+ Suborder:\t" << m_options->subprobOrder << " ("
-      << subprob_order[m_options->subprobOrder] << ")" << endl
-      << "+ Random seed:\t" << m_options->seed << endl;
+      << subprob_order[m_options->subprobOrder] << ")" << endl;
+  if (m_options->subprobOrdering != "")
+    oss << "+ Suborder policy:\t" << m_options->subprobOrdering << endl;
+  if (m_options->valueOrdering != "heur")
+    oss << "+ Value order:\t" << m_options->valueOrdering << endl;
+  oss << "+ Random seed:\t" << m_options->seed << endl;
 #if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
   oss << "+ Cutoff depth:\t" << m_options->cutoff_depth << endl
       << "+ Cutoff size:\t" << m_options->cutoff_size << endl
@@ -1237,6 +1948,8 @@ bool Main::outputInfo() const {
     oss << "+ rotate:\ton (" << m_options->rotateLimit << ")" << endl;
   else
     oss << "+ rotate:\toff" << endl;
+  if (m_options->dive)
+    oss << "+ dive:\t\ton" << endl;
 #endif
 
   cout << oss.str();
@@ -1245,7 +1958,6 @@ bool Main::outputInfo() const {
 
 double Main::getSolution() const { return m_problem->getSolutionCost(); }
 
-#ifndef NO_ASSIGNMENT
 const vector<val_t>& Main::getSolutionAssg() const {
   return m_problem->getSolutionAssg();
 }
@@ -1253,7 +1965,6 @@ const vector<val_t>& Main::getSolutionAssg() const {
 void Main::getSolutionAssgOrg(vector<val_t>& org_sol) const {
   m_problem->assignmentForOutput(m_problem->getSolutionAssg(), org_sol);
 }
-#endif
 
 double computeAvgDepth(const vector<count_t>& before,
                        const vector<count_t>& after, int offset) {
@@ -1401,6 +2112,53 @@ double Main::runEstimation(size_t nodeLimit) {
   return estimate;
 }
 
+bool Main::selectIbound(MiniBucketElim* mbe, int maxIbound) {
+  assert(mbe);
+  // the trials can run on the search heuristic itself unless its build does
+  // more than plain mini buckets (reparameterization, lookahead)
+  bool inPlace = typeid(*mbe) == typeid(MiniBucketElim) &&
+      m_options->mplp <= 0 && m_options->mplps <= 0 &&
+      m_options->jglp <= 0 && m_options->jglps <= 0;
+  ProgramOptions trialOpts(*m_options);
+  std::unique_ptr<MiniBucketElim> trial;
+  if (!inPlace) {
+    trialOpts.mplp = trialOpts.jglp = 0;
+    trialOpts.mplps = trialOpts.jglps = 0;
+    trial.reset(new MiniBucketElim(m_problem.get(), m_pseudotree.get(),
+                                   &trialOpts, 1));
+  }
+
+  IboundSelector selector(m_problem.get(), m_pseudotree.get(), &trialOpts,
+                          &m_search->getAssignment(), m_options->iboundSelect);
+  m_options->ibound = selector.select(inPlace ? mbe : trial.get(), maxIbound,
+                                      m_problem->getSolutionSnapshot());
+  if (inPlace && selector.isBuilt())
+    return true;
+  mbe->setIbound(m_options->ibound);
+  return false;
+}
+
+bool Main::runKnuthEstimation(size_t probes, SearchEstimate* est) {
+  assert(est);
+  if (!m_heuristic->isThreadSafe()) {
+    err_txt("Search space estimation requires a static heuristic.");
+    return false;
+  }
+  KnuthEstimator estimator(m_problem.get(), m_pseudotree.get(),
+                           m_heuristic.get());
+  estimator.setBound(m_problem->getSolutionSnapshot());
+  estimator.setSeed(m_options->seed);
+  *est = estimator.run(probes, max(1, m_options->threads));
+
+  oss ss;
+  ss << "Search space estimate: 10^" << log10(est->nodes)
+     << " OR/AND nodes, 95% CI [10^" << log10(est->lower) << ", 10^"
+     << log10(est->upper) << "] (" << est->probes << " probes, "
+     << est->msec << " ms)" << endl;
+  myprint(ss.str());
+  return true;
+}
+
 bool Main::exportProblemStats(int& fN, int& fF, int& fK, int& fS, int& fW,
                               int& fH) {
   fN = m_problem->getN();
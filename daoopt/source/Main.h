@@ -57,7 +57,11 @@
 
 #include "AOStar.h"
 #include "AnytimeAOStar.h"
+#include "EventFeed.h"
 #include "LimitedDiscrepancy.h"
+#include "IboundSelector.h"
+#include "KnuthEstimator.h"
+#include "Scheduler.h"
 
 namespace daoopt {
 
@@ -65,12 +69,13 @@ class Main {
  protected:
   bool m_solved;
   bool m_started;
+  double m_weight;  // current weight of the anytime weighted search (1: plain search)
   scoped_ptr<ProgramOptions> m_options;
   scoped_ptr<Problem> m_problem;
   scoped_ptr<Pseudotree> m_pseudotree;
   std::unique_ptr<Heuristic> m_heuristic;
 #ifdef ENABLE_SLS
-  scoped_ptr<SLSWrapper> m_slsWrapper;
+  vector<std::unique_ptr<SLSWrapper> > m_slsWrappers;  // one per concurrent run
 #endif
 
 #if defined PARALLEL_DYNAMIC
@@ -85,18 +90,73 @@ class Main {
   scoped_ptr<SearchSpace> m_space;
 #endif
   scoped_ptr<BoundPropagator> m_prop;
+  std::unique_ptr<Scheduler> m_schedule;  // splits -max_time across the stages (if set)
+  std::unique_ptr<EventFeed> m_eventFeed;  // streams solution/bound updates (-event_feed)
+
+  map<int,val_t> m_queryEvidence;  // evidence currently set through updateEvidence()
+  vector<double> m_queryTimes;     // latency of each query served (in ms)
+  bool m_serving;                  // in serve(): searches stop on timeout, the process doesn't exit
+  int m_answerFd;                  // original stdout, reserved for query answers (-1 if not)
+  std::chrono::high_resolution_clock::time_point m_queryStart;  // -max_time counts from here while serving
 
  protected:
   bool runSearchDynamic();
   bool runSearchStatic();
   bool runSearchWorker(size_t nodeLimit = 0);
-
-  static Heuristic* newHeuristic(Problem* p, Pseudotree* pt,
-      ProgramOptions* po);
+  bool runSearchPortfolio();
 
   double evaluate(SearchNode* node) const;
 
+  /* answers the queries read from 'in' (see serve()), returns false once
+   * the session is to end */
+  bool serveQueries(istream& in, ostream& out);
+  /* answers a single query, writes the answer line to 'out' */
+  bool answerQuery(const string& line, int id, ostream& out);
+  /* outputs latency percentiles of the queries served so far */
+  void outputQueryLatencies() const;
+
+  /* (re)creates the search space, bound propagator and search engine;
+   * an existing AOBB search space can be reset and reused instead,
+   * optionally keeping its cache */
+  bool initSearch(bool reuseSpace = false, bool keepCache = false);
+
+  /* anytime weighted search: reports the suboptimality bound of the solution
+   * after a search with weight m_weight > 1 is done, returns true if it
+   * proves the solution optimal */
+  bool reportWeightedBound();
+  /* restarts the search with the next weight of the schedule, keeping the
+   * incumbent, the statistics and (for AOBB) the cached subproblems */
+  bool restartWeighted();
+  /* returns the weight that follows w in the schedule */
+  double nextWeight(double w) const;
+
+  /* runs one LDS probe with the given discrepancy limit, ordering values by
+   * heuristic estimate or (byLabel) by label; picks up the solutions of
+   * concurrent probes from the problem if 'shared'. Stops early once
+   * *abort is set, output lines are prefixed by 'tag'. */
+  bool runLDSProbe(int limit, bool byLabel, bool shared,
+                   const std::atomic<bool>* abort, const string& tag);
+
+  /* sets the i-bound of mbe to the one that minimizes the predicted solve
+   * time, at most maxIbound (see IboundSelector); returns true if mbe is
+   * already built with it */
+  bool selectIbound(MiniBucketElim* mbe, int maxIbound);
+
+  /* cleans up before the process exits on a search timeout (see
+   * Search::setTimeoutHandler()) */
+  void onTimeout();
+  /* writes the end event to the event feed (if any) and closes it */
+  void finishEventFeed(bool solved) const;
+
+  /* waits for all (background) SLS runs to finish */
+  void joinSLS();
+  /* true if SLS runs alongside the search */
+  bool hasBackgroundSLS() const;
+
  public:
+  static Heuristic* newHeuristic(Problem* p, Pseudotree* pt,
+      ProgramOptions* po);
+
   bool start() const;
   bool parseOptions(int argc, char** argv);
   bool setOptions(const ProgramOptions& options);
@@ -117,6 +177,22 @@ class Main {
   bool compileHeuristicAfterBuild(); // to be used with compileHeuristic(int);
   bool runLDS();
   bool finishPreproc();
+  /* applies an evidence delta (original variable indices, NONE retracts)
+   * to the preprocessed problem: rebuilds the heuristic incrementally and
+   * resets the search; to be followed by runLDS() and finishPreproc() */
+  bool updateEvidence(const map<int,val_t>& delta);
+  /* keeps the preprocessed problem resident and answers queries, one per
+   * line in UAI evidence format (no. of variables, then pairs of variable
+   * and value, over the original problem), until end of input or a line
+   * "quit". endpoint is "-" for stdin/stdout (see reserveStdout()) or the
+   * path of a Unix socket, which accepts one connection after another. Each query replaces the
+   * evidence of the previous one; answered by "q <id> <value> <ms>"
+   * (followed by the assignment if tracked), "q <id> timeout <ms>" if the
+   * query takes longer than -max_time, or "q <id> error". */
+  bool serve(const string& endpoint);
+  /* sends all further output to stderr, keeping stdout for the answers of
+   * serve("-"); call before anything is output */
+  bool reserveStdout();
   bool runSearch(size_t nodeLimit = 0);
   bool outputStats() const;
   int outputStatsToFile() const;
@@ -129,6 +205,9 @@ class Main {
   void getSolutionAssgOrg(vector<val_t> &) const; // get solution assignment in terms of original problem specification, with evid added back in.
 
   double runEstimation(size_t nodeLimit = 0);
+  /* estimates the search space size from random probes, in parallel
+   * (-threads); requires a thread-safe heuristic */
+  bool runKnuthEstimation(size_t probes, SearchEstimate* est);
 
   inline Heuristic* getHeuristic() { return m_heuristic.get(); }
 
@@ -139,7 +218,7 @@ class Main {
 
 /* Inline implementations */
 
-inline Main::Main() : m_solved(false), m_started(false) { /* nothing here */ }
+inline Main::Main() : m_solved(false), m_started(false), m_weight(1.0), m_serving(false), m_answerFd(-1) { /* nothing here */ }
 
 inline bool Main::runSearch(size_t nodeLimit) {
   if (m_options->nosearch) {
@@ -157,6 +236,8 @@ inline bool Main::runSearch(size_t nodeLimit) {
 #elif defined PARALLEL_STATIC
   return runSearchStatic();
 #else
+  if (!m_options->portfolio.empty())
+    return runSearchPortfolio();
   return runSearchWorker(nodeLimit);
 #endif
 }
@@ -108,6 +108,11 @@ bool MiniBucket::allowsFunction(Function* f, const set<int> &context) {
 
 /* joins the functions in the MB while marginalizing out the bucket var.,
  * resulting function is returned */
+Function* MiniBucket::eliminate(bool buildTable) {
+  return eliminate<MaxProduct>(buildTable);
+}
+
+template <class Semiring>
 Function* MiniBucket::eliminate(bool buildTable) {
 
 #ifdef DEBUG
@@ -152,7 +157,7 @@ Function* MiniBucket::eliminate(bool buildTable) {
   double* newTable = NULL;
   if (buildTable) {
     newTable = new double[tablesize];
-    for (j=0; j<tablesize; ++j) newTable[j] = ELEM_ZERO;
+    for (j=0; j<tablesize; ++j) newTable[j] = Semiring::zero();
 
     // this keeps track of the tuple assignment
     val_t* tuple = new val_t[n+1];
@@ -204,11 +209,11 @@ Function* MiniBucket::eliminate(bool buildTable) {
     for (*elimVal = 0; *elimVal < m_problem->getDomainSize(m_bucketVar); ++(*elimVal) ) {
       idx=0; // go over the full new table
       do {
-        z = ELEM_ONE;
+        z = Semiring::one();
         for (j=0; j<m_functions.size(); ++j)
-          z OP_TIMESEQ m_functions[j]->getValuePtr(idxMap[j]);
+          z = Semiring::times(z, m_functions[j]->getValuePtr(idxMap[j]));
 //        if (z>newTable[idx]) valMax = *elimVal;
-        newTable[idx] = max(newTable[idx],z);
+        newTable[idx] = Semiring::plus(newTable[idx],z);
       } while ( increaseTuple(idx,tuple,domains) );
 
     }
@@ -225,6 +230,9 @@ Function* MiniBucket::eliminate(bool buildTable) {
   return new_fn;
 }
 
+template Function* MiniBucket::eliminate<MaxProduct>(bool buildTable);
+template Function* MiniBucket::eliminate<SumProduct>(bool buildTable);
+
 /* joins the functions in the MB
  * resulting function is returned */
 Function* MiniBucket::join(bool buildTable) {
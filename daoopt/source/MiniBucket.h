@@ -26,6 +26,7 @@
 
 #include "Function.h"
 #include "Problem.h"
+#include "Semiring.h"
 
 namespace daoopt {
 
@@ -66,6 +67,11 @@ public:
   // set buildTable==false to get only size estimate (table will not be computed)
   Function* eliminate(bool buildTable=true);
 
+  // same, but marginalizes the bucket variable in the given semiring (see
+  // Semiring.h); the above is eliminate<MaxProduct>
+  template <class Semiring>
+  Function* eliminate(bool buildTable);
+
   // eliminates the specified set of variables instead of the bucket variables
   Function* eliminate(bool buildTable, const set<int> &elimVars);
 
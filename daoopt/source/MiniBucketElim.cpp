@@ -23,6 +23,14 @@
 
 #include "MiniBucketElim.h"
 
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <chrono>
+using namespace std::chrono;
+
 /* disables DEBUG output */
 #undef DEBUG
 
@@ -50,7 +58,7 @@ namespace daoopt {
 double MiniBucketElim::getHeur(int var, vector<val_t>& assignment, SearchNode* n)
 {
 	assert( var >= 0 && var < m_problem->getN());
-  ++var_heur_calls_[var];
+  var_heur_calls_[var].fetch_add(1, std::memory_order_relaxed);
 	double h = ELEM_ONE;
 
 	// go over augmented and intermediate lists and combine all values
@@ -155,10 +163,14 @@ void MiniBucketElim::reset() {
 //  vector<vector<Function*> > empty2;
 //  m_intermediate.swap(empty2);
 	for (vector<vector<Function*> >::iterator itA = m_augmented.begin(); itA!=m_augmented.end(); ++itA)
-		for (vector<Function*>::iterator itB = itA->begin(); itB!=itA->end(); ++itB)
+		for (vector<Function*>::iterator itB = itA->begin(); itB!=itA->end(); ++itB) {
+			if (m_mapping) (*itB)->detachTable();  // table is in the mapped file
 			delete *itB;
+		}
 	m_augmented.clear();
 	m_intermediate.clear();
+	m_bucketOutputs.clear();
+	m_mapping.reset();
 }
 
 size_t MiniBucketElim::build(int task, const vector<val_t> * assignment, bool computeTables){
@@ -172,6 +184,7 @@ size_t MiniBucketElim::build(const vector<val_t> * assignment, bool computeTable
 #endif
 
   this->reset();
+  m_problemHash = m_problem->hash();
   if (computeTables) {
     LPReparameterization();
   }
@@ -181,6 +194,7 @@ size_t MiniBucketElim::build(const vector<val_t> * assignment, bool computeTable
 
   m_augmented.resize(m_problem->getN());
   m_intermediate.resize(m_problem->getN());
+  m_bucketOutputs.resize(m_problem->getN());
   _MiniBuckets.resize(m_problem->getN());
 
   // keep track of total memory consumption
@@ -188,163 +202,254 @@ size_t MiniBucketElim::build(const vector<val_t> * assignment, bool computeTable
 
   // ITERATES OVER BUCKETS, FROM LEAVES TO ROOT
   for (vector<int>::reverse_iterator itV=elimOrder.rbegin(); itV!=elimOrder.rend(); ++itV) {
-	  int v = *itV;  // this is the variable being eliminated
-	  // partition functions into minibuckets
-	  vector<MiniBucket>& minibuckets = _MiniBuckets[v];
-	  minibuckets.clear();
+    // compute global upper bound for root (dummy) bucket
+    if (*itV == elimOrder[0]) {// variable is dummy root variable
+      if (computeTables && assignment) // compute upper bound if assignment is given
+        computeGlobalUB(*itV, *assignment);
+      continue; // skip the dummy variable's bucket
+    }
+    memSize += processBucket(*itV, computeTables);
+  }
 
 #ifdef DEBUG
-    cout << "$ Bucket for variable " << *itV << endl;
+  // output augmented and intermediate buckets
+  if (computeTables)
+    for (int i=0; i<m_problem->getN(); ++i) {
+      cout << "$ AUG" << i << ": " << m_augmented[i] << " + " << m_intermediate[i] << endl;
+    }
 #endif
 
-    // collect relevant functions in funs
-    vector<Function*> funs;
-    const vector<Function*>& fnlist = m_pseudotree->getFunctions(*itV);
-    funs.insert(funs.end(), fnlist.begin(), fnlist.end());
-    funs.insert(funs.end(), m_augmented[*itV].begin(), m_augmented[*itV].end());
-#ifdef DEBUG
-    for (vector<Function*>::iterator itF=funs.begin(); itF!=funs.end(); ++itF)
-      cout << ' ' << (**itF);
-    cout << endl;
-#endif
+  // clean up for estimation mode
+  if (!computeTables) {
+	  this->reset() ;
+/*    for (vector<vector<Function*> >::iterator itA = m_augmented.begin(); itA!=m_augmented.end(); ++itA)
+      for (vector<Function*>::iterator itB = itA->begin(); itB!=itA->end(); ++itB)
+        delete *itB;
+    m_augmented.clear();
+    m_intermediate.clear();*/
+  }
 
-    // compute global upper bound for root (dummy) bucket
-    if (*itV == elimOrder[0]) {// variable is dummy root variable
-      if (computeTables && assignment) { // compute upper bound if assignment is given
-        m_globalUB = ELEM_ONE;
-        for (vector<Function*>::iterator itF=funs.begin(); itF!=funs.end(); ++itF)
-          m_globalUB OP_TIMESEQ (*itF)->getValue(*assignment);
-        cout << "    MBE-ALL  = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
-        m_globalUB OP_DIVIDEEQ m_problem->globalConstInfo();  // for backwards compatibility of output
-        cout << "    MBE-ROOT = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
-      }
-      continue; // skip the dummy variable's bucket
-    }
+  return memSize;
+}
 
-    // sort functions by decreasing scope size
-    sort(funs.begin(), funs.end(), scopeIsLarger);
+size_t MiniBucketElim::rebuild(const vector<int>& changedVars,
+                               const vector<val_t>* assignment) {
+  // incremental compilation needs the bucket outputs of a previous build()
+  if (m_bucketOutputs.size() != size_t(m_problem->getN()))
+    return build(assignment, true);
 
-    // partition functions into minibuckets
-//    vector<Function*>::iterator itF; bool placed;
-    for (vector<Function*>::iterator itF = funs.begin(); itF!=funs.end();
-         ++itF) {
-      bool placed = false;
-      for (vector<MiniBucket>::iterator itB=minibuckets.begin();
-            !placed && itB!=minibuckets.end(); ++itB)
-      {
-        if (itB->allowsFunction(*itF)) { // checks if function fits into bucket
-          itB->addFunction(*itF);
-          placed = true;
-        }
-      }
-      if (!placed) { // no fit, need to create new bucket
-        MiniBucket mb(*itV,m_ibound,m_problem);
-        mb.addFunction(*itF);
-        minibuckets.push_back(mb);
-      }
+  vector<int> elimOrder;
+  findDfsOrder(elimOrder);
+
+  // a bucket is recomputed if one of its original functions changed or if
+  // it receives a message from a recomputed bucket (before or after)
+  vector<bool> dirty(m_problem->getN(), false);
+  for (int v : changedVars)
+    dirty[v] = true;
+
+  size_t memSize = 0;
+  int recomputed = 0;
+  for (vector<int>::reverse_iterator itV=elimOrder.rbegin(); itV!=elimOrder.rend(); ++itV) {
+    int v = *itV;
+    if (v == elimOrder[0]) {
+      if (dirty[v] && assignment)
+        computeGlobalUB(v, *assignment);
+      continue;
+    }
+    if (!dirty[v]) {  // reuse the bucket's messages
+      for (const Function* f : m_bucketOutputs[v])
+        memSize += f->getTableSize();
+      continue;
+    }
+    for (Function* f : m_bucketOutputs[v]) {
+      dirty[retractFunction(v, f)] = true;
+      delete f;
     }
+    m_bucketOutputs[v].clear();
+    memSize += processBucket(v, true, &dirty);
+    ++recomputed;
+  }
+  cout << "    MBE rebuild recomputed " << recomputed << " of "
+       << (elimOrder.size() - 1) << " buckets" << endl;
 
+  return memSize;
+}
 
-    // Moment-matching step, performed only if we have partitioning.
-    vector<Function*> max_marginals;
-    std::unique_ptr<Function> average_mm_function;
-    if (computeTables && m_options->match && minibuckets.size() > 1) {
+/* combines the functions of the root (dummy) bucket into m_globalUB */
+void MiniBucketElim::computeGlobalUB(int root, const vector<val_t>& assignment) {
+  m_globalUB = ELEM_ONE;
+  for (const Function* f : m_pseudotree->getFunctions(root))
+    m_globalUB OP_TIMESEQ f->getValue(assignment);
+  for (const Function* f : m_augmented[root])
+    m_globalUB OP_TIMESEQ f->getValue(assignment);
+  cout << "    MBE-ALL  = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
+  m_globalUB OP_DIVIDEEQ m_problem->globalConstInfo();  // for backwards compatibility of output
+  cout << "    MBE-ROOT = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
+}
 
-      set<int> scope_intersection;
-      bool first_mini_bucket = true;
-      for (const MiniBucket& mini_bucket : minibuckets) {
-        if (first_mini_bucket) {
-          scope_intersection = mini_bucket.getJointScope();
-          first_mini_bucket = false;
-        } else {
-          scope_intersection =
-              intersection(scope_intersection, mini_bucket.getJointScope());
-        }
-      }
-      for (MiniBucket& mini_bucket : minibuckets) {
-        set<int> elim_vars =
-            setminus(mini_bucket.getJointScope(), scope_intersection);
-        max_marginals.push_back(
-            mini_bucket.eliminate(computeTables, elim_vars));
-      }
+/* partitions the bucket of v into minibuckets, eliminates v from each and
+ * places the resulting messages */
+size_t MiniBucketElim::processBucket(int v, bool computeTables,
+                                     vector<bool>* touched) {
+  // partition functions into minibuckets
+  vector<MiniBucket>& minibuckets = _MiniBuckets[v];
+  minibuckets.clear();
 
-      // Find average max-marginals (geometric mean)
-      size_t table_size = 1;
-      for (const int var : scope_intersection) {
-        table_size *= m_problem->getDomainSize(var);
-      }
+#ifdef DEBUG
+  cout << "$ Bucket for variable " << v << endl;
+#endif
 
-      double* average_mm_table = new double[table_size];
-      for (size_t i = 0; i < table_size; ++i) {
-        average_mm_table[i] = ELEM_ONE;
-      }
-      for (const Function* max_marginal : max_marginals) {
-        for (size_t i = 0; i < table_size; ++i) {
-          average_mm_table[i] OP_TIMESEQ max_marginal->getTable()[i];
-        }
-      }
-      for (size_t i = 0; i < table_size; ++i) {
-        average_mm_table[i] = OP_ROOT(average_mm_table[i], minibuckets.size());
+  // collect relevant functions in funs
+  vector<Function*> funs;
+  const vector<Function*>& fnlist = m_pseudotree->getFunctions(v);
+  funs.insert(funs.end(), fnlist.begin(), fnlist.end());
+  funs.insert(funs.end(), m_augmented[v].begin(), m_augmented[v].end());
+#ifdef DEBUG
+  for (vector<Function*>::iterator itF=funs.begin(); itF!=funs.end(); ++itF)
+    cout << ' ' << (**itF);
+  cout << endl;
+#endif
+
+  size_t memSize = 0;
+
+  // for the probability of evidence, the first minibucket of each bucket
+  // sums out the variable, the others maximize (upper bound on the sum)
+  const bool sumTask = m_options && m_options->task == TASK_PR;
+
+  // sort functions by decreasing scope size
+  sort(funs.begin(), funs.end(), scopeIsLarger);
+
+  // partition functions into minibuckets
+//    vector<Function*>::iterator itF; bool placed;
+  for (vector<Function*>::iterator itF = funs.begin(); itF!=funs.end();
+       ++itF) {
+    bool placed = false;
+    for (vector<MiniBucket>::iterator itB=minibuckets.begin();
+          !placed && itB!=minibuckets.end(); ++itB)
+    {
+      if (itB->allowsFunction(*itF)) { // checks if function fits into bucket
+        itB->addFunction(*itF);
+        placed = true;
       }
-      int dummy_id = 0;
-      average_mm_function.reset(
-          new FunctionBayes(dummy_id, m_problem, scope_intersection,
-                            average_mm_table, table_size));
     }
+    if (!placed) { // no fit, need to create new bucket
+      MiniBucket mb(v,m_ibound,m_problem);
+      mb.addFunction(*itF);
+      minibuckets.push_back(mb);
+    }
+  }
 
-    // minibuckets for current bucket are now ready, process each
-    // and place resulting function
-    int bucket_idx = 0;
-    for (MiniBucket& mini_bucket : minibuckets) {
-      Function* new_function;
-      if (!computeTables || !m_options->match || minibuckets.size() <= 1) {
-        new_function = mini_bucket.eliminate(computeTables);
+
+  // Moment-matching step, performed only if we have partitioning.
+  vector<Function*> max_marginals;
+  std::unique_ptr<Function> average_mm_function;
+  if (computeTables && m_options->match && !sumTask &&
+      minibuckets.size() > 1) {
+
+    set<int> scope_intersection;
+    bool first_mini_bucket = true;
+    for (const MiniBucket& mini_bucket : minibuckets) {
+      if (first_mini_bucket) {
+        scope_intersection = mini_bucket.getJointScope();
+        first_mini_bucket = false;
       } else {
-        new_function = mini_bucket.eliminateMM(computeTables,
-                                               max_marginals[bucket_idx++],
-                                               average_mm_function.get());
+        scope_intersection =
+            intersection(scope_intersection, mini_bucket.getJointScope());
       }
+    }
+    for (MiniBucket& mini_bucket : minibuckets) {
+      set<int> elim_vars =
+          setminus(mini_bucket.getJointScope(), scope_intersection);
+      max_marginals.push_back(
+          mini_bucket.eliminate(computeTables, elim_vars));
+    }
 
-      const set<int>& new_scope = new_function->getScopeSet();
-      memSize += new_function->getTableSize();
-      // go up in tree to find target bucket
-      PseudotreeNode* n = m_pseudotree->getNode(*itV)->getParent();
-      while (new_scope.find(n->getVar()) == new_scope.end() &&
-             n != m_pseudotree->getRoot()) {
-        m_intermediate[n->getVar()].push_back(new_function);
-        n = n->getParent();
+    // Find average max-marginals (geometric mean)
+    size_t table_size = 1;
+    for (const int var : scope_intersection) {
+      table_size *= m_problem->getDomainSize(var);
+    }
+
+    double* average_mm_table = new double[table_size];
+    for (size_t i = 0; i < table_size; ++i) {
+      average_mm_table[i] = ELEM_ONE;
+    }
+    for (const Function* max_marginal : max_marginals) {
+      for (size_t i = 0; i < table_size; ++i) {
+        average_mm_table[i] OP_TIMESEQ max_marginal->getTable()[i];
       }
-      // matching bucket found OR root of pseudo tree reached
-      m_augmented[n->getVar()].push_back(new_function);
     }
-    // all minibuckets processed and resulting functions placed
-    for (int i = 0; i < max_marginals.size(); ++i) {
-      delete max_marginals[i];
+    for (size_t i = 0; i < table_size; ++i) {
+      average_mm_table[i] = OP_ROOT(average_mm_table[i], minibuckets.size());
     }
-    max_marginals.clear();
+    int dummy_id = 0;
+    average_mm_function.reset(
+        new FunctionBayes(dummy_id, m_problem, scope_intersection,
+                          average_mm_table, table_size));
   }
 
-#ifdef DEBUG
-  // output augmented and intermediate buckets
-  if (computeTables)
-    for (int i=0; i<m_problem->getN(); ++i) {
-      cout << "$ AUG" << i << ": " << m_augmented[i] << " + " << m_intermediate[i] << endl;
+  // minibuckets for current bucket are now ready, process each
+  // and place resulting function
+  int bucket_idx = 0;
+  for (MiniBucket& mini_bucket : minibuckets) {
+    Function* new_function;
+    if (sumTask && &mini_bucket == &minibuckets.front()) {
+      new_function = mini_bucket.eliminate<SumProduct>(computeTables);
+    } else if (!computeTables || !m_options->match || sumTask ||
+               minibuckets.size() <= 1) {
+      new_function = mini_bucket.eliminate(computeTables);
+    } else {
+      new_function = mini_bucket.eliminateMM(computeTables,
+                                             max_marginals[bucket_idx++],
+                                             average_mm_function.get());
     }
-#endif
 
-  // clean up for estimation mode
-  if (!computeTables) {
-	  this->reset() ;
-/*    for (vector<vector<Function*> >::iterator itA = m_augmented.begin(); itA!=m_augmented.end(); ++itA)
-      for (vector<Function*>::iterator itB = itA->begin(); itB!=itA->end(); ++itB)
-        delete *itB;
-    m_augmented.clear();
-    m_intermediate.clear();*/
+    memSize += new_function->getTableSize();
+    m_bucketOutputs[v].push_back(new_function);
+    int target = placeFunction(v, new_function);
+    if (touched) (*touched)[target] = true;
   }
+  // all minibuckets processed and resulting functions placed
+  for (int i = 0; i < max_marginals.size(); ++i) {
+    delete max_marginals[i];
+  }
+  max_marginals.clear();
 
   return memSize;
 }
 
+/* places a message generated in the bucket of v in the closest ancestor
+ * bucket that mentions a variable of its scope (or the root), records it as
+ * intermediate for the buckets in between; returns the target bucket */
+int MiniBucketElim::placeFunction(int v, Function* f) {
+  const set<int>& scope = f->getScopeSet();
+  PseudotreeNode* n = m_pseudotree->getNode(v)->getParent();
+  while (scope.find(n->getVar()) == scope.end() &&
+         n != m_pseudotree->getRoot()) {
+    m_intermediate[n->getVar()].push_back(f);
+    n = n->getParent();
+  }
+  // matching bucket found OR root of pseudo tree reached
+  m_augmented[n->getVar()].push_back(f);
+  return n->getVar();
+}
+
+/* undoes placeFunction(v, f), returns the former target bucket */
+int MiniBucketElim::retractFunction(int v, Function* f) {
+  PseudotreeNode* n = m_pseudotree->getNode(v)->getParent();
+  for (;;) {
+    vector<Function*>& aug = m_augmented[n->getVar()];
+    vector<Function*>::iterator it = find(aug.begin(), aug.end(), f);
+    if (it != aug.end()) {
+      aug.erase(it);
+      return n->getVar();
+    }
+    vector<Function*>& inter = m_intermediate[n->getVar()];
+    inter.erase(find(inter.begin(), inter.end(), f));
+    n = n->getParent();
+  }
+}
+
 // Re-parameterize problem using FGLP on original factors
 bool MiniBucketElim::DoFGLP() {
   bool changed_functions = false;
@@ -395,15 +500,22 @@ bool MiniBucketElim::DoJGLP() {
 
 // Copy daoopt Function class into mex::Factor class structures
 mex::vector<mex::Factor> MiniBucketElim::CopyFactors() {
+  high_resolution_clock::time_point start = high_resolution_clock::now();
   mex::vector<mex::Factor> functions(m_problem->getC());
   for (int i = 0; i < m_problem->getC(); ++i) {
-    functions[i] = m_problem->getFunctions()[i]->asFactor().exp();
+    m_problem->getFunctions()[i]->toFactor(functions[i], true);
   }
+  if (m_options && m_options->jglpTiming)
+    cout << "Converting functions to factors took "
+         << duration_cast<duration<double> >(
+                high_resolution_clock::now() - start).count()
+         << " seconds" << endl;
   return functions;
 }
 
 void MiniBucketElim::RewriteFactors(const vector<mex::Factor>& factors,
                                     double global_constant = 0.0) {
+  high_resolution_clock::time_point start = high_resolution_clock::now();
   vector<Function*> new_functions;
   for (size_t function_idx = 0; function_idx < factors.size(); ++function_idx) {
     const mex::Factor& factor = factors[function_idx];
@@ -431,6 +543,12 @@ void MiniBucketElim::RewriteFactors(const vector<mex::Factor>& factors,
     new FunctionBayes(
       factors.size(), m_problem, std::set<int>(), table_ptr, 1));
 
+  if (m_options && m_options->jglpTiming)
+    cout << "Converting factors to functions took "
+         << duration_cast<duration<double> >(
+                high_resolution_clock::now() - start).count()
+         << " seconds" << endl;
+
   // Replace the problem definition with the new functions.
   m_problem->replaceFunctions(new_functions);
 
@@ -577,6 +695,9 @@ size_t MiniBucketElim::getSize() const {
 
 bool MiniBucketElim::writeToFile(string fn) const {
 
+  if (m_options && m_options->minibucketMmap)
+    return writeToMappedFile(fn);
+
   ogzstream out(fn.c_str());
   if ( ! out ) {
     cerr << "Error writing mini buckets to file " << fn << endl;
@@ -658,6 +779,9 @@ bool MiniBucketElim::writeToFile(string fn) const {
 
 bool MiniBucketElim::readFromFile(string fn) {
 
+  if (m_options && m_options->minibucketMmap)
+    return readFromMappedFile(fn);
+
   ifstream inTemp(fn.c_str());
   inTemp.close();
   if (inTemp.fail()) { // file not existent yet
@@ -744,3 +868,252 @@ bool MiniBucketElim::readFromFile(string fn) {
 }
 
 }  // namespace daoopt
+
+namespace daoopt {
+
+/* Mapped heuristic file: a header (padded to a page), the index of all
+ * functions and the bucket lists, then the tables, starting on a page
+ * boundary. Tables of at least a page are page-aligned, smaller ones are
+ * aligned to cache lines. All numbers are in native byte order. */
+struct MappedMBHeader {
+  char magic[8];
+  uint32 version;
+  int32 ibound;
+  uint64 nVars;
+  uint64 problemHash;
+  uint64 orderingHash;
+  double globalUB;
+  uint64 nFunctions;
+  uint64 indexOffset;
+  uint64 indexSize;
+  uint64 fileSize;
+};
+
+static const char MAPPED_MB_MAGIC[8] = {'D','A','O','O','P','T','M','B'};
+static const uint32 MAPPED_MB_VERSION = 1;
+
+static inline uint64 alignUp(uint64 x, uint64 a) {
+  return (x + a - 1) / a * a;
+}
+
+template <class T>
+static inline void appendIndex(vector<char>& buf, const T& x) {
+  buf.insert(buf.end(), (const char*) &x, (const char*) &x + sizeof(T));
+}
+
+template <class T>
+static inline bool readIndex(const char*& p, const char* end, T& x) {
+  if (p + sizeof(T) > end) return false;
+  memcpy(&x, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+bool MiniBucketElim::writeToMappedFile(const string& fn) const {
+  const uint64 page = boost::interprocess::mapped_region::get_page_size();
+  const vector<int>& order = m_pseudotree->getElimOrder();
+
+  MappedMBHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAPPED_MB_MAGIC, sizeof(header.magic));
+  header.version = MAPPED_MB_VERSION;
+  header.ibound = m_ibound;
+  header.nVars = m_augmented.size();
+  header.problemHash = m_problemHash;
+  header.orderingHash = hashBytes(&order[0], order.size() * sizeof(int));
+  header.globalUB = m_globalUB;
+  header.indexOffset = alignUp(sizeof(header), page);
+
+  // index: per function id, scope and table location, then the bucket lists
+  map<const Function*, uint64> funcIdx;
+  vector<const Function*> funcs;
+  for (size_t i = 0; i < m_augmented.size(); ++i)
+    for (const Function* f : m_augmented[i]) {
+      funcIdx.insert(make_pair(f, funcs.size()));
+      funcs.push_back(f);
+    }
+  header.nFunctions = funcs.size();
+
+  vector<uint64> tableOffsets(funcs.size());
+  vector<char> index;
+  for (size_t j = 0; j < funcs.size(); ++j) {  // tables are placed below
+    appendIndex(index, (int32) funcs[j]->getId());
+    appendIndex(index, (uint64) funcs[j]->getScopeVec().size());
+    for (int v : funcs[j]->getScopeVec())
+      appendIndex(index, (int32) v);
+    appendIndex(index, (uint64) funcs[j]->getTableSize());
+    appendIndex(index, (uint64) 0);  // table offset, filled in below
+  }
+  for (size_t i = 0; i < m_augmented.size(); ++i) {
+    appendIndex(index, (uint64) m_augmented[i].size());
+    for (const Function* f : m_augmented[i])
+      appendIndex(index, funcIdx[f]);
+    appendIndex(index, (uint64) m_intermediate[i].size());
+    for (const Function* f : m_intermediate[i])
+      appendIndex(index, funcIdx[f]);
+  }
+  header.indexSize = index.size();
+
+  uint64 offset = alignUp(header.indexOffset + header.indexSize, page);
+  char* entry = &index[0];
+  for (size_t j = 0; j < funcs.size(); ++j) {
+    uint64 bytes = funcs[j]->getTableSize() * sizeof(double);
+    offset = alignUp(offset, (bytes >= page) ? page : 64);
+    tableOffsets[j] = offset;
+    offset += bytes;
+    entry += sizeof(int32) + sizeof(uint64) +
+        funcs[j]->getScopeVec().size() * sizeof(int32) + sizeof(uint64);
+    memcpy(entry, &tableOffsets[j], sizeof(uint64));
+    entry += sizeof(uint64);
+  }
+  header.fileSize = alignUp(offset, page);
+
+  // written to a temporary file first and renamed, so that processes that
+  // have mapped an earlier version of the file are not affected
+  ostringstream tmp;
+  tmp << fn << ".tmp" << getpid();
+  FILE* out = fopen(tmp.str().c_str(), "wb");
+  if (!out) {
+    cerr << "Error writing mini buckets to file " << fn << endl;
+    return false;
+  }
+  bool ok = true;
+  vector<char> padding(page, 0);
+  uint64 pos = 0;
+  // writes 'bytes' bytes of 'data' at file offset 'at' (after padding)
+  auto put = [&](uint64 at, const void* data, uint64 bytes) {
+    while (ok && pos < at) {
+      uint64 n = min(at - pos, (uint64) padding.size());
+      ok = fwrite(&padding[0], 1, n, out) == n;
+      pos += n;
+    }
+    if (ok && bytes)
+      ok = fwrite(data, 1, bytes, out) == bytes;
+    pos += bytes;
+  };
+  put(0, &header, sizeof(header));
+  put(header.indexOffset, &index[0], index.size());
+  for (size_t j = 0; j < funcs.size(); ++j)
+    put(tableOffsets[j], funcs[j]->getTable(),
+        funcs[j]->getTableSize() * sizeof(double));
+  put(header.fileSize, NULL, 0);
+  ok = (fclose(out) == 0) && ok;
+  if (!ok || rename(tmp.str().c_str(), fn.c_str()) != 0) {
+    remove(tmp.str().c_str());
+    cerr << "Error writing mini buckets to file " << fn << endl;
+    return false;
+  }
+  return true;
+}
+
+bool MiniBucketElim::readFromMappedFile(const string& fn) {
+  using namespace boost::interprocess;
+
+  ifstream inTemp(fn.c_str());
+  inTemp.close();
+  if (inTemp.fail()) { // file not existent yet
+    return false;
+  }
+
+  std::shared_ptr<mapped_region> region;
+  try {
+    file_mapping file(fn.c_str(), read_only);
+    region.reset(new mapped_region(file, read_only));
+  } catch (interprocess_exception& e) {
+    cerr << "Error mapping mini bucket file " << fn << ": " << e.what() << endl;
+    return false;
+  }
+  const char* base = (const char*) region->get_address();
+  const uint64 size = region->get_size();
+
+  MappedMBHeader header;
+  if (size < sizeof(header)) {
+    cerr << "Mini bucket file " << fn << " is truncated" << endl;
+    return false;
+  }
+  memcpy(&header, base, sizeof(header));
+  const vector<int>& order = m_pseudotree->getElimOrder();
+  if (memcmp(header.magic, MAPPED_MB_MAGIC, sizeof(header.magic)) ||
+      header.version != MAPPED_MB_VERSION) {
+    cerr << "Mini bucket file " << fn << " has an unknown format" << endl;
+    return false;
+  }
+  if (header.fileSize != size ||
+      header.indexOffset + header.indexSize > size) {
+    cerr << "Mini bucket file " << fn << " is truncated" << endl;
+    return false;
+  }
+  if (header.nVars != (uint64) m_problem->getN() ||
+      header.problemHash != m_problem->hash()) {
+    cerr << "Mini bucket file " << fn << " was computed for another problem" << endl;
+    return false;
+  }
+  if (header.orderingHash != hashBytes(&order[0], order.size() * sizeof(int))) {
+    cerr << "Mini bucket file " << fn << " was computed for another ordering" << endl;
+    return false;
+  }
+  if (header.ibound != m_ibound) {
+    cerr << "Mini bucket file " << fn << " has i-bound " << header.ibound
+         << ", expected " << m_ibound << endl;
+    return false;
+  }
+
+  this->reset();
+
+  const char* p = base + header.indexOffset;
+  const char* end = p + header.indexSize;
+  bool ok = true;
+  vector<Function*> funcs;
+  for (uint64 j = 0; ok && j < header.nFunctions; ++j) {
+    int32 id, v;
+    uint64 arity, tableSize, tableOffset;
+    set<int> scope;
+    ok = readIndex(p, end, id) && readIndex(p, end, arity);
+    for (uint64 k = 0; ok && k < arity; ++k) {
+      ok = readIndex(p, end, v);
+      scope.insert(v);
+    }
+    ok = ok && readIndex(p, end, tableSize) && readIndex(p, end, tableOffset) &&
+        tableOffset + tableSize * sizeof(double) <= size;
+    if (ok)
+      funcs.push_back(new FunctionBayes(id, m_problem, scope,
+          (double*) (base + tableOffset), tableSize));
+  }
+  m_augmented.resize(header.nVars);
+  m_intermediate.resize(header.nVars);
+  m_mapping = region;  // from here on, reset() detaches the mapped tables
+  for (uint64 i = 0; ok && i < header.nVars; ++i) {
+    uint64 n, idx;
+    ok = readIndex(p, end, n);
+    for (uint64 k = 0; ok && k < n; ++k) {
+      ok = readIndex(p, end, idx) && idx < funcs.size();
+      if (ok) m_augmented[i].push_back(funcs[idx]);
+    }
+    ok = ok && readIndex(p, end, n);
+    for (uint64 k = 0; ok && k < n; ++k) {
+      ok = readIndex(p, end, idx) && idx < funcs.size();
+      if (ok) m_intermediate[i].push_back(funcs[idx]);
+    }
+  }
+  if (!ok) {
+    // functions not (yet) placed in a bucket are deleted here
+    set<Function*> placed;
+    for (const vector<Function*>& aug : m_augmented)
+      placed.insert(aug.begin(), aug.end());
+    for (Function* f : funcs)
+      if (!placed.count(f)) {
+        f->detachTable();
+        delete f;
+      }
+    this->reset();
+    cerr << "Mini bucket file " << fn << " is corrupt" << endl;
+    return false;
+  }
+
+  m_globalUB = header.globalUB;
+  m_problemHash = header.problemHash;
+  cout << "Mapped mini bucket with i-bound " << m_ibound << " from file " << fn << endl;
+  return true;
+}
+
+}  // namespace daoopt
@@ -40,6 +40,15 @@
 #include "FGLP.h"
 #include "PriorityFGLP.h"
 
+#include <atomic>
+#include <memory>
+
+namespace boost {
+namespace interprocess {
+class mapped_region;
+}  // namespace interprocess
+}  // namespace boost
+
 namespace daoopt {
 
 /* The overall minibucket elimination */
@@ -63,6 +72,9 @@ class MiniBucketElim : public Heuristic {
   // generated in a pseudotree descendant and passed to an ancestor of v
   // (points to the same function objects as m_augmented)
   vector<vector<Function*>> m_intermediate;
+  // For each variable, the functions generated by its bucket (points to the
+  // same function objects as m_augmented), to recompute them in rebuild()
+  vector<vector<Function*>> m_bucketOutputs;
 
   // a set of minibuckets, one for each var
   std::vector<std::vector<MiniBucket>> _MiniBuckets;
@@ -73,7 +85,15 @@ class MiniBucketElim : public Heuristic {
   FGLP* m_fglpRoot;
 
   // Count the number of times getHeur is called on a varaible
-  vector<uint64> var_heur_calls_;
+  // (atomic, as concurrent searches may share the heuristic)
+  vector<std::atomic<uint64>> var_heur_calls_;
+
+  // Hash of the problem at the start of the last build (before any
+  // reparameterization), stored in mapped heuristic files
+  uint64 m_problemHash;
+  // Mapped heuristic file the function tables point into (if any)
+  // (shared_ptr, as the type is incomplete here)
+  std::shared_ptr<boost::interprocess::mapped_region> m_mapping;
 
  protected:
   // Computes a dfs order of the pseudo tree, for building the bucket structure
@@ -85,6 +105,18 @@ class MiniBucketElim : public Heuristic {
   // reset the data structures
   virtual void reset();
 
+  // processes the bucket of the given variable, places the resulting
+  // functions and (if given) flags their target buckets in 'touched';
+  // returns the size of the new tables
+  size_t processBucket(int v, bool computeTables,
+                       vector<bool>* touched = NULL);
+  // places/removes a function generated in the bucket of v, returns the
+  // target bucket
+  int placeFunction(int v, Function* f);
+  int retractFunction(int v, Function* f);
+  // computes m_globalUB from the root (dummy) bucket
+  void computeGlobalUB(int root, const vector<val_t>& assignment);
+
  public:
   inline std::vector<std::vector<MiniBucket>>& MiniBuckets(void) {
     return _MiniBuckets;
@@ -104,6 +136,11 @@ class MiniBucketElim : public Heuristic {
                        bool computeTables = true);
   virtual size_t build(int task, const vector<val_t>* assignment = NULL,
                        bool computeTables = true);
+  // recomputes only the buckets of the changed variables and the buckets
+  // their messages reach (transitively), reusing all other tables; no
+  // reparameterization is done
+  virtual size_t rebuild(const vector<int>& changedVars,
+                         const vector<val_t>* assignment = NULL);
 
   // returns the global upper bound
   double getGlobalUB() const { return m_globalUB; }
@@ -136,8 +173,15 @@ class MiniBucketElim : public Heuristic {
 
   bool writeToFile(string fn) const;
   bool readFromFile(string fn);
+  // uncompressed, page-aligned layout (-minibucket_mmap): a header binds the
+  // file to the problem, ordering and i-bound, the tables are used in place
+  // from a read-only mapping
+  bool writeToMappedFile(const string& fn) const;
+  bool readFromMappedFile(const string& fn);
 
   bool isAccurate();
+  // queries only read the tables (and count calls atomically)
+  bool isThreadSafe() const { return true; }
 
   // Preprocess problem using FGLP/JGLP
   bool DoFGLP();
@@ -185,8 +229,10 @@ inline bool MiniBucketElim::isAccurate() {
 
 inline MiniBucketElim::MiniBucketElim(Problem* p, Pseudotree* pt,
                                       ProgramOptions* po, int ib)
-    : Heuristic(p, pt, po), m_ibound(ib), m_globalUB(ELEM_ONE) {
-  var_heur_calls_.resize(p->getN(), 0);
+    : Heuristic(p, pt, po), m_ibound(ib), m_globalUB(ELEM_ONE),
+      var_heur_calls_(p->getN()), m_problemHash(0) {
+  for (std::atomic<uint64>& c : var_heur_calls_)
+    c = 0;
 }
 
 inline void MiniBucketElim::printExtraStats() const {
@@ -0,0 +1,363 @@
+/*
+ * MiniBucketElimARP.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MiniBucketElimARP.h"
+
+#include "ARP/ARPall.hxx"
+
+namespace daoopt {
+
+MiniBucketElimARP::MiniBucketElimARP(Problem* p, Pseudotree* pt,
+                                     ProgramOptions* po, int ib)
+    : Heuristic(p, pt, po), m_ibound(ib), m_globalUB(ELEM_ONE) {
+  m_K.assign(p->getDomains().begin(), p->getDomains().end());
+  m_values.assign(p->getN(), 0);
+}
+
+
+MiniBucketElimARP::~MiniBucketElimARP() {
+  reset();
+}
+
+
+void MiniBucketElimARP::reset() {
+  m_heurFns.clear();
+  m_heurStrides.clear();
+  m_heurVars.clear();
+  m_ws.reset();
+}
+
+
+void MiniBucketElimARP::findDfsOrder(vector<int>& order) const {
+  order.clear();
+  stack<PseudotreeNode*> dfs;
+  dfs.push(m_pseudotree->getRoot());
+  while (!dfs.empty()) {
+    PseudotreeNode* n = dfs.top();
+    dfs.pop();
+    order.push_back(n->getVar());
+    for (PseudotreeNode* c : n->getChildren())
+      dfs.push(c);
+  }
+}
+
+
+size_t MiniBucketElimARP::build(const vector<val_t>* assignment,
+                                bool computeTables) {
+  reset();
+
+  if (computeTables && (m_options->mplp > 0 || m_options->mplps > 0 ||
+                        m_options->jglp > 0 || m_options->jglps > 0)) {
+    cout << "ARP mini buckets: FGLP/JGLP reparameterization not supported, "
+         << "ignored" << endl;
+  }
+
+  int n = m_problem->getN();
+  if (!m_arp) {
+    m_arp.reset(new ARE::ARP("daoopt"));
+    if (!m_problem->toARP(*m_arp)) {
+      cerr << "Error setting up ARP mini buckets" << endl;
+      exit(1);
+    }
+  }
+
+  // ARP takes the elimination order, i.e. the reverse of the dfs order; any
+  // variables outside the pseudo tree are eliminated first
+  vector<int> order;
+  findDfsOrder(order);
+  vector<bool> inOrder(n, false);
+  for (int v : order)
+    inOrder[v] = true;
+  vector<int32_t> elim;
+  elim.reserve(n);
+  for (int v = 0; v < n; ++v)
+    if (!inOrder[v]) elim.push_back(v);
+  for (vector<int>::reverse_iterator it = order.rbegin(); it != order.rend();
+       ++it)
+    elim.push_back(*it);
+
+  m_ws.reset(new BucketElimination::MBEworkspace());
+  int32_t res = m_arp->SetVarElimOrdering(elim.data(),
+                                          m_pseudotree->getWidth() + 1);
+  if (0 == res)
+    res = m_ws->Initialize(*m_arp, m_arp->FunctionsAreConvertedToLogScale(),
+                           NULL, 0);
+  if (0 == res)
+    res = m_ws->CreateBuckets(false, false, false);
+  if (0 == res) {
+    // ARP bounds the mini bucket scope including the eliminated variable,
+    // daoopt's i-bound excludes it (cf. MiniBucket::allowsFunction())
+    m_ws->iBound() = m_ibound + 1;
+    res = m_ws->CreateMBPartitioning(computeTables,
+                                     computeTables && m_options->match, 1);
+  }
+  if (0 != res) {
+    cerr << "Error building ARP mini buckets (" << res << ")" << endl;
+    exit(1);
+  }
+
+  // table sizes of all mini bucket output functions
+  size_t memSize = 0;
+  for (int32_t i = 0; i < m_ws->nBuckets(); ++i) {
+    for (BucketElimination::MiniBucket* mb :
+         m_ws->getBucket(i)->MiniBuckets()) {
+      ARE::Function& f = mb->OutputFunction();
+      if (f.N() > 0) memSize += f.ComputeTableSize();
+    }
+  }
+
+  if (!computeTables)
+    return memSize;
+
+  // collect the heuristic components of each variable
+  m_heurFns.resize(n);
+  m_heurStrides.resize(n);
+  m_heurVars.resize(n);
+  for (int var = 0; var < n; ++var) {
+    BucketElimination::Bucket* b = m_ws->MapVar2Bucket(var);
+    if (!b) continue;
+    vector<ARE::Function*>& fns = m_heurFns[var];
+    for (int32_t j = 0; j < b->nAugmentedFunctions(); ++j)
+      fns.push_back(b->AugmentedFunction(j));
+    for (int32_t j = 0; j < b->nIntermediateFunctions(); ++j)
+      fns.push_back(b->IntermediateFunction(j));
+    set<int> vars;
+    for (ARE::Function* f : fns) {
+      int64_t stride = 0, s = 1;
+      for (int32_t k = f->N() - 1; k >= 0; --k) {
+        int v = f->Argument(k);
+        if (v == var)
+          stride = s;
+        else
+          vars.insert(v);
+        s *= m_K[v];
+      }
+      m_heurStrides[var].push_back(stride);
+    }
+    m_heurVars[var].assign(vars.begin(), vars.end());
+  }
+
+  // the global upper bound combines all constant output functions
+  if (assignment) {
+    m_globalUB = ELEM_ONE;
+    for (int32_t i = 0; i < m_ws->nBuckets(); ++i) {
+      for (BucketElimination::MiniBucket* mb :
+           m_ws->getBucket(i)->MiniBuckets()) {
+        ARE::Function& f = mb->OutputFunction();
+        if (f.N() == 0) m_globalUB OP_TIMESEQ f.ConstValue();
+      }
+    }
+    for (Function* f : m_pseudotree->getFunctions(m_pseudotree->getRoot()->getVar()))
+      m_globalUB OP_TIMESEQ f->getValue(*assignment);
+    cout << "    MBE-ALL  = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
+    m_globalUB OP_DIVIDEEQ m_problem->globalConstInfo();  // for backwards compatibility of output
+    cout << "    MBE-ROOT = " << SCALE_LOG(m_globalUB) << " (" << SCALE_NORM(m_globalUB) << ")" << endl;
+  }
+
+  cout << "ARP mini buckets: " << m_ws->nBuckets() << " buckets, "
+       << m_ws->nBucketsWithPartitioning() << " partitioned, max. "
+       << m_ws->MaxNumMiniBucketsPerBucket() << " mini buckets per bucket"
+       << endl;
+
+  return memSize;
+}
+
+
+size_t MiniBucketElimARP::limitSize(size_t memlimit,
+                                    const vector<val_t>* assignment) {
+  // convert to number of table entries
+  memlimit *= 1024 * 1024 / sizeof(double);
+
+  int decreaseIbd = 0;
+  int ibound = m_options->ibound;
+  if (ibound <= 0) {  // no i-bound provided, start from the induced width
+    decreaseIbd = m_options->ibound;
+    ibound = m_options->jglpi;
+    m_options->jglpi = 0;
+  }
+
+  // (i-bounds as in MiniBucketElim, build() converts them for ARP)
+  cout << "Adjusting mini bucket i-bound..." << endl;
+  this->setIbound(ibound);
+  size_t mem = this->build(assignment, false);
+  cout << " i=" << ibound << " -> " << ((mem / (1024*1024.0)) * sizeof(double))
+       << " MBytes" << endl;
+
+  while (mem > memlimit && ibound > 1) {
+    this->setIbound(--ibound);
+    mem = this->build(assignment, false);
+    cout << " i=" << ibound << " -> "
+         << ((mem / (1024*1024.0)) * sizeof(double)) << " MBytes" << endl;
+  }
+
+  if (decreaseIbd < 0) {
+    ibound = ibound + decreaseIbd;
+    this->setIbound(ibound);
+    cout << " decreased i bound by " << decreaseIbd << ", i= " << ibound << endl;
+  }
+  m_options->ibound = ibound;
+  return mem;
+}
+
+
+size_t MiniBucketElimARP::getSize() const {
+  if (!m_ws) return 0;
+  size_t S = 0;
+  for (int32_t i = 0; i < m_ws->nBuckets(); ++i) {
+    for (BucketElimination::MiniBucket* mb :
+         m_ws->getBucket(i)->MiniBuckets()) {
+      const ARE::Function& f = mb->OutputFunction();
+      if (f.N() > 0 && f.TableSize() > 0) S += f.TableSize();
+    }
+  }
+  return S;
+}
+
+
+bool MiniBucketElimARP::readFromFile(string fn) {
+  if (!fn.empty())
+    cout << "ARP mini buckets can't be read from file, compiling instead"
+         << endl;
+  return false;
+}
+
+
+bool MiniBucketElimARP::writeToFile(string fn) const {
+  cerr << "ARP mini buckets can't be written to file " << fn << endl;
+  return false;
+}
+
+
+inline void MiniBucketElimARP::setValues(int var,
+                                         const vector<val_t>& assignment) {
+  for (int v : m_heurVars[var])
+    m_values[v] = assignment[v];
+}
+
+
+inline double MiniBucketElimARP::evalFns(const vector<ARE::Function*>& fns) {
+  double h = ELEM_ONE;
+  for (ARE::Function* f : fns) {
+    if (f->N() == 0)
+      h OP_TIMESEQ f->ConstValue();
+    else
+      h OP_TIMESEQ f->TableData()[f->ComputeFnTableAdr(m_values.data(),
+                                                       m_K.data())];
+  }
+  return h;
+}
+
+
+double MiniBucketElimARP::getHeur(int var, vector<val_t>& assignment,
+                                  SearchNode* n) {
+  assert(var >= 0 && var < m_problem->getN());
+  setValues(var, assignment);
+  m_values[var] = assignment[var];
+  return evalFns(m_heurFns[var]);
+}
+
+
+double MiniBucketElimARP::getHeurPerIndSubproblem(
+    int var, std::vector<val_t>& assignment, SearchNode* node, double label,
+    std::vector<double>& subprobH) {
+  // as in MiniBucketElim: the components of var's bucket are the
+  // intermediate functions and the mini bucket outputs of its child buckets
+  for (int v = 0; v < m_problem->getN(); ++v)
+    m_values[v] = assignment[v];
+  double h = ELEM_ONE;
+  const vector<PseudotreeNode*>& children =
+      m_pseudotree->getNode(var)->getChildren();
+  subprobH.resize(children.size(), ELEM_ONE);
+  vector<ARE::Function*> fns;
+  for (size_t i = 0; i < children.size(); ++i) {
+    fns.clear();
+    BucketElimination::Bucket* b =
+        m_ws->MapVar2Bucket(children[i]->getVar());
+    if (b) {
+      for (int32_t j = 0; j < b->nIntermediateFunctions(); ++j)
+        fns.push_back(b->IntermediateFunction(j));
+      for (BucketElimination::MiniBucket* mb : b->MiniBuckets())
+        fns.push_back(&mb->OutputFunction());
+    }
+    subprobH[i] = evalFns(fns);
+    h OP_TIMESEQ subprobH[i];
+  }
+  return h;
+}
+
+
+void MiniBucketElimARP::getHeurAll(int var, vector<val_t>& assignment,
+                                   SearchNode* n, vector<double>& out) {
+  int k = m_problem->getDomainSize(var);
+  out.clear();
+  out.resize(k, ELEM_ONE);
+  setValues(var, assignment);
+  m_values[var] = 0;
+  const vector<ARE::Function*>& fns = m_heurFns[var];
+  const vector<int64_t>& strides = m_heurStrides[var];
+  for (size_t i = 0; i < fns.size(); ++i) {
+    ARE::Function* f = fns[i];
+    if (f->N() == 0) {
+      for (int j = 0; j < k; ++j)
+        out[j] OP_TIMESEQ f->ConstValue();
+      continue;
+    }
+    const ARE_Function_TableType* T =
+        f->TableData() + f->ComputeFnTableAdr(m_values.data(), m_K.data());
+    int64_t s = strides[i];
+    for (int j = 0; j < k; ++j)
+      out[j] OP_TIMESEQ T[j * s];
+  }
+}
+
+
+double MiniBucketElimARP::getLabel(int var, const vector<val_t>& assignment,
+                                   SearchNode* node) {
+  double d = ELEM_ONE;
+  for (Function* f : m_pseudotree->getFunctions(var))
+    d OP_TIMESEQ f->getValue(assignment);
+  return d;
+}
+
+
+void MiniBucketElimARP::getLabelAll(int var, const vector<val_t>& assignment,
+                                    SearchNode* node, vector<double>& out) {
+  vector<double> costTmp(m_problem->getDomainSize(var), ELEM_ONE);
+  for (Function* f : m_pseudotree->getFunctions(var)) {
+    f->getValues(assignment, var, costTmp);
+    for (int i = 0; i < m_problem->getDomainSize(var); ++i)
+      out[i] OP_TIMESEQ costTmp[i];
+  }
+}
+
+
+double MiniBucketElimARP::getOrderingHeur(int var, vector<val_t>& assignment,
+                                          SearchNode* node) {
+  return node->getHeurCache()[assignment[var]];
+}
+
+
+void MiniBucketElimARP::printExtraStats() const {
+  if (!m_ws) return;
+  cout << "ARP mini buckets: i-bound " << m_ibound << ", "
+       << m_ws->nBucketsWithPartitioning() << " of " << m_ws->nBuckets()
+       << " buckets partitioned, " << getSize() << " table entries" << endl;
+}
+
+}  // namespace daoopt
@@ -0,0 +1,126 @@
+/*
+ * MiniBucketElimARP.h
+ *
+ *  Mini-bucket heuristic compiled by ARP's bucket elimination workspace
+ *  (BucketElimination::MBEworkspace) instead of daoopt's own MiniBucketElim.
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MINIBUCKETELIMARP_H_
+#define MINIBUCKETELIMARP_H_
+
+#include "Heuristic.h"
+#include "Problem.h"
+#include "ProgramOptions.h"
+#include "Pseudotree.h"
+
+#include <memory>
+
+namespace ARE {
+class ARP;
+class Function;
+}
+namespace BucketElimination {
+class MBEworkspace;
+}
+
+namespace daoopt {
+
+/*
+ * The problem is converted to an ARE::ARP instance once; the workspace's
+ * bucket tree follows a dfs order of the pseudo tree, so that ARP's
+ * augmented/intermediate functions of a bucket are exactly the heuristic
+ * components daoopt's MiniBucketElim uses for the bucket's variable.
+ * Superbuckets are not created: variables merged into a superbucket would
+ * not have a bucket (and thus no heuristic) of their own.
+ */
+class MiniBucketElimARP : public Heuristic {
+
+ protected:
+  int m_ibound;       // The ibound for this MB instance
+  double m_globalUB;  // The global upper bound
+
+  std::unique_ptr<ARE::ARP> m_arp;
+  std::unique_ptr<BucketElimination::MBEworkspace> m_ws;
+
+  // for each variable, the augmented and intermediate functions of its bucket
+  // (owned by the workspace), the stride of the variable in each function
+  // table (0 if not in scope), and the other variables of their scopes
+  vector<vector<ARE::Function*> > m_heurFns;
+  vector<vector<int64_t> > m_heurStrides;
+  vector<vector<int> > m_heurVars;
+
+  // domain sizes and the current assignment in ARP's representation
+  vector<int32_t> m_K;
+  vector<int32_t> m_values;
+
+ protected:
+  // computes a dfs order of the pseudo tree, root first
+  void findDfsOrder(vector<int>&) const;
+  // combines the values of the given functions under m_values
+  double evalFns(const vector<ARE::Function*>& fns);
+  // copies the relevant part of the assignment into m_values
+  void setValues(int var, const vector<val_t>& assignment);
+  void reset();
+
+ public:
+  size_t limitSize(size_t memlimit, const vector<val_t>* assignment);
+  size_t getSize() const;
+
+  size_t build(const vector<val_t>* assignment = NULL,
+               bool computeTables = true);
+
+  bool readFromFile(string fn);
+  bool writeToFile(string fn) const;
+
+  double getGlobalUB() const { return m_globalUB; }
+
+  double getHeur(int var, vector<val_t>& assignment, SearchNode* n);
+  double getHeurPerIndSubproblem(int var, std::vector<val_t>& assignment,
+                                 SearchNode* node, double label,
+                                 std::vector<double>& subprobH);
+  void getHeurAll(int var, vector<val_t>& assignment, SearchNode* n,
+                  vector<double>& out);
+
+  double getLabel(int var, const vector<val_t>& assignment, SearchNode* n);
+  void getLabelAll(int var, const vector<val_t>& assignment, SearchNode* n,
+                   vector<double>& out);
+
+  double getOrderingHeur(int var, vector<val_t>& assignment, SearchNode* n);
+
+  void setIbound(int ibound) { m_ibound = ibound; }
+  int getIbound() const { return m_ibound; }
+
+  bool isAccurate();
+
+  void printExtraStats() const;
+
+ public:
+  MiniBucketElimARP(Problem* p, Pseudotree* pt, ProgramOptions* po, int ib);
+  virtual ~MiniBucketElimARP();
+};
+
+/* Inline definitions */
+
+inline bool MiniBucketElimARP::isAccurate() {
+  assert(m_pseudotree);
+  return (m_pseudotree->getWidthCond() <= m_ibound);
+}
+
+}  // namespace daoopt
+
+#endif /* MINIBUCKETELIMARP_H_ */
@@ -201,6 +201,7 @@ size_t MiniBucketElimLH::build(const std::vector<val_t> *assignment,
 #endif
 
   reset();
+  m_problemHash = m_problem->hash();
   if (computeTables) {
     LPReparameterization();
   }
@@ -524,6 +525,8 @@ size_t MiniBucketElimLH::build(const std::vector<val_t> *assignment,
         fflush(m_options->_fpLogFile);
       }
 
+      if (m_options->lookaheadMemo) SetupLookaheadMemo(total_memory_limit);
+
       // compute statistic for lookahead subtrees
       for (auto itV = elimOrder.begin(); itV != elimOrder.end(); ++itV) {
         int v = *itV;
@@ -825,9 +828,10 @@ void MiniBucketElimLH::getHeurAll(int var, vector<val_t> &assignment,
 
       // We decide if they're different by just comparing the
       // argmaxs of the two orderings (results in false negatives)
+      lh_values_.resize(var_domain_size);
+      lhHelper.GetHeuristicAll(assignment, lh_values_);
       for (val_t i = 0; i < var_domain_size; ++i) {
-        assignment[var] = i;
-        double lh_value = lhHelper.GetHeuristic(assignment);
+        double lh_value = lh_values_[i];
         if (out[i] > no_lh_max) {
           no_lh_argmax = i;
           no_lh_max = out[i];
@@ -857,10 +861,7 @@ void MiniBucketElimLH::getHeurAll(int var, vector<val_t> &assignment,
         }
       }
     } else {
-      for (val_t i = 0; i < var_domain_size; ++i) {
-        assignment[var] = i;
-        out[i] = lhHelper.GetHeuristic(assignment);
-      }
+      lhHelper.GetHeuristicAll(assignment, out);
     }
   }
 
@@ -1775,6 +1776,44 @@ int MiniBucketElimLH::computeLocalErrorTableSlice(
   return 0;
 }
 
+int MiniBucketElimLH::SetupLookaheadMemo(
+    double TotalMemoryLimitAsNumElementsLog) {
+  // without a total limit, default to 10^7 entries
+  if (TotalMemoryLimitAsNumElementsLog <= 0.0)
+    TotalMemoryLimitAsNumElementsLog = 7.0;
+  double budget = pow(10.0, TotalMemoryLimitAsNumElementsLog);
+
+  // only nodes of subtrees that are computed and whose output function
+  // depends on the context get a memo
+  vector<MBLHSubtreeNode *> nodes;
+  for (MBLHSubtree &lh : _Lookahead) {
+    if (NULL != lh._IsCopyOfEarlierSubtree) continue;
+    for (MBLHSubtreeNode *n : lh._SubtreeNodes) {
+      if (NULL != n->_OutputFunction && n->_MemoContext.size() > 0)
+        nodes.push_back(n);
+    }
+  }
+  _Stats._LHMemoMemorySizeMB = 0;
+  if (nodes.empty()) return 0;
+
+  double per_node = budget / nodes.size();
+  size_t entries = 0;
+  int nWithMemo = 0;
+  for (MBLHSubtreeNode *n : nodes) {
+    size_t capacity = size_t(per_node / n->_OutputFunctionSize);
+    n->PrepMemo(capacity);
+    if (capacity > 0) {
+      ++nWithMemo;
+      entries += capacity * n->_OutputFunctionSize;
+    }
+  }
+  _Stats._LHMemoMemorySizeMB = entries * sizeof(double) / (1024.0 * 1024);
+  cout << "LH memo: " << nWithMemo << " of " << nodes.size()
+       << " subtree nodes, up to " << _Stats._LHMemoMemorySizeMB << " MB"
+       << endl;
+  return 0;
+}
+
 int MiniBucketElimLH::computeLocalErrorTables(
     bool build_tables, double TotalMemoryLimitAsNumElementsLog,
     double TableMemoryLimitAsNumElementsLog) {
@@ -69,6 +69,13 @@ class MiniBucketElimLHStatistics {
                                              // those with nonempty lookahead
                                              // subtrees
   double _LookaheadTotalTime;
+  // lookahead memo (-lookahead_memo): lookups and hits of memoized subtree
+  // node output functions, nodes not computed since an ancestor node was a
+  // hit, and memory allotted to the memo.
+  int64 _LHMemoLookups;
+  int64 _LHMemoHits;
+  int64 _LHMemoSkipped;
+  double _LHMemoMemorySizeMB;
 
  public:
   void reset(void) {
@@ -81,6 +88,10 @@ class MiniBucketElimLHStatistics {
     _LEMemorySizeMB = 0;
     _MaxNumMBs = 0;
     _NumBucketsWithMoreThan1MB = 0;
+    _LHMemoLookups = 0;
+    _LHMemoHits = 0;
+    _LHMemoSkipped = 0;
+    _LHMemoMemorySizeMB = 0;
   }
 
  public:
@@ -93,7 +104,11 @@ class MiniBucketElimLHStatistics {
         _MemorySize(0),
         _LEMemorySizeMB(0),
         _MaxNumMBs(0),
-        _NumBucketsWithMoreThan1MB(0) {}
+        _NumBucketsWithMoreThan1MB(0),
+        _LHMemoLookups(0),
+        _LHMemoHits(0),
+        _LHMemoSkipped(0),
+        _LHMemoMemorySizeMB(0) {}
 };
 
 /* enhanced minibucket elimination */
@@ -199,6 +214,9 @@ class MiniBucketElimLH : public MiniBucketElim {
   // whether GetHeuristic calls should be made on the lookahead subtree
   bool lookahead_subtree_ok_;
 
+  // scratch space for lookahead values across a variable's domain
+  std::vector<double> lh_values_;
+
  public:
   inline std::vector<MBLHSubtree> &LH(void) { return _Lookahead; }
   inline int64 nLHcalls(int v) { return _nLHcalls[v]; }
@@ -310,6 +328,10 @@ class MiniBucketElimLH : public MiniBucketElim {
                               double TotalMemoryLimitAsNumElementsLog,
                               double TableMemoryLimitAsNumElementsLog);
 
+  // set up the context-keyed memos of the lookahead subtree nodes, splitting
+  // a total of 10^TotalMemoryLimitAsNumElementsLog table entries evenly.
+  int SetupLookaheadMemo(double TotalMemoryLimitAsNumElementsLog);
+
   // compute local MiniBucket error_H, defined as the different between
   // 1) max-product of m_augmented FNs in the bucket
   // 2) output FNs of all minibuckets of the bucket
@@ -346,6 +368,8 @@ class MiniBucketElimLH : public MiniBucketElim {
  public:
   MiniBucketElimLH(Problem *p, Pseudotree *pt, ProgramOptions *po, int ib);
   void printExtraStats() const;
+  // lookahead computes into shared buffers
+  bool isThreadSafe() const { return false; }
   virtual ~MiniBucketElimLH(void);
 };
 
@@ -401,6 +425,15 @@ inline void MiniBucketElimLH::printExtraStats() const {
   cout << "Lookahead ratio (AND): " << double(total_lookahead_and) /
                                            total_calls_and << endl;
   cout << "Variables w/ lookahead: " << count_var_lookahead << endl;
+  if (m_options->lookaheadMemo) {
+    cout << "LH memo lookups: " << _Stats._LHMemoLookups << endl;
+    cout << "LH memo hits: " << _Stats._LHMemoHits << " ("
+         << (_Stats._LHMemoLookups > 0
+                 ? double(_Stats._LHMemoHits) / _Stats._LHMemoLookups
+                 : 0.0)
+         << ")" << endl;
+    cout << "LH memo skipped nodes: " << _Stats._LHMemoSkipped << endl;
+  }
   cout << "Better orderings w/ lookahead: " << endl;
   cout << count_better_ordering_ << endl;
   cout << "Better orderings w/ lookahead (ratio): " << endl;
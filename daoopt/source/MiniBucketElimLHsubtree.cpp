@@ -21,6 +21,7 @@
  *      Author: Lars Otten <lotten@ics.uci.edu>
  */
 
+#include <algorithm>
 #include <vector>
 #include <cstddef>
 #include <fstream>
@@ -60,34 +61,48 @@ extern int64 nd1GeneralCalls;
 
 //#define USE_H_RESIDUAL
 
-int daoopt::MBLHSubtreeNode::ComputeidxVarMapping(std::vector<val_t> & assignment)
+// stride of each scope variable of f in its table; the last scope variable has stride 1.
+static void FunctionStrides(const daoopt::Function & f, daoopt::Problem & problem, std::vector<size_t> & strides)
 {
-	if (0 == _RelevantFunctions.size()) 
-		{ _idxVarMappingComputed = true ; return 0 ; }
-	if (NULL == _OutputFunction) 
-		return 1 ;
-	_idxVarMapping.clear() ;
-	_idxVarMapping.reserve(_RelevantFunctions.size()) ;
-	_idxVarMapping.resize(_RelevantFunctions.size()) ;
-	val_t *assignment_data = assignment.data() ;
-	// compute ptr2value mapping for each function
-	int i = 0 ;
-	for (vector<Function*>::const_iterator fit = _RelevantFunctions.begin(); fit != _RelevantFunctions.end(); ++fit, i++) {
-		Function *f = *fit ;
-		std::vector<val_t*> & ptr2value = _idxVarMapping[i] ;
+	const std::vector<int> & scope = f.getScopeVec() ;
+	strides.resize(scope.size()) ;
+	size_t stride = 1 ;
+	for (int j = scope.size() - 1 ; j >= 0 ; j--) {
+		strides[j] = stride ;
+		stride *= problem.getDomainSize(scope[j]) ;
+		}
+}
+
+int daoopt::MBLHSubtreeNode::ComputeStrides(void)
+{
+	// the root node has no output function; all its variables other than _v are instantiated
+	static const std::vector<int> no_scope ;
+	daoopt::Problem *problem = _H->getProblem() ;
+	int nF = _RelevantFunctions.size() ;
+	const std::vector<int> & scopeOF = (NULL != _OutputFunction) ? _OutputFunction->getScopeVec() : no_scope ;
+	_vStrides.assign(nF, 0) ;
+	_OFStrides.assign(scopeOF.size() * nF, 0) ;
+	_ContextStrides.clear() ;
+	_ContextStrides.resize(nF) ;
+	std::vector<size_t> strides ;
+	for (int i = 0 ; i < nF ; i++) {
+		Function *f = _RelevantFunctions[i] ;
 		const std::vector<int> & scope = f->getScopeVec() ;
-		ptr2value.clear() ;
-		ptr2value.reserve(scope.size()) ;
-		for (int j = 0 ; j < scope.size() ; j++)
-			ptr2value.push_back(assignment_data + scope[j]) ;
-		}
-	// compute ptr2value mapping for output function scope
-	_idxOutputFunctionScopeMapping.clear() ;
-	_idxOutputFunctionScopeMapping.reserve(_OutputFunctionScope.size()) ;
-	const std::vector<int> & scopeOF = _OutputFunction->getScopeVec() ;
-	for (int j = 0 ; j < scopeOF.size() ; j++)
-		_idxOutputFunctionScopeMapping.push_back(assignment_data + scopeOF[j]) ;
-	_idxVarMappingComputed = true ;
+		FunctionStrides(*f, *problem, strides) ;
+		for (int j = 0 ; j < scope.size() ; j++) {
+			int u = scope[j] ;
+			if (u == _v) 
+				{ _vStrides[i] = strides[j] ; continue ; }
+			std::vector<int>::const_iterator itOF = std::find(scopeOF.begin(), scopeOF.end(), u) ;
+			if (itOF != scopeOF.end()) 
+				_OFStrides[(itOF - scopeOF.begin()) * nF + i] = strides[j] ;
+			else 
+				_ContextStrides[i].push_back(std::make_pair(u, strides[j])) ;
+			}
+		}
+	_idx.resize(nF) ;
+	_z.resize(_k) ;
+	_StridesComputed = true ;
 	return 0 ;
 }
 
@@ -164,19 +179,67 @@ int daoopt::MBLHSubtreeNode::Delete(void)
 	_OutputFunctionScopeDomains.clear() ;
 	_OutputFunctionSize = -1 ;
 	if (NULL != _OutputFunction) { delete _OutputFunction ; _OutputFunction = NULL ; }
-	_idxVarMappingComputed = false ;
-	_idxVarMapping.clear() ;
-	_idxOutputFunctionScopeMapping.clear() ;
+	_StridesComputed = false ;
+	_vStrides.clear() ;
+	_OFStrides.clear() ;
+	_ContextStrides.clear() ;
+	_MemoContext.clear() ;
+	PrepMemo(0) ;
+	return 0 ;
+}
+
+int daoopt::MBLHSubtreeNode::PrepMemo(size_t Capacity)
+{
+	_MemoCapacity = (NULL != _OutputFunction && _MemoContext.size() > 0) ? Capacity : 0 ;
+	_MemoSlots.clear() ;
+	_MemoKeys.clear() ;
+	_MemoTables.clear() ;
+	_MemoNext = 0 ;
+	_MemoStatus = 0 ;
+	// slots are allocated as they are filled
 	return 0 ;
 }
 
-int daoopt::MBLHSubtreeNode::ComputeOutputFunction(std::vector<val_t> & assignment)
+bool daoopt::MBLHSubtreeNode::MemoLookup(std::vector<val_t> & assignment)
+{
+	_MemoKey.clear() ;
+	for (int u : _MemoContext) 
+		_MemoKey.append((const char*) &assignment[u], sizeof(val_t)) ;
+	++(_H->_Stats._LHMemoLookups) ;
+	std::unordered_map<std::string, size_t>::const_iterator it = _MemoSlots.find(_MemoKey) ;
+	if (it == _MemoSlots.end()) 
+		return false ;
+	++(_H->_Stats._LHMemoHits) ;
+	const double *table = &_MemoTables[it->second * _OutputFunctionSize] ;
+	std::copy(table, table + _OutputFunctionSize, _OutputFunction->getTable()) ;
+	_IsValidForCurrentContext = true ;
+	return true ;
+}
+
+void daoopt::MBLHSubtreeNode::MemoStore(void)
+{
+	size_t slot = _MemoNext ;
+	if (_MemoKeys.size() < _MemoCapacity) {
+		_MemoKeys.push_back(_MemoKey) ;
+		_MemoTables.resize(_MemoKeys.size() * _OutputFunctionSize) ;
+		}
+	else {
+		_MemoSlots.erase(_MemoKeys[slot]) ;
+		_MemoKeys[slot] = _MemoKey ;
+		}
+	_MemoSlots[_MemoKey] = slot ;
+	if (++_MemoNext >= _MemoCapacity) _MemoNext = 0 ;
+	const double *table = _OutputFunction->getTable() ;
+	std::copy(table, table + _OutputFunctionSize, &_MemoTables[slot * _OutputFunctionSize]) ;
+}
+
+int daoopt::MBLHSubtreeNode::ComputeOutputFunction(std::vector<val_t> & assignment, bool Lookup)
 {
   _IsValidForCurrentContext = true;
 	if (NULL == _OutputFunction) 
 		return 0 ;
-	if (! _idxVarMappingComputed) {
-		int res = ComputeidxVarMapping(assignment) ;
+	if (! _StridesComputed) {
+		int res = ComputeStrides() ;
 		if (0 != res) 
 			return res ;
 		}
@@ -187,32 +250,51 @@ int daoopt::MBLHSubtreeNode::ComputeOutputFunction(std::vector<val_t> & assignme
 			return 0 ;
 		}
 
+	if (Lookup && MemoEnabled()) {
+		if (MemoLookup(assignment)) 
+			return 0 ;
+		}
+
 	++_nTimesComputed ;
 
-	// enumerate over all combinations of _OutputFunctionScope[] values; for each eliminate _v by max
-	int i, k, n = _idxOutputFunctionScopeMapping.size() ;
-	if (n > 0) {
-		for (i = n-2 ; i >= 0 ; i--)  
-			*(_idxOutputFunctionScopeMapping[i]) = 0 ;
-		*(_idxOutputFunctionScopeMapping[n-1]) = -1 ;
+	// starting table index of each relevant function, given the context
+	int i, k, nF = _RelevantFunctions.size(), n = _OutputFunctionScopeDomains.size() ;
+	for (i = 0 ; i < nF ; i++) {
+		size_t idx = 0 ;
+		for (const std::pair<int,size_t> & cs : _ContextStrides[i]) 
+			idx += assignment[cs.first] * cs.second ;
+		_idx[i] = idx ;
 		}
-	double *output_table = _OutputFunction->getTable(), z ;
+	// enumerate over all combinations of _OutputFunctionScope[] values (last variable fastest, as in the output table); 
+	// for each eliminate _v by max, combining the functions for all values of _v at once.
+	std::vector<val_t> digits(n, 0) ;
+	double *output_table = _OutputFunction->getTable(), *z = _z.data() ;
 	for (size_t j = 0 ; j < _OutputFunctionSize ; j++) {
-		// move to next combination of output fn scope value combination
-		for (i = n - 1 ; i >= 0 ; i--) {
-			if (++(*(_idxOutputFunctionScopeMapping[i])) < _OutputFunctionScopeDomains[i]) break ;
-			*(_idxOutputFunctionScopeMapping[i]) = 0 ;
+		for (k = 0 ; k < _k ; k++) 
+			z[k] = ELEM_ONE ;
+		for (i = nF - 1 ; i >= 0 ; i--) {
+			const double *t = _RelevantFunctions[i]->getTable() + _idx[i] ;
+			size_t stride = _vStrides[i] ;
+			for (k = 0 ; k < _k ; k++) 
+				z[k] OP_TIMESEQ t[k * stride] ;
 			}
-		output_table[j] = ELEM_ZERO ;
-		// eliminate var of this node
-		for (k = 0 ; k < _k ; k++) {
-			assignment[_v] = k ;
-			z = ELEM_ONE ;
-			for (i = _RelevantFunctions.size()-1 ; i >= 0 ; i--) 
-				z OP_TIMESEQ _RelevantFunctions[i]->getValuePtr(_idxVarMapping[i]) ;
-			if (z > output_table[j]) output_table[j] = z ;
+		double m = ELEM_ZERO ;
+		for (k = 0 ; k < _k ; k++) 
+			if (z[k] > m) m = z[k] ;
+		output_table[j] = m ;
+		// move to next combination of output fn scope value combination
+		for (int d = n - 1 ; d >= 0 ; d--) {
+			const size_t *strides = &_OFStrides[d * nF] ;
+			if (++digits[d] < _OutputFunctionScopeDomains[d]) {
+				for (i = 0 ; i < nF ; i++) _idx[i] += strides[i] ;
+				break ;
+				}
+			digits[d] = 0 ;
+			for (i = 0 ; i < nF ; i++) _idx[i] -= (_OutputFunctionScopeDomains[d] - 1) * strides[i] ;
 			}
 		}
+	if (MemoEnabled()) 
+		MemoStore() ;
 	return 0 ;
 }
 
@@ -285,6 +367,15 @@ int daoopt::MBLHSubtree::ComputeOutputFnIndependence(std::set<int> & Instantiate
 			}
 		if (0 == n->_nVarsInstantiated) 
 			_nSubtreeNodesIndependentOfContext++ ;
+		// memo context : instantiated variables of this node and (since children are processed first) of its descendants
+		std::set<int> memo_context ;
+		for (set<int>::const_iterator itI = node_vars.begin() ; itI != node_vars.end() ; ++itI) {
+			if (InstantiatedVariables.find(*itI) != InstantiatedVariables.end()) 
+				memo_context.insert(*itI) ;
+			}
+		for (MBLHSubtreeNode *child : n->_Children) 
+			memo_context.insert(child->_MemoContext.begin(), child->_MemoContext.end()) ;
+		n->_MemoContext.assign(memo_context.begin(), memo_context.end()) ;
 		}
 	// test : if a node has no instantiated variables, all children also must have instantiated variables
 	for (vector<MBLHSubtreeNode *>::iterator itRB = _SubtreeNodes.begin(); itRB!=_SubtreeNodes.end(); ++itRB) {
@@ -609,6 +700,10 @@ int daoopt::MBLHSubtree::Initialize(MiniBucketElimLH & H, int v, int depth, int
 	if (0 != FillInRootNodeRelevantFunctions()) 
 		return 1 ;
 
+	// table strides of the root node functions, for GetHeuristicAll()
+	if (0 != _RootNode.ComputeStrides()) 
+		return 1 ;
+
 	return 0 ;
 }
 
@@ -624,10 +719,27 @@ void daoopt::MBLHSubtree::ComputeHeuristic(std::vector<val_t> & assignment)
 	if (NULL == _IsCopyOfEarlierSubtree) {
 		++_RootNode._nTimesComputed ;
 
-		// compute output functions of all nodes, back-to-front; since _SubtreeNodes[] is in order where u<v means v is a descendant of u, this is ok.
+		// look up memoized output functions, front-to-back; if a node's output function is found, its descendants 
+		// need not be computed, unless descendant LH subtrees that are copies of part of this one need them.
+		bool memoSkipsDescendants = ! FLAGS_lookahead_reuse_identical_subtrees ;
+		for (int i = 0 ; i < _SubtreeNodes.size() ; i++) {
+			MBLHSubtreeNode *n = _SubtreeNodes[i] ;
+			MBLHSubtreeNode *p = n->_Parent ;
+			n->_MemoStatus = 0 ;
+			if (memoSkipsDescendants && p != &_RootNode && p->_MemoStatus > 0) {
+				n->_MemoStatus = 2 ;
+				n->_IsValidForCurrentContext = false ;
+				++(_H->_Stats._LHMemoSkipped) ;
+				}
+			else if (n->MemoEnabled() && 0 != n->_nVarsInstantiated && n->MemoLookup(assignment)) 
+				n->_MemoStatus = 1 ;
+			}
+
+		// compute output functions of all other nodes, back-to-front; since _SubtreeNodes[] is in order where u<v means v is a descendant of u, this is ok.
 		for (int i = _SubtreeNodes.size() - 1 ; i >= 0 ; i--) {
 			MBLHSubtreeNode *n = _SubtreeNodes[i] ;
-			n->ComputeOutputFunction(assignment) ;
+			if (0 == n->_MemoStatus) 
+				n->ComputeOutputFunction(assignment, false) ;
     }
   } 
 }
@@ -693,6 +805,41 @@ double daoopt::MBLHSubtree::GetHeuristic(std::vector<val_t> & assignment)
 	return h ;
 }
 
+void daoopt::MBLHSubtree::GetHeuristicAll(std::vector<val_t> & assignment, std::vector<double> & out)
+{
+	int k, K = _RootNode._k ;
+	if (0 == _SubtreeNodes.size()) {
+		val_t old_value = assignment[_RootVar] ;
+		for (k = 0 ; k < K ; k++) 
+			{ assignment[_RootVar] = k ; out[k] = GetHeuristic(assignment) ; }
+		assignment[_RootVar] = old_value ;
+		return ;
+		}
+#ifdef IGNORE_COPY_SUBTREE
+	if (NULL != _IsCopyOfEarlierSubtree) {
+		val_t old_value = assignment[_RootVar] ;
+		for (k = 0 ; k < K ; k++) 
+			{ assignment[_RootVar] = k ; out[k] = GetHeuristic(assignment) ; }
+		assignment[_RootVar] = old_value ;
+		return ;
+		}
+#endif // IGNORE_COPY_SUBTREE
+
+	// same as GetHeuristic(), walking each table along the root variable's stride
+	for (k = 0 ; k < K ; k++) 
+		out[k] = ELEM_ONE ;
+	int nF = _RootNode._RelevantFunctions.size() ;
+	for (int i = 0 ; i < nF ; i++) {
+		size_t idx = 0 ;
+		for (const std::pair<int,size_t> & cs : _RootNode._ContextStrides[i]) 
+			idx += assignment[cs.first] * cs.second ;
+		const double *t = _RootNode._RelevantFunctions[i]->getTable() + idx ;
+		size_t stride = _RootNode._vStrides[i] ;
+		for (k = 0 ; k < K ; k++) 
+			out[k] OP_TIMESEQ t[k * stride] ;
+		}
+}
+
 int daoopt::SetupLookaheadStructure(daoopt::MiniBucketElimLH & H, int Depth, int SizeLimit)
 {
 	daoopt::Problem *problem = H.getProblem() ;
@@ -26,6 +26,8 @@
 
 #include "MiniBucketElim.h"
 
+#include <unordered_map>
+
 #undef DEBUG
 
 #ifndef OUR_OWN_nInfinity
@@ -66,10 +68,15 @@ public :
 	// for rootnode, we don't have 1) and instead have 
 	// 4) MB-generated functions that don't contain this var and come from outside (below) the subtree that this node is part of (so called m_intermediate[thisvar] function in the language of daoopt library).
 	std::vector<Function *> _RelevantFunctions ;
-	// helper data used when OutputFunction is computed :
-	bool _idxVarMappingComputed ;
-	std::vector<std::vector<val_t*>> _idxVarMapping ; // for each _RelevantFunctions[i], mapping to ptr2value for each argument. mapping is wrt "std::vector<val_t> & assignment" used during search.
-	std::vector<val_t*> _idxOutputFunctionScopeMapping ; // ptr2value for all output function arguments
+	// helper data used when OutputFunction is computed; the tables of _RelevantFunctions are walked by strides, 
+	// along the output function table and, for each of its entries, along the domain of _v (for the root node, 
+	// which has no output function, along the domain of _v only; see MBLHSubtree::GetHeuristicAll()) :
+	bool _StridesComputed ;
+	std::vector<size_t> _vStrides ; // for each _RelevantFunctions[i], stride of _v in its table (0 if not in its scope)
+	std::vector<size_t> _OFStrides ; // [j*_RelevantFunctions.size()+i] is the stride of output fn scope variable j in the table of _RelevantFunctions[i]
+	std::vector<std::vector<std::pair<int,size_t>>> _ContextStrides ; // for each _RelevantFunctions[i], its instantiated variables and their strides
+	std::vector<size_t> _idx ; // current index into the table of each _RelevantFunctions[i]
+	std::vector<double> _z ; // combined value for each value of _v
 	// output function scope; ordered so that if u and v are in the scope, and u is before v, u is an ancestor of v.
 	std::set<int> _OutputFunctionScope ;
 	// output function scope domain sizes
@@ -88,6 +95,19 @@ public :
   // context
   bool _IsValidForCurrentContext;
 
+	// memo of output function tables, keyed by the values of _MemoContext; bounded to _MemoCapacity tables, 
+	// replaced first-in-first-out. see MiniBucketElimLH::SetupLookaheadMemo().
+	// instantiated variables (ancestors of the root variable) the output fn depends on, through this node or its descendants.
+	std::vector<int> _MemoContext ;
+	size_t _MemoCapacity ;
+	std::unordered_map<std::string, size_t> _MemoSlots ; // context -> slot
+	std::vector<std::string> _MemoKeys ; // context of each slot
+	std::vector<double> _MemoTables ; // tables of all slots, back to back
+	size_t _MemoNext ; // next slot to replace
+	std::string _MemoKey ; // context of the last lookup
+	// output function was taken from the memo (1), or left stale because an ancestor was (2), for the current context.
+	int _MemoStatus ;
+
 public :
 	// signature is a set of IDs of all nodes in the subtree rooted at this node, separated by ';'. 
 	// note we will not clear/erase the input Signature array, so that it can be used in recursive calls.
@@ -112,14 +132,22 @@ public :
 			}
 		return 0 ;
 	}
-	int ComputeOutputFunction(std::vector<val_t> & assignment) ;
-	int ComputeidxVarMapping(std::vector<val_t> & assignment) ;
+	// computes the output function for the current context; if Lookup, tries the memo first.
+	int ComputeOutputFunction(std::vector<val_t> & assignment, bool Lookup = true) ;
+	// set up the memo for up to Capacity tables; 0 disables it.
+	int PrepMemo(size_t Capacity) ;
+	inline bool MemoEnabled(void) const { return _MemoCapacity > 0 ; }
+	// if the output function of the current context is in the memo, copy it to _OutputFunction and return true.
+	bool MemoLookup(std::vector<val_t> & assignment) ;
+	// store the output function under the context of the last MemoLookup().
+	void MemoStore(void) ;
+	int ComputeStrides(void) ;
 	int PrepOutputFunction(std::set<int> & InstantiatedVariables) ;
 	// return true iff the given function was generated by a minibucket in a node (bucket) in a subtree rooted at this node.
 	bool IsSubtreeMBEfunction(Function & f, std::stack<MBLHSubtreeNode *> & dfsHelper) ;
 	int Delete(void) ;
 
-	inline MBLHSubtreeNode(void) : _H(NULL), _RootVar(-1), _v(-1), _Parent(NULL), _idxWRTparent(-1), _k(-1), _depth2go(-1), _OutputFunctionSize(-1), _OutputFunction(NULL), _idxVarMappingComputed(false), _nTimesComputed(0), _nVarsInstantiated(-1), _IsValidForCurrentContext(false)
+	inline MBLHSubtreeNode(void) : _H(NULL), _RootVar(-1), _v(-1), _Parent(NULL), _idxWRTparent(-1), _k(-1), _depth2go(-1), _OutputFunctionSize(-1), _OutputFunction(NULL), _StridesComputed(false), _nTimesComputed(0), _nVarsInstantiated(-1), _IsValidForCurrentContext(false), _MemoCapacity(0), _MemoNext(0), _MemoStatus(0)
 	{
 	}
 	inline ~MBLHSubtreeNode(void)
@@ -192,6 +220,8 @@ public :
       MBLHSubtreeNode* sub_root);
 	// get look-ahead heuristic for the given variable assignment, wrt root variable's subtree.
 	double GetHeuristic(std::vector<val_t> & assignment) ;
+	// same, for all values of the root variable at once (out[k] for value k).
+	void GetHeuristicAll(std::vector<val_t> & assignment, std::vector<double> & out) ;
 public :
 	// fill in RelevantFunctions array
 	int FillInSubtreeNodeRelevantFunctions(void) ;
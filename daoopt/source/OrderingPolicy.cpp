@@ -0,0 +1,265 @@
+/*
+ * OrderingPolicy.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OrderingPolicy.h"
+
+#include "Problem.h"
+#include "SearchNode.h"
+
+namespace daoopt {
+
+/* ================ OrderingStats ================ */
+
+void OrderingStats::init(const Problem* p) {
+  int n = p->getN();
+  m_offset.resize(n);
+  size_t vals = 0;
+  for (int var = 0; var < n; ++var) {
+    m_offset[var] = vals;
+    vals += p->getDomainSize(var);
+  }
+  m_numProcessed.assign(vals, 0);
+  m_numIncumbent.assign(vals, 0);
+  m_gapSum.assign(vals, 0.0);
+  m_gapCount.assign(vals, 0);
+  m_numOR.assign(n, 0);
+  m_numORPruned.assign(n, 0);
+  m_numSolutions = 0;
+}
+
+
+void OrderingStats::recordPruningCheck(const SearchNode* n, bool pruned) {
+  int var = n->getVar();
+  if (n->getType() == NODE_OR) {
+    ++m_numOR[var];
+    if (pruned)
+      ++m_numORPruned[var];
+    return;
+  }
+  double gap = n->getPruningGap();
+  if (gap == DBL_MAX || ISNAN(gap) || std::isinf(gap))
+    return;  // no comparison took place
+  size_t i = m_offset[var] + n->getVal();
+  m_gapSum[i] += gap;
+  ++m_gapCount[i];
+}
+
+
+void OrderingStats::recordIncumbent(const SearchNode* n) {
+  ++m_numSolutions;
+  for (; n; n = n->getParent()) {
+    if (n->getType() == NODE_AND && n->getDepth() >= 0)
+      ++m_numIncumbent[m_offset[n->getVar()] + n->getVal()];
+  }
+}
+
+
+double OrderingStats::getIncumbentRate(int var, val_t val) const {
+  size_t i = m_offset[var] + val;
+  return (m_numIncumbent[i] + 1.0) / (m_numProcessed[i] + 2.0);
+}
+
+
+double OrderingStats::getAvgGap(int var, val_t val) const {
+  size_t i = m_offset[var] + val;
+  if (m_gapCount[i] == 0)
+    return ELEM_NAN;
+  return m_gapSum[i] / m_gapCount[i];
+}
+
+
+double OrderingStats::getPruneRate(int var) const {
+  return (m_numORPruned[var] + 1.0) / (m_numOR[var] + 2.0);
+}
+
+
+/* ================ value orderings ================ */
+
+/* plain heuristic value, the original behavior */
+class HeurValueOrdering : public ValueOrdering {
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    sort(chi.begin(), chi.end(), SearchNode::heurLess);
+  }
+  string getName() const { return "heur"; }
+  HeurValueOrdering(const OrderingStats* s) : ValueOrdering(s) {}
+};
+
+
+/* the heuristic's dedicated ordering values (if provided), ties broken by
+ * the heuristic value */
+class OrderingHeurValueOrdering : public ValueOrdering {
+  struct Less {
+    bool operator()(const SearchNode* a, const SearchNode* b) const {
+      if (a->getOrderingHeur() != b->getOrderingHeur())
+        return a->getOrderingHeur() < b->getOrderingHeur();
+      return a->getHeur() < b->getHeur();
+    }
+  };
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    sort(chi.begin(), chi.end(), Less());
+  }
+  string getName() const { return "ordering_heur"; }
+  OrderingHeurValueOrdering(const OrderingStats* s) : ValueOrdering(s) {}
+};
+
+
+/* heuristic value discounted by the empirical rate at which the value
+ * produced new incumbents */
+class IncumbentValueOrdering : public ValueOrdering {
+  struct Less {
+    const OrderingStats* stats;
+    double key(const SearchNode* n) const {
+      return n->getHeur() OP_TIMES
+          ELEM_ENCODE(stats->getIncumbentRate(n->getVar(), n->getVal()));
+    }
+    bool operator()(const SearchNode* a, const SearchNode* b) const {
+      return key(a) < key(b);
+    }
+  };
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    Less less = { m_stats };
+    sort(chi.begin(), chi.end(), less);
+  }
+  string getName() const { return "incumbent"; }
+  IncumbentValueOrdering(const OrderingStats* s) : ValueOrdering(s) {}
+};
+
+
+/* values whose nodes were historically furthest from being pruned first;
+ * values without history come first, ties broken by the heuristic value */
+class GapValueOrdering : public ValueOrdering {
+  struct Less {
+    const OrderingStats* stats;
+    double key(const SearchNode* n) const {
+      double g = stats->getAvgGap(n->getVar(), n->getVal());
+      return ISNAN(g) ? DBL_MAX : g;
+    }
+    bool operator()(const SearchNode* a, const SearchNode* b) const {
+      double ka = key(a), kb = key(b);
+      if (ka != kb)
+        return ka < kb;
+      return a->getHeur() < b->getHeur();
+    }
+  };
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    Less less = { m_stats };
+    sort(chi.begin(), chi.end(), less);
+  }
+  string getName() const { return "gap"; }
+  GapValueOrdering(const OrderingStats* s) : ValueOrdering(s) {}
+};
+
+
+ValueOrdering* ValueOrdering::create(const string& name,
+                                     const OrderingStats* stats) {
+  if (name == "" || name == "heur")
+    return new HeurValueOrdering(stats);
+  else if (name == "ordering_heur")
+    return new OrderingHeurValueOrdering(stats);
+  else if (name == "incumbent")
+    return new IncumbentValueOrdering(stats);
+  else if (name == "gap")
+    return new GapValueOrdering(stats);
+  return NULL;
+}
+
+
+bool ValueOrdering::isValidName(const string& name) {
+  scoped_ptr<ValueOrdering> p(create(name, NULL));
+  return p.get() != NULL;
+}
+
+
+/* ================ subproblem orderings ================ */
+
+/* keep the pseudo tree order (width-inc/width-dec) */
+class PseudotreeSubproblemOrdering : public SubproblemOrdering {
+ public:
+  void order(const SearchNode*, vector<SearchNode*>&) const {}
+  string getName() const { return "pseudotree"; }
+  PseudotreeSubproblemOrdering(const OrderingStats* s)
+      : SubproblemOrdering(s) {}
+};
+
+
+/* by heuristic value, increasing or decreasing */
+class HeurSubproblemOrdering : public SubproblemOrdering {
+  bool m_increasing;
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    // (inverse due to stack reversal)
+    if (m_increasing)
+      sort(chi.rbegin(), chi.rend(), SearchNode::heurLess);
+    else
+      sort(chi.begin(), chi.end(), SearchNode::heurLess);
+  }
+  string getName() const { return m_increasing ? "heur-inc" : "heur-dec"; }
+  HeurSubproblemOrdering(const OrderingStats* s, bool increasing)
+      : SubproblemOrdering(s), m_increasing(increasing) {}
+};
+
+
+/* fail-first: subproblems whose OR nodes got pruned most often so far come
+ * first, ties broken by increasing heuristic value */
+class PruneFirstSubproblemOrdering : public SubproblemOrdering {
+  struct Less {
+    const OrderingStats* stats;
+    bool operator()(const SearchNode* a, const SearchNode* b) const {
+      double ra = stats->getPruneRate(a->getVar());
+      double rb = stats->getPruneRate(b->getVar());
+      if (ra != rb)
+        return ra < rb;
+      return a->getHeur() > b->getHeur();
+    }
+  };
+ public:
+  void order(const SearchNode*, vector<SearchNode*>& chi) const {
+    Less less = { m_stats };
+    sort(chi.begin(), chi.end(), less);
+  }
+  string getName() const { return "prune-first"; }
+  PruneFirstSubproblemOrdering(const OrderingStats* s)
+      : SubproblemOrdering(s) {}
+};
+
+
+SubproblemOrdering* SubproblemOrdering::create(const string& name,
+                                               const OrderingStats* stats) {
+  if (name == "pseudotree")
+    return new PseudotreeSubproblemOrdering(stats);
+  else if (name == "heur-inc")
+    return new HeurSubproblemOrdering(stats, true);
+  else if (name == "heur-dec")
+    return new HeurSubproblemOrdering(stats, false);
+  else if (name == "prune-first")
+    return new PruneFirstSubproblemOrdering(stats);
+  return NULL;
+}
+
+
+bool SubproblemOrdering::isValidName(const string& name) {
+  scoped_ptr<SubproblemOrdering> p(create(name, NULL));
+  return p.get() != NULL;
+}
+
+}  // namespace daoopt
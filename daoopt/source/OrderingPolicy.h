@@ -0,0 +1,121 @@
+/*
+ * OrderingPolicy.h
+ *
+ *  Value and subproblem ordering policies for depth-first AND/OR search,
+ *  plus the online statistics some of them learn from.
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ORDERINGPOLICY_H_
+#define ORDERINGPOLICY_H_
+
+#include "_base.h"
+
+namespace daoopt {
+
+class Problem;
+class SearchNode;
+
+/*
+ * Statistics gathered during search, per variable/value pair:
+ * - how often an AND node was processed and how often it was on the
+ *   path along which a new incumbent got propagated to the root;
+ * - the pruning gaps observed by the pruning check (how far the node's
+ *   upper bound was above the bound it was compared against).
+ * Per variable, the fraction of OR nodes that were pruned.
+ */
+class OrderingStats {
+ protected:
+  vector<size_t> m_offset;  // first entry of each variable
+  vector<count_t> m_numProcessed;
+  vector<count_t> m_numIncumbent;
+  vector<double> m_gapSum;
+  vector<count_t> m_gapCount;
+  vector<count_t> m_numOR;
+  vector<count_t> m_numORPruned;
+  count_t m_numSolutions;
+
+ public:
+  void init(const Problem* p);
+  bool isInitialized() const { return !m_offset.empty(); }
+
+  /* called for every processed AND node */
+  void recordProcessed(int var, val_t val) { ++m_numProcessed[m_offset[var] + val]; }
+  /* called after the pruning check of a node */
+  void recordPruningCheck(const SearchNode* n, bool pruned);
+  /* called with the node a new incumbent was propagated from */
+  void recordIncumbent(const SearchNode* n);
+
+  /* fraction of AND nodes (var,val) that led to an incumbent, with add-one
+   * smoothing so unseen values get 1/2 */
+  double getIncumbentRate(int var, val_t val) const;
+  /* average pruning gap of (var,val), NaN if none was observed */
+  double getAvgGap(int var, val_t val) const;
+  /* fraction of OR nodes for var that got pruned, with add-one smoothing */
+  double getPruneRate(int var) const;
+  count_t getSolutionCount() const { return m_numSolutions; }
+
+ public:
+  OrderingStats() : m_numSolutions(0) {}
+};
+
+
+/*
+ * Orders the AND children of a freshly expanded OR node. Children are pushed
+ * onto the DFS stack in the given order, so the *last* node is explored first.
+ */
+class ValueOrdering {
+ protected:
+  const OrderingStats* m_stats;
+ public:
+  virtual void order(const SearchNode* n, vector<SearchNode*>& chi) const = 0;
+  virtual string getName() const = 0;
+
+  /* creates the policy by name (heur, ordering_heur, incumbent, gap),
+   * returns NULL if the name is unknown */
+  static ValueOrdering* create(const string& name, const OrderingStats* stats);
+  static bool isValidName(const string& name);
+
+  ValueOrdering(const OrderingStats* stats) : m_stats(stats) {}
+  virtual ~ValueOrdering() {}
+};
+
+
+/*
+ * Orders the OR children of a freshly expanded AND node, i.e. independent
+ * subproblems; same convention as above, the last node is explored first.
+ */
+class SubproblemOrdering {
+ protected:
+  const OrderingStats* m_stats;
+ public:
+  virtual void order(const SearchNode* n, vector<SearchNode*>& chi) const = 0;
+  virtual string getName() const = 0;
+
+  /* creates the policy by name (pseudotree, heur-inc, heur-dec,
+   * prune-first), returns NULL if the name is unknown */
+  static SubproblemOrdering* create(const string& name,
+                                    const OrderingStats* stats);
+  static bool isValidName(const string& name);
+
+  SubproblemOrdering(const OrderingStats* stats) : m_stats(stats) {}
+  virtual ~SubproblemOrdering() {}
+};
+
+}  // namespace daoopt
+
+#endif /* ORDERINGPOLICY_H_ */
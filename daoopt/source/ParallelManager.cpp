@@ -106,11 +106,7 @@ bool ParallelManager::doLearning() {
   if (m_options->sampleRepeat == 0 || m_options->sampleSizes.empty())
     return true;
 
-#ifndef NO_ASSIGNMENT
   m_sampleSearch->updateSolution(this->getCurOptValue(), this->getCurOptTuple());
-#else
-  m_sampleSearch->updateSolution(this->getCurOptValue());
-#endif
 
   BoundPropagator prop(m_problem, m_sampleSpace.get());
 
@@ -413,9 +409,7 @@ bool ParallelManager::extSolveLocal() {
     // TODO: node and leaf profiles
 
     subprob->setValue(prob.getSolutionCost());
-#ifndef NO_ASSIGNMENT
-    subprob->setOptAssig(prob.getSolutionAssg());
-#endif
+    subprob->setSolution(prob.getSolutionAssg());
 
     oss ss;
     ss << "Solution for subproblem " << i << " (" << *subprob << ") "
@@ -604,30 +598,31 @@ bool ParallelManager::readExtResults() {
     m_space->stats.numORext += nodesOR;
     m_space->stats.numANDext += nodesAND;
 
-#ifndef NO_ASSIGNMENT
-    int32_t n;
-    BINREAD(in, n); // read length of opt. tuple
+    vector<val_t> tup;
+    if (m_options->trackAssignment) {
+      int32_t n;
+      BINREAD(in, n); // read length of opt. tuple
 
-    vector<val_t> tup(n,UNKNOWN);
+      tup.resize(n,UNKNOWN);
 
-    int32_t v; // assignment saved as int, regardless of internal type
-    for (int i=0; i<n; ++i) {
-      BINREAD(in, v); // read opt. assignments
-      tup[i] = (val_t) v;
-    }
+      int32_t v; // assignment saved as int, regardless of internal type
+      for (int i=0; i<n; ++i) {
+        BINREAD(in, v); // read opt. assignments
+        tup[i] = (val_t) v;
+      }
 
-    // Check external tuple size, but allow zero (from NaN solutions)
-    size_t subsize = m_pseudotree->getNode(node->getVar())->getSubprobSize();
-    if (tup.size() > 0 && tup.size() != subsize) {
-      oss ss;
-      ss << "Solution file " << id << " length mismatch, got " << tup.size()
-         << ", expected " << subsize << endl;
-      myprint(ss.str());
-      node->setErrExt();  // to suppress CSV output
-      success = false;
-      continue;
+      // Check external tuple size, but allow zero (from NaN solutions)
+      size_t subsize = m_pseudotree->getNode(node->getVar())->getSubprobSize();
+      if (tup.size() > 0 && tup.size() != subsize) {
+        oss ss;
+        ss << "Solution file " << id << " length mismatch, got " << tup.size()
+           << ", expected " << subsize << endl;
+        myprint(ss.str());
+        node->setErrExt();  // to suppress CSV output
+        success = false;
+        continue;
+      }
     }
-#endif
 
     // read node profiles
     int32_t size;
@@ -652,17 +647,13 @@ bool ParallelManager::readExtResults() {
     nodecounts.push_back(make_pair(nodesOR, nodesAND));
     // Write subproblem solution value and tuple into search node
     node->setValue(optCost);
-#ifndef NO_ASSIGNMENT
-    node->setOptAssig(tup);
-#endif
+    node->setSolution(tup);
 
     ostringstream ss;
     ss  << "Solution file " << id << " read (" << *node
         << ") " << nodesOR << " / " << nodesAND
         << " v:" << node->getValue();
-#ifndef NO_ASSIGNMENT
-    DIAG(ss << " -assignment " << node->getOptAssig());
-#endif
+    DIAG(ss << " -assignment " << tup);
     ss << endl;
     myprint(ss.str());
 
@@ -919,7 +910,10 @@ string ParallelManager::encodeJobs(const vector<SearchNode*>& nodes) const {
     << " -j " << m_options->cbound_worker
     << " -c " << solutionFile
     << " -r " << m_options->subprobOrder
-    << " -t 0" << endl;
+    << " -t 0";
+  if (m_options->trackAssignment)
+    job << " -track_assignment";
+  job << endl;
 
   job << "queue " << m_subprobCount << endl;
   return job.str();
@@ -1233,6 +1227,8 @@ ParallelManager::ParallelManager(Problem* prob, Pseudotree* pt, SearchSpace* spa
 #endif
 
   m_options = space->options;
+  // the frontier is processed breadth-first
+  m_incrementalPruning = false;
 
   SearchNode* first = this->initSearch();
   assert(first);
@@ -0,0 +1,277 @@
+/*
+ * Portfolio.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Portfolio.h"
+
+#include "Main.h"
+#include "BFSearchSpace.h"
+#include "BranchAndBound.h"
+#include "BranchAndBoundRotate.h"
+
+#include <chrono>
+using namespace std::chrono;
+
+namespace daoopt {
+
+extern high_resolution_clock::time_point _time_start;  // from Main.cpp
+
+Portfolio::Portfolio(Problem* p) :
+    m_problem(p), m_stop(false), m_winner(NONE), m_provedByBound(false) {
+  assert(p);
+}
+
+
+bool Portfolio::parse(const string& spec, const ProgramOptions& base,
+                      vector<pair<string, ProgramOptions> >* configs) {
+  assert(configs);
+  istringstream confs(spec);
+  string conf;
+  while (getline(confs, conf, ';')) {
+    if (conf.empty())
+      continue;
+    ProgramOptions po(base);
+    istringstream pairs(conf);
+    string kv;
+    while (getline(pairs, kv, ',')) {
+      size_t eq = kv.find('=');
+      if (eq == string::npos) {
+        cerr << "Portfolio: missing value in '" << kv << "'" << endl;
+        return false;
+      }
+      string key = kv.substr(0, eq), val = kv.substr(eq + 1);
+      if (key == "i" || key == "ibound") {
+        po.ibound = atoi(val.c_str());
+      } else if (key == "algorithm") {
+        if (val != "aobb" && val != "aobf" && val != "aaobf") {
+          cerr << "Portfolio: unknown algorithm '" << val << "'" << endl;
+          return false;
+        }
+        po.algorithm = val;
+      } else if (key == "rotate") {
+        po.rotate = (atoi(val.c_str()) != 0);
+      } else if (key == "rotate_limit") {
+        po.rotateLimit = atoi(val.c_str());
+      } else if (key == "value_order") {
+        if (!ValueOrdering::isValidName(val)) {
+          cerr << "Portfolio: unknown value ordering '" << val << "'" << endl;
+          return false;
+        }
+        po.valueOrdering = val;
+      } else if (key == "suborder_policy") {
+        if (!SubproblemOrdering::isValidName(val)) {
+          cerr << "Portfolio: unknown subproblem ordering '" << val << "'"
+               << endl;
+          return false;
+        }
+        po.subprobOrdering = val;
+      } else {
+        cerr << "Portfolio: unknown key '" << key << "'" << endl;
+        return false;
+      }
+    }
+    // the problem is shared, no reparameterization or heuristic files
+    po.mplp = po.mplps = 0;
+    po.jglp = po.jglps = 0;
+    po.fglpMBEHeur = false;
+    po.in_minibucketFile.clear();
+    configs->push_back(make_pair(conf, po));
+  }
+  return true;
+}
+
+
+void Portfolio::addMain(Search* search, Heuristic* heuristic,
+                        SearchSpace* space) {
+  Member* m = new Member;
+  m->spec = "main";
+  m->search = search;
+  m->heuristic = heuristic;
+  m->space = space;
+  m->ok = true;
+  m->ub = heuristic->getGlobalUB();
+  m_members.push_back(std::unique_ptr<Member>(m));
+}
+
+
+void Portfolio::addMember(const string& spec, const ProgramOptions& options,
+                          const Pseudotree* pt) {
+  Member* m = new Member;
+  m->spec = spec;
+  m->options.reset(new ProgramOptions(options));
+  m->pseudotree.reset(new Pseudotree(*pt));
+  m->pseudotree->resetFunctionInfo(m_problem->getFunctions());
+  m_members.push_back(std::unique_ptr<Member>(m));
+}
+
+
+bool Portfolio::buildMember(Member* m) {
+  ProgramOptions* po = m->options.get();
+  Pseudotree* pt = m->pseudotree.get();
+  int n = pt->getN();
+
+  if (po->algorithm == "aobb") {
+    m->ownSpace.reset(new SearchSpace(pt, po));
+  } else {
+    m->ownSpace.reset(new BFSearchSpace(pt, po, m_problem->getN()));
+  }
+  m->space = m->ownSpace.get();
+  m->space->stats.numORVar.resize(n, 0);
+  m->space->stats.numANDVar.resize(n, 0);
+  m->space->stats.numProcORVar.resize(n, 0);
+  m->space->stats.numProcANDVar.resize(n, 0);
+
+  po->ibound = min(po->ibound, pt->getWidthCond());
+  m->ownHeuristic.reset(Main::newHeuristic(m_problem, pt, po));
+  m->heuristic = m->ownHeuristic.get();
+  m->ownProp.reset(new BoundPropagator(m_problem, m->space, !po->nocaching));
+
+  BoundPropagator* prop = m->ownProp.get();
+  if (po->algorithm == "aobb") {
+    if (po->rotate)
+      m->ownSearch.reset(new BranchAndBoundRotate(
+          m_problem, pt, m->space, m->heuristic, prop, po));
+    else
+      m->ownSearch.reset(new BranchAndBound(
+          m_problem, pt, m->space, m->heuristic, prop, po));
+  } else if (po->algorithm == "aobf") {
+    m->ownSearch.reset(new AOStar(
+        m_problem, pt, m->space, m->heuristic, prop, po));
+  } else {
+    m->ownSearch.reset(new AnytimeAOStar(
+        m_problem, pt, m->space, m->heuristic, prop, po));
+  }
+  m->search = m->ownSearch.get();
+
+  if (po->memlimit != NONE)
+    m->heuristic->limitSize(po->memlimit, &m->search->getAssignment());
+  m->heuristic->build(&m->search->getAssignment(), true);
+#ifndef NO_HEURISTIC
+  m->search->finalizeHeuristic();
+#endif
+  m->ub = m->heuristic->getGlobalUB();
+  return true;
+}
+
+
+void Portfolio::runMember(int i) {
+  Member* m = m_members[i].get();
+  high_resolution_clock::time_point start = high_resolution_clock::now();
+
+  if (!m->search) {
+    m->ok = buildMember(m);
+    double t = duration_cast<duration<double> >(
+        high_resolution_clock::now() - start).count();
+    oss ss;
+    ss << std::setprecision(10) << "Portfolio [" << i << "] " << m->spec
+       << ": i-bound " << m->options->ibound << ", upper bound "
+       << SCALE_LOG(m->ub) << ", heuristic built in " << t << " seconds"
+       << endl;
+    myprint(ss.str());
+    if (!m->ok)
+      return;
+    reportUpperBound(m);
+  }
+
+  m->search->setAbortFlag(&m_stop);
+  bool bestFirst = (m->space->options->algorithm != "aobb");
+  while (!m_stop) {
+    if (bestFirst) {
+      // runs to completion, checks the abort flag itself
+      m->solved = m->search->solve(0) && !m_stop;
+      break;
+    }
+    m->search->importSolution();
+    if (m->search->solve(CHECK_INTERVAL)) {
+      m->solved = true;
+      break;
+    }
+    checkOptimality();
+  }
+
+  m->time = duration_cast<duration<double> >(
+      high_resolution_clock::now() - start).count();
+  if (m->solved) {
+    int none = NONE;
+    m_winner.compare_exchange_strong(none, i);
+    m_stop = true;
+  }
+}
+
+
+void Portfolio::reportUpperBound(const Member* m) {
+  if (ISNAN(m->ub))
+    return;
+  m_problem->updateUpperBound(m->ub, &m->space->stats, false);
+  checkOptimality();
+}
+
+
+bool Portfolio::checkOptimality() {
+  double ub = m_problem->getUpperBound();
+  double lb = m_problem->getSolutionSnapshot();
+  if (ISNAN(ub) || ISNAN(lb))
+    return false;
+  if (lb >= ub || fabs(lb - ub) < 1e-10) {
+    m_provedByBound = true;
+    m_stop = true;
+    return true;
+  }
+  return false;
+}
+
+
+bool Portfolio::run() {
+  for (size_t i = 0; i < m_members.size(); ++i) {
+    if (m_members[i]->ok)
+      reportUpperBound(m_members[i].get());
+  }
+
+  vector<std::thread> threads;
+  for (size_t i = 0; i < m_members.size(); ++i)
+    threads.push_back(std::thread(&Portfolio::runMember, this, (int) i));
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  return m_winner != NONE || m_provedByBound;
+}
+
+
+void Portfolio::outputStats() const {
+  cout << "--------- Portfolio ---------" << endl;
+  for (size_t i = 0; i < m_members.size(); ++i) {
+    const Member* m = m_members[i].get();
+    cout << '[' << i << "] " << m->spec;
+    if (!m->ok) {
+      cout << ": failed" << endl;
+      continue;
+    }
+    cout << std::setprecision(10) << ": UB " << SCALE_LOG(m->ub)
+         << ", OR nodes " << m->space->stats.numExpOR
+         << ", AND nodes " << m->space->stats.numExpAND << ", "
+         << (m->solved ? "solved" : "stopped") << " after " << m->time
+         << " seconds" << endl;
+  }
+  if (m_winner != NONE)
+    cout << "Portfolio winner:   [" << m_winner << "] "
+         << m_members[m_winner]->spec << endl;
+  else if (m_provedByBound)
+    cout << "Portfolio winner:   none, incumbent matches upper bound" << endl;
+}
+
+}  // namespace daoopt
@@ -0,0 +1,126 @@
+/*
+ * Portfolio.h
+ *
+ *  Runs several search configurations (i-bound, algorithm, rotation,
+ *  orderings) in parallel threads over a single, preprocessed problem.
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PORTFOLIO_H_
+#define PORTFOLIO_H_
+
+#include "_base.h"
+
+#include "Heuristic.h"
+#include "Problem.h"
+#include "ProgramOptions.h"
+#include "Pseudotree.h"
+#include "Search.h"
+#include "SearchSpace.h"
+#include "BoundPropagator.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace daoopt {
+
+/*
+ * All members share the Problem instance (and with it the incumbent, which
+ * AOBB members pick up from the problem between node-limited solve() calls)
+ * and the elimination ordering of the main configuration. Each new member
+ * gets its own pseudo tree copy, heuristic, search space and search, and
+ * builds its heuristic in its own thread. Heuristics that reparameterize the
+ * problem (FGLP/JGLP) are only run by the main configuration, beforehand.
+ *
+ * Search stops for all members as soon as one of them solves the problem, or
+ * when the shared incumbent reaches the best heuristic upper bound of any
+ * member, which proves it optimal.
+ */
+class Portfolio {
+
+ protected:
+  /* one search configuration; the main configuration's data structures are
+   * owned by Main, hence the separate owning pointers */
+  struct Member {
+    string spec;
+    Search* search;
+    Heuristic* heuristic;
+    SearchSpace* space;
+    std::unique_ptr<ProgramOptions> options;
+    std::unique_ptr<Pseudotree> pseudotree;
+    std::unique_ptr<SearchSpace> ownSpace;
+    std::unique_ptr<Heuristic> ownHeuristic;
+    std::unique_ptr<BoundPropagator> ownProp;
+    std::unique_ptr<Search> ownSearch;
+    bool ok;      // data structures set up successfully
+    bool solved;  // search completed
+    double ub;    // heuristic upper bound
+    double time;  // seconds until the member finished
+    Member() : search(NULL), heuristic(NULL), space(NULL),
+        ok(false), solved(false), ub(ELEM_NAN), time(0) {}
+  };
+
+  Problem* m_problem;
+  vector<std::unique_ptr<Member> > m_members;
+
+  std::atomic<bool> m_stop;   // tells all members to stop
+  std::atomic<int> m_winner;  // first member to finish the problem, or NONE
+  std::atomic<bool> m_provedByBound;  // incumbent reached the upper bound
+
+  /* number of leaf nodes per solve() call between checks for other
+   * members' progress */
+  static const size_t CHECK_INTERVAL = 10000;
+
+ protected:
+  /* sets up the data structures of a new member, builds its heuristic */
+  bool buildMember(Member* m);
+  /* thread body: builds (if needed) and runs the i-th member */
+  void runMember(int i);
+  /* records a heuristic upper bound, stops the portfolio if it meets the
+   * incumbent */
+  void reportUpperBound(const Member* m);
+  /* stops the portfolio if the incumbent meets the best upper bound */
+  bool checkOptimality();
+
+ public:
+  /* parses a portfolio specification: configurations separated by ';',
+   * each a ','-separated list of key=value pairs (keys: i (or ibound),
+   * algorithm, rotate, rotate_limit, value_order, suborder_policy) that
+   * override the corresponding settings of 'base'. Returns false on error. */
+  static bool parse(const string& spec, const ProgramOptions& base,
+                    vector<std::pair<string, ProgramOptions> >* configs);
+
+  /* adds the main configuration, set up and preprocessed by Main */
+  void addMain(Search* search, Heuristic* heuristic, SearchSpace* space);
+  /* adds a new configuration, with a copy of the given pseudo tree */
+  void addMember(const string& spec, const ProgramOptions& options,
+                 const Pseudotree* pt);
+
+  /* runs all members until one solves the problem or optimality is proved,
+   * returns true in that case */
+  bool run();
+
+  /* prints one line per member */
+  void outputStats() const;
+
+  Portfolio(Problem* p);
+};
+
+}  // namespace daoopt
+
+#endif /* PORTFOLIO_H_ */
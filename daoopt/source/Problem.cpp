@@ -22,17 +22,21 @@
  */
 
 #include "Problem.h"
+#include "EventFeed.h"
 
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <mutex>
 
 /*To trim lines when reading the input file*/
 #include <boost/algorithm/string.hpp> 
 
 #include "UAI2012.h"
 
+#include "ARP/ARPall.hxx"
+
 #undef DEBUG
 
 namespace daoopt {
@@ -47,6 +51,12 @@ struct _membuf : std::streambuf {
 //
 extern string out_bound_file;
 
+/* serializes solution/bound updates, which can be reported concurrently by
+ * the search and by background SLS threads; also held while the function
+ * set is modified. Recursive since updateLowerUpperBound() calls the other
+ * update functions. */
+static std::recursive_mutex mtx_solution;
+
 void Problem::condition(const map<int,val_t> &cond) {
   assert(m_n!=UNKNOWN);
 
@@ -207,9 +217,6 @@ void Problem::removeEvidence(bool clearEvid) {
   m_domains = new_domains;
   m_n = new_n;
   m_k = new_k;
-#ifndef NO_ASSIGNMENT
-//  m_curSolution.resize(m_n,UNKNOWN);
-#endif
 
 
   // translate scopes of the new functions
@@ -231,6 +238,7 @@ void Problem::removeEvidence(bool clearEvid) {
 }
 
 void Problem::collapseFunctions() {
+    std::lock_guard<std::recursive_mutex> lk(mtx_solution);  // see updateSolution()
     // Create a map from scopes to a list of function indexs
     map<set<int>,vector<int>> mapping;
     size_t oldC = m_c;
@@ -509,9 +517,6 @@ bool Problem::parseUAI16(char* prob, size_t probN, char* evid, size_t evidN,
   in >> x; // No. of variables
   m_n = x;
   m_domains.resize(m_n,UNKNOWN);
-#ifndef NO_ASSIGNMENT
-//  m_curSolution.resize(m_n,UNKNOWN);
-#endif
   m_k = -1;
   for (int i=0; i<m_n; ++i) { // Domain sizes
     in >> x; // read into int first
@@ -759,9 +764,6 @@ assert(!evid || evidN > 0);
   in >> x; // No. of variables
   m_n = x;
   m_domains.resize(m_n,UNKNOWN);
-#ifndef NO_ASSIGNMENT
-//  m_curSolution.resize(m_n,UNKNOWN);
-#endif
   m_k = -1;
   for (int i=0; i<m_n; ++i) { // Domain sizes
     in >> x; // read into int first
@@ -941,14 +943,14 @@ void Problem::outputAndSaveSolution(const string& file, const SearchStats* nodes
   oss screen;
   screen << std::setprecision(20);
   screen << "s " << SCALE_LOG(m_curCost);
-#ifndef NO_ASSIGNMENT
   int32_t assigSize = UNKNOWN;
-  if (m_subprobOnly)
-    assigSize = (int32_t) m_curSolution.size();  // no dummy variable included
-  else
-    assigSize = (int32_t) m_nOrg;
-  screen << ' ' << assigSize;
-#endif
+  if (m_trackAssignment) {
+    if (m_subprobOnly)
+      assigSize = (int32_t) m_curSolution.size();  // no dummy variable included
+    else
+      assigSize = (int32_t) m_nOrg;
+    screen << ' ' << assigSize;
+  }
 
   if (writeFile) {
     BINWRITE(out, m_curCost); // mpe solution cost
@@ -961,19 +963,19 @@ void Problem::outputAndSaveSolution(const string& file, const SearchStats* nodes
     BINWRITE(out, countAND);
   }
 
-#ifndef NO_ASSIGNMENT
-  if (writeFile) {
-    BINWRITE(out,assigSize); // no. of variables in opt. assignment
-  }
+  if (m_trackAssignment) {
+    if (writeFile) {
+      BINWRITE(out,assigSize); // no. of variables in opt. assignment
+    }
 
-  // generate full assignment (incl. evidence) if necessary and output
-  vector<val_t> outputAssig;
-  assignmentForOutput(outputAssig);
-  BOOST_FOREACH( int32_t v, outputAssig ) {
-    screen << ' ' << v;
-    if (writeFile) BINWRITE(out, v);
+    // generate full assignment (incl. evidence) if necessary and output
+    vector<val_t> outputAssig;
+    assignmentForOutput(outputAssig);
+    BOOST_FOREACH( int32_t v, outputAssig ) {
+      screen << ' ' << v;
+      if (writeFile) BINWRITE(out, v);
+    }
   }
-#endif
 
   // output node profiles in case of subproblem processing
   if (m_subprobOnly) {
@@ -997,7 +999,6 @@ void Problem::outputAndSaveSolution(const string& file, const SearchStats* nodes
 }
 
 
-#ifndef NO_ASSIGNMENT
 void Problem::assignmentForOutput(vector<val_t>& assg) const {
   assignmentForOutput(m_curSolution, assg);
 }
@@ -1022,42 +1023,57 @@ void Problem::assignmentForOutput(const vector<val_t>& inAssg, vector<val_t>& ou
     }
   }
 }
-#endif
 
 
 void Problem::updateSolution(double cost,
-#ifndef NO_ASSIGNMENT
+    const SearchStats* nodestats,
+    bool output) {
+  recordSolution(cost, NULL, nodestats, output);
+}
+
+void Problem::updateSolution(double cost,
     const vector<val_t>& sol,
-#endif
+    const SearchStats* nodestats,
+    bool output) {
+  recordSolution(cost, m_trackAssignment ? &sol : NULL, nodestats, output);
+}
+
+void Problem::recordSolution(double cost,
+    const vector<val_t>* solPtr,
     const SearchStats* nodestats,
     bool output) {
 
   if (ISNAN(cost))
     return;
 
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
   double costCheck = ELEM_ZERO;
-#ifndef NO_ASSIGNMENT
-  // check for complete assignment first
-  for (size_t i = 0; i < sol.size(); ++i) {
-    if (sol[i] == NONE) {
-      oss ss;
-      ss << std::setprecision(20);
-      ss << "Warning: skipping incomplete solution, reported " << cost;
-      DIAG(ss << " " << sol.size() << " " << sol;)
-      ss << endl; myprint(ss.str());
-      return;
-    }
-    if (!m_subprobOnly && sol[i] >= m_domains[i]) {
-      oss ss; ss << "Warning: value " << (int)sol[i] << " outside of variable " << i
-                 << " domain " << (int)m_domains[i];
-      ss << endl; myprint(ss.str());
-      return;
+  // without an assignment, only the cost can be recorded
+  static const vector<val_t> noSolution;
+  const vector<val_t>& sol = solPtr ? *solPtr : noSolution;
+  if (solPtr) {
+    // check for complete assignment first
+    for (size_t i = 0; i < sol.size(); ++i) {
+      if (sol[i] == NONE) {
+        oss ss;
+        ss << std::setprecision(20);
+        ss << "Warning: skipping incomplete solution, reported " << cost;
+        DIAG(ss << " " << sol.size() << " " << sol;)
+        ss << endl; myprint(ss.str());
+        return;
+      }
+      if (!m_subprobOnly && sol[i] >= m_domains[i]) {
+        oss ss; ss << "Warning: value " << (int)sol[i] << " outside of variable " << i
+                   << " domain " << (int)m_domains[i];
+        ss << endl; myprint(ss.str());
+        return;
+      }
     }
   }
 
   // use Kahan summation to compute exact solution cost
   // TODO (might not work in non-log scale?)
-  if (cost != ELEM_ZERO && !m_subprobOnly) {
+  if (solPtr && !sol.empty() && cost != ELEM_ZERO && !m_subprobOnly) {
     costCheck = ELEM_ONE; double comp = ELEM_ONE;  // used across loop iterations
     double y, z;  // reset for each loop iteration
     for (Function* f : m_functions) {
@@ -1075,7 +1091,6 @@ void Problem::updateSolution(double cost,
       myprint(ss.str());
     }
   } else
-#endif
   costCheck = cost;
 
 //  if (ISNAN(costCheck) || (!ISNAN(m_curCost) && costCheck <= m_curCost)) { // TODO costCheck =?= ELEM_ZERO )
@@ -1085,19 +1100,20 @@ void Problem::updateSolution(double cost,
     ss << std::setprecision(20);
     ss << "Warning: Discarding solution with cost " << costCheck
       << ", reported: " << cost;
-#ifndef NO_ASSIGNMENT
-    DIAG(ss << " " << sol.size() << " " << sol;)
-    vector<val_t> outputAssg;
-    assignmentForOutput(sol, outputAssg);
-    ss << ' ' << outputAssg.size();
-    BOOST_FOREACH( int v, outputAssg ) {
-      ss << ' ' << v;
+    if (solPtr) {
+      DIAG(ss << " " << sol.size() << " " << sol;)
+      vector<val_t> outputAssg;
+      assignmentForOutput(sol, outputAssg);
+      ss << ' ' << outputAssg.size();
+      BOOST_FOREACH( int v, outputAssg ) {
+        ss << ' ' << v;
+      }
     }
-#endif
     ss << endl; myprint(ss.str());
     return;
   }
   m_curCost = costCheck;
+  m_costSnapshot.store(m_curCost, std::memory_order_release);
   if (costCheck == ELEM_ZERO) output = false;
   ostringstream ss;
   ss << std::setprecision(20);
@@ -1110,12 +1126,15 @@ void Problem::updateSolution(double cost,
     ss << SCALE_LOG(costCheck) ;
   }
 
-#ifndef NO_ASSIGNMENT
   // save only the reduced solution
   // NOTE: sol.size() < m_nOrg in conditioned subproblem case
-  m_curSolution = sol;
+  if (solPtr)
+    m_curSolution = sol;
+  else
+    m_curSolution.clear();  // a value without assignment
+  postEvent(EVENT_SOLUTION, nodestats);
   // output the complete assignment (incl. evidence)
-  if (output) {
+  if (output && solPtr) {
     vector<val_t> outputAssg;
     assignmentForOutput(outputAssg);
     ss << ' ' << outputAssg.size();
@@ -1133,7 +1152,6 @@ void Problem::updateSolution(double cost,
     }
 
   }
-#endif
 
   if (output) {
     ss << endl;
@@ -1142,11 +1160,29 @@ void Problem::updateSolution(double cost,
 }
 
 
+void Problem::postEvent(char type, const SearchStats* nodestats) const {
+  if (!m_eventFeed)
+    return;
+  vector<val_t> outputAssg;
+  if (m_eventFeed->wantsAssignment())
+    assignmentForOutput(outputAssg);
+  m_eventFeed->post(type, SCALE_LOG(m_curCost), SCALE_LOG(m_curUpperBound),
+                    nodestats, outputAssg.empty() ? NULL : &outputAssg);
+}
+
+
 void Problem::resetSolution() {
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
   m_curCost = ELEM_NAN;
-#ifndef NO_ASSIGNMENT
+  m_costSnapshot.store(m_curCost, std::memory_order_release);
   m_curSolution.clear();
-#endif
+}
+
+double Problem::getSolutionSnapshot(vector<val_t>* tuple) const {
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
+  if (tuple)
+    *tuple = m_curSolution;
+  return m_curCost;
 }
 
 void Problem::updateUpperBound(double bound, const SearchStats* nodestats,
@@ -1154,8 +1190,10 @@ void Problem::updateUpperBound(double bound, const SearchStats* nodestats,
   if (std::isnan(bound)) {
     return;
   }
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
   if (bound < m_curUpperBound || std::isnan(m_curUpperBound)) {
     m_curUpperBound = bound;
+    postEvent(EVENT_BOUND, nodestats);
     if (output) {
       oss ss;
       ss << std::setprecision(20);
@@ -1173,10 +1211,13 @@ void Problem::updateUpperBound(double bound, const SearchStats* nodestats,
 
 void Problem::updateLowerUpperBound(double cost, double bound,
                                     const SearchStats* nodestats, bool output) {
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
   double old_cost = m_curCost;
   double old_bound = m_curUpperBound;
   updateUpperBound(bound, nodestats, false);
-  updateSolution(cost, nodestats, false);
+  // (the cost may come without assignment, record it only if it improves)
+  if (ISNAN(old_cost) || cost > old_cost)
+    updateSolution(cost, nodestats, false);
   bool cost_changed = m_curCost != old_cost;
   bool bound_changed = m_curUpperBound != old_bound;
   if (output) {
@@ -1246,14 +1287,110 @@ void Problem::writeUAI(const string& prob) const {
 }
 
 
+bool Problem::toARP(ARE::ARP& arp) const {
+  vector<int32_t> K(m_domains.begin(), m_domains.end());
+  vector<int32_t> arity;
+  vector<vector<int32_t> > scopes;
+  vector<const int32_t*> scopePtrs;
+  vector<const double*> tables;
+  arity.reserve(m_functions.size());
+  scopes.reserve(m_functions.size());
+  for (const Function* f : m_functions) {
+    const vector<int>& scope = f->getScopeVec();
+    arity.push_back(scope.size());
+    scopes.push_back(vector<int32_t>(scope.begin(), scope.end()));
+    scopePtrs.push_back(scopes.back().data());
+    tables.push_back(f->getTable());  // same layout, last variable fastest
+  }
+#ifdef USE_LOG
+  bool isLog10 = true;
+#else
+  bool isLog10 = false;
+#endif
+  int32_t res = arp.LoadFromTables(m_n, K.data(), m_functions.size(),
+      arity.data(), scopePtrs.data(), tables.data(), isLog10);
+  if (0 == res)
+    res = arp.PerformPostConstructionAnalysis();
+  // max-product (or max-sum in log scale)
+  arp.SetOperators(FN_COBINATION_TYPE_PROD, VAR_ELIMINATION_TYPE_MAX);
+  if (0 != res) {
+    cerr << "Error converting problem to ARP format (" << res << ")" << endl;
+    return false;
+  }
+  return true;
+}
+
+
 void Problem::addDummy() {
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);  // see updateSolution()
   m_n += 1;
   m_hasDummy = true;
   m_domains.push_back(1); // unary domain
 }
 
 
+bool Problem::updateEvidence(const map<int,val_t>& delta,
+                             vector<int>& changed, bool& added) {
+  changed.clear();
+  added = false;
+  // validate first, so that a bad request leaves the problem unchanged
+  for (map<int,val_t>::const_iterator it = delta.begin(); it != delta.end(); ++it) {
+    if (it->first < 0 || it->first >= m_nOrg) {
+      cerr << "Evidence variable " << it->first << " out of range." << endl;
+      return false;
+    }
+    if (isEliminated(it->first)) {
+      cerr << "Evidence variable " << it->first
+           << " was removed from the problem when it was loaded." << endl;
+      return false;
+    }
+    int i = m_old2new.find(it->first)->second;
+    if (it->second != NONE && (it->second < 0 || it->second >= m_domains[i])) {
+      cerr << "Evidence value " << (int) it->second << " out of range for variable "
+           << it->first << '.' << endl;
+      return false;
+    }
+  }
+
+  // solution updates evaluate the functions, possibly from another thread
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
+  for (map<int,val_t>::const_iterator it = delta.begin(); it != delta.end(); ++it) {
+    int i = m_old2new.find(it->first)->second;
+    map<int,val_t>::iterator itE = m_dynEvidence.find(i);
+    if (it->second == NONE) {
+      if (itE == m_dynEvidence.end())
+        continue;
+      m_dynEvidence.erase(itE);
+    } else {
+      if (itE != m_dynEvidence.end() && itE->second == it->second)
+        continue;
+      m_dynEvidence[i] = it->second;
+    }
+
+    Function* f = m_evidFunctions[i];
+    if (!f) {  // create the indicator, retracted evidence keeps it around
+      int id = 0;
+      for (vector<Function*>::const_iterator itF = m_functions.begin(); itF != m_functions.end(); ++itF)
+        id = max(id, (*itF)->getId() + 1);
+      set<int> scope;
+      scope.insert(i);
+      f = new FunctionBayes(id, this, scope, new double[m_domains[i]], m_domains[i]);
+      m_functions.push_back(f);
+      m_c = m_functions.size();
+      m_evidFunctions[i] = f;
+      added = true;
+    }
+    for (val_t k = 0; k < m_domains[i]; ++k)
+      f->getTable()[k] = (it->second == NONE || it->second == k) ? ELEM_ONE : ELEM_ZERO;
+    changed.push_back(i);
+  }
+  return true;
+}
+
+
 void Problem::replaceFunctions(const vector<Function*>& newFunctions, bool asCopy) {
+  // solution updates evaluate the functions, possibly from another thread
+  std::lock_guard<std::recursive_mutex> lk(mtx_solution);
   // delete current functions
   for (vector<Function*>::iterator it = m_functions.begin();
           !m_is_copy && it!= m_functions.end(); ++it) {
@@ -1271,6 +1408,9 @@ void Problem::replaceFunctions(const vector<Function*>& newFunctions, bool asCop
   }
   m_c = m_functions.size();
   // update function scopes???
+  // (evidence indicators are now part of the new functions)
+  m_dynEvidence.clear();
+  m_evidFunctions.clear();
 }
 
 /*
@@ -1293,14 +1433,23 @@ void Problem::addEvidence(const map<int,val_t> &evid) {
 */
 
 
-#ifndef NO_ASSIGNMENT
 bool Problem::isEliminated(int i) const {
   map<int,int>::const_iterator itRen = m_old2new.find(i);
   return itRen == m_old2new.end();
 }
-#endif
 
 
+uint64 Problem::hash() const {
+  uint64 h = hashBytes(&m_domains[0], m_domains.size() * sizeof(val_t));
+  for (vector<Function*>::const_iterator it = m_functions.begin(); it != m_functions.end(); ++it) {
+    const vector<int>& scope = (*it)->getScopeVec();
+    if (!scope.empty())
+      h = hashBytes(&scope[0], scope.size() * sizeof(int), h);
+    h = hashBytes((*it)->getTable(), (*it)->getTableSize() * sizeof(double), h);
+  }
+  return h;
+}
+
 size_t Problem::getSize() const {
     size_t S = 0;
     for (const auto &f : m_functions) {
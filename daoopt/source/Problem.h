@@ -31,8 +31,15 @@
 #include "_base.h"
 #include "gzstream.h"
 
+#include <atomic>
+
+namespace ARE {
+class ARP;
+}
+
 namespace daoopt {
 
+class EventFeed;
 class SearchStats;
 
 /* holds a problem instance with variable domains and function tables */
@@ -44,6 +51,7 @@ protected:
 
   bool m_subprobOnly;    // Solving only a conditioned subproblem
   bool m_hasDummy;       // is last variable a dummy variable?
+  bool m_trackAssignment; // record (and output) solution assignments
 
   int m_prob;            // Problem class (multiplication or summation of costs)
   int m_task;            // Type of problem (Minim. or maxim. task)
@@ -60,6 +68,7 @@ protected:
   double m_globalConstant;        // Global constant modifier for objective function
 
   double m_curCost;               // Cost of current solution
+  std::atomic<double> m_costSnapshot;  // copy of m_curCost, readable without locking
   double m_curUpperBound;            // Current upper bound
 
   string m_name;                  // Problem name
@@ -72,8 +81,13 @@ protected:
 
   map<int,int> m_old2new;         // Translation of variable names after removing evidence
 
+  map<int,val_t> m_dynEvidence;      // Evidence set through updateEvidence() (new names)
+  map<int,Function*> m_evidFunctions; // Unary indicator function for each such variable
+
   vector<val_t> m_curSolution;       // Current best solution
 
+  EventFeed* m_eventFeed;            // receives solution/bound updates (not owned)
+
   unsigned int num_zero_tuples_;  // Number of zero tuples
   unsigned int num_tuples_;  // Number of tuples
   double determinism_ratio_; // ratio of above two numbers
@@ -92,6 +106,13 @@ public:
   int getR() const { return m_r; }
 
   void setSubprobOnly() { m_subprobOnly = true; }
+  /* enables recording of the optimal assignment along with its cost
+   * (-track_assignment); otherwise reported assignments are ignored */
+  void setTrackAssignment(bool b = true) { m_trackAssignment = b; }
+  bool isTrackAssignment() const { return m_trackAssignment; }
+  /* solution and bound updates are also posted to the given feed (NULL for
+   * none); copies of the problem don't report to it */
+  void setEventFeed(EventFeed* feed) { m_eventFeed = feed; }
   const string& getName() const { return m_name; }
 
   const vector<Function*>& getFunctions() const { return m_functions; }
@@ -105,6 +126,10 @@ public:
 
   size_t getSize() const;
 
+  /* hash over domains, function scopes and tables, to check that
+   * precomputed data (e.g. a heuristic file) belongs to this problem */
+  uint64 hash() const;
+
 public:
 
   /* parses a UAI format input file */
@@ -117,6 +142,10 @@ public:
   /* writes the current problem to a UAI file */
   void writeUAI(const string& prob) const;
 
+  /* copies variables (incl. the dummy), domains and functions into an ARP
+   * problem instance; tables are passed in log10 scale */
+  bool toARP(ARE::ARP& arp) const;
+
   /* parses an ordering from file 'file' and stores it in 'elim' */
   bool parseOrdering(const string& file, vector<int>& elim) const;
   bool parseOrdering(const vector<int>& input, vector<int>& elim) const;
@@ -135,27 +164,39 @@ public:
   /* note that this does not re-index the variables */
   void condition(const map<int,val_t> &cond);
 
+  /* sets evidence on variables of the original problem specification
+   * (a value of NONE retracts it) without re-indexing the problem: each
+   * such variable gets a unary indicator function, appended to the function
+   * list on first use (which sets 'added', the pseudo tree's function
+   * mapping then needs a reset). Variables whose evidence actually changed
+   * are written into 'changed' (new names); returns false on invalid input,
+   * in which case nothing is changed. */
+  bool updateEvidence(const map<int,val_t>& delta, vector<int>& changed,
+                      bool& added);
+
 
 
   /* retrieve the current optimal solution */
   double getSolutionCost() const { return m_curCost; }
+  /* the current solution cost, without locking (it may be just about to
+   * change, cf. getSolutionSnapshot()) */
+  double peekSolutionCost() const { return m_costSnapshot.load(std::memory_order_acquire); }
 
   /* retreive the current global upper bound */
   double getUpperBound() const { return m_curUpperBound; }
 
-#ifndef NO_ASSIGNMENT
-  /* retrieve the current optimal assignment */
+  /* retrieve the current optimal assignment (empty unless tracked) */
   const vector<val_t>& getSolutionAssg() const { return m_curSolution; }
   /* compute the assignment for output (might add evidence back in) */
   void assignmentForOutput(vector<val_t>&) const;
   void assignmentForOutput(const vector<val_t>& in, vector<val_t>& out) const;
-#endif
 
-  /* report an updated solution */
+  /* report an updated solution, without or with its assignment */
+  void updateSolution(double cost,
+      const SearchStats* nodestats = NULL,
+      bool output = true);
   void updateSolution(double cost,
-#ifndef NO_ASSIGNMENT
       const vector<val_t>& sol,
-#endif
       const SearchStats* nodestats = NULL,
       bool output = true);
 
@@ -172,6 +213,12 @@ public:
   /* resets current optimal solution cost and assignment */
   void resetSolution();
 
+  /* retrieves a consistent copy of the current solution cost and (if
+   * tuple != NULL) assignment; safe to call while other threads (e.g.
+   * background SLS) report solutions. The update functions above are
+   * serialized internally. */
+  double getSolutionSnapshot(vector<val_t>* tuple = NULL) const;
+
   /* outputs the solution to the screen and, if file!="", writes it to file
    * (for subproblem solving, only relevant variables will be output)
    *  - cost is the MPE tuple value
@@ -184,12 +231,18 @@ public:
                              const vector<count_t>& nodeProf, const vector<count_t>& leafProf,
                              bool toScreen = true) const;
 
-#ifndef NO_ASSIGNMENT
   /* returns true iff the index variable from the full set has been eliminated
    * as evidence or unary */
   bool isEliminated(int i) const;
-#endif
 
+protected:
+  /* implements updateSolution(), sol is NULL if there is no assignment */
+  void recordSolution(double cost, const vector<val_t>* sol,
+                      const SearchStats* nodestats, bool output);
+  /* posts the current solution and bound to the event feed, if any */
+  void postEvent(char type, const SearchStats* nodestats) const;
+
+public:
   /* adds the dummy variable to connect disconnected pseudo tree components */
   void addDummy();
 
@@ -215,6 +268,7 @@ inline Problem::Problem() :
     m_is_copy(false),
     m_subprobOnly(false),
     m_hasDummy(false),
+    m_trackAssignment(false),
     m_prob(UNKNOWN),
     m_task(UNKNOWN),
     m_n(UNKNOWN),
@@ -225,7 +279,9 @@ inline Problem::Problem() :
     m_r(UNKNOWN),
     m_globalConstant(ELEM_NAN),
     m_curCost(ELEM_NAN),
-    m_curUpperBound(ELEM_NAN)
+    m_costSnapshot(ELEM_NAN),
+    m_curUpperBound(ELEM_NAN),
+    m_eventFeed(NULL)
 { /* empty*/ }
 
 // Functions are owned by the copy of the problem
@@ -233,6 +289,7 @@ inline Problem::Problem(Problem *p) :
     m_is_copy(false),
     m_subprobOnly(p->m_subprobOnly),
     m_hasDummy(p->m_hasDummy),
+    m_trackAssignment(p->m_trackAssignment),
     m_prob(p->m_prob),
     m_task(p->m_task),
     m_n(p->m_n),
@@ -243,12 +300,14 @@ inline Problem::Problem(Problem *p) :
     m_r(p->m_r),
     m_globalConstant(p->m_globalConstant),
     m_curCost(p->m_curCost),
+    m_costSnapshot(p->m_curCost),
     m_name(p->m_name),
     m_domains(p->m_domains),
     m_evidence(p->m_evidence),
     m_old2new(p->m_old2new),
     m_curSolution(p->m_curSolution),
-    m_curUpperBound(p->m_curUpperBound)
+    m_curUpperBound(p->m_curUpperBound),
+    m_eventFeed(NULL)
 {
     for (size_t i = 0; i < p->m_functions.size(); ++i) {
         m_functions.push_back(p->m_functions[i]->clone());
@@ -25,6 +25,7 @@
 #define PROGRAMOPTIONS_H_
 
 #include "_base.h"
+#include "Semiring.h"
 
 #include <string>
 #include <iostream>
@@ -34,6 +35,7 @@ namespace daoopt {
 struct ProgramOptions {
 public:
   string algorithm; // choice of algorithm (aobb, aobf)
+  string task; // inference task (mpe, pr), see Semiring.h
   bool nosearch; // abort before starting the actual search
   bool force_compute_tables; // used with the above -- forces computation so the heuristic is built, then search is aborted.
   bool nocaching; // disable caching
@@ -44,7 +46,10 @@ public:
   bool par_preOnly; // static parallel: preprocessing only (generate subproblems)
   bool par_postOnly; // static parallel: postprocessing only (read solution files)
   bool rotate; // enables breadth-rotating AOBB
+  bool dive; // AOBB dives into each new subproblem first ("subproblem dive")
+  bool trackAssignment; // record the optimal assignment (MPE tuple), not just its value
   bool match; // uses moment matching during MBE
+  bool minibucketMmap; // minibucket file in the uncompressed layout that is mapped read-only
   int mplp;  // enables MPLP in Alex Ihler's MBE library (# iters)
   double mplps;  // enables MPLP in Alex Ihler's MBE library (# sec)
   double mplpt;  // convergence tolerance for MPLP
@@ -52,9 +57,10 @@ public:
   double jglps;  // enables JGLP tightening in Alex Ihler's MBE library (# sec)
   int jglpi;  // specifies the i-bound used for JGLP
   int ibound; // bucket elim. i-bound
+  int iboundSelect; // probes per i-bound for selecting it by predicted solve time (0: off)
   int cbound; // cache context size bound
   int cbound_worker; // cache bound for worker processes
-  int threads; // max. number of parallel subproblems
+  int threads; // no. of CVO ordering threads; max. number of parallel subproblems
   int order_iterations; // no. of randomized order finding iterations
   int order_timelimit; // no. of seconds to look for variable ordering
   int order_tolerance; // allowed range of deviation from suggested optimal minfill heuristic
@@ -66,15 +72,29 @@ public:
   int local_size; // lower bound for problem size to be solved locally (times 10^6)
   int maxSubprob; // only generate this many subproblems, then abort (for testing)
   int lds;  // run initial LDS with this limit (-1: enabled)
+  int ldsThreads; // number of concurrent LDS probes (discrepancy levels, value orders)
+  int ldsTime; // wall-clock budget for initial LDS (in seconds, -1: none)
   int seed; // the seed for the random number generator
   int rotateLimit; // how many nodes to expand per subproblem stack before rotating
+  int lazyProp; // AOBB defers value propagation, flushing after this many leaves (0: eager)
+  double weight; // initial heuristic weight of anytime weighted search (1: disabled)
+  string weightSchedule; // how the weight decreases between weighted searches
   int subprobOrder; // subproblem ordering, integers defined in _base.h
+  string eventFeed; // file, FIFO or unix:<socket> to stream solution/bound updates to
+  string eventFormat; // format of the event feed (json or binary)
+  bool eventAssignment; // include the assignments in the event feed
+  string valueOrdering; // value ordering policy for AOBB (see OrderingPolicy.h)
+  string subprobOrdering; // subproblem ordering policy, overrides subprobOrder if set
+  string portfolio; // additional search configurations to run in parallel (see Portfolio.h)
+  string serve; // answer evidence queries after preprocessing ("-": stdin, else a Unix socket path)
   int sampleDepth; // max. depth for randomness in sampler (will follow heuristic otherwise)
   int sampleScheme; // sampling scheme (TBD)
   int sampleRepeat; // how many times to repeat the sample size sequence
   int maxWidthAbort; // upper bound for induced width, abort if above this
   int slsIter; // number of SLS iterations for initial lower bound
   int slsTime; // time per SLS iteration (in seconds)
+  bool schedule; // split maxTime (and memlimit) across preprocessing and search
+  int estimateProbes; // number of probes for the search space size estimate (0: none)
   int aobbLookahead;  // max. number of nodes for parallel static AOBB subproblem lookahead
 
   /* CVO */
@@ -86,6 +106,7 @@ public:
   bool fglpHeur; // use pure FGLP heuristic
   bool fglpMBEHeur; // use FGLP/MBE hybrid heuristic
   bool fglpMBEHeurChoice; // use FGLP/MBE choice heuristic
+  bool arpMBEHeur; // compile the mini bucket heuristic with ARP's MBEworkspace
 
   bool useShiftedLabels; // use shifted labels induced by FGLP
   bool useNullaryShift; // use FGLP update that shifts maximums into a nullary function
@@ -102,15 +123,20 @@ public:
   double lookahead_LE_AllTablesTotalLimit; // as number of entries; log10.
   double lookahead_LE_IgnoreThreshold ; // if bucket error is larger than this, it will be ignored for by lookahead. default is DBL_MIN.
   bool lookahead_use_full_subtree; // perform no pruning for lookahead subtrees
+  bool lookaheadMemo; // memoize LH subtree output functions by context, within lookahead_LE_AllTablesTotalLimit
   
   /* INCREMENTAL JGLP OPTIONS */
   double jglpt; // tolerance parameter for convergence of single run of JGLP(i) 
   double jglpc; // tolerance parameter for convergence of incremental JGLP runs  
   bool incrementalJG;
+  bool jglpTiming; // report the time spent converting functions for JGLP
 
   /* Added for stopping SLS by convergence */
   double slsConvergeRate;
   int slsAlgo; //  0. default incremental GLS+ 1. GLS+ 2. Hybrid SLS
+  int slsThreads; // number of concurrent SLS runs (distinct seeds)
+  std::string slsAlgos; // comma-separated SLS algorithm per run (overrides slsAlgo)
+  bool slsBackground; // keep SLS running alongside the search
 
   /* MISC OPTIONS */
   bool collapse; // collapse functions with identical scopes onto each other
@@ -163,35 +189,40 @@ public:
 ProgramOptions* parseCommandLine(int argc, char** argv);
 
 inline ProgramOptions::ProgramOptions() 
-  : nosearch(false), nocaching(false), autoCutoff(false), autoIter(false),
+  : task(TASK_MPE), nosearch(false), nocaching(false), autoCutoff(false), autoIter(false),
     orSearch(false), par_solveLocal(false), par_preOnly(false),
-    par_postOnly(false), rotate(false), 
-    ibound(0), cbound(0), cbound_worker(0),
+    par_postOnly(false), rotate(false), dive(false), trackAssignment(false),
+    ibound(0), iboundSelect(0), cbound(0), cbound_worker(0),
     threads(0), order_iterations(0), order_timelimit(0), order_tolerance(0),
     cutoff_depth(NONE), cutoff_width(NONE),
     nodes_init(NONE), memlimit(NONE),
     cutoff_size(NONE), local_size(NONE), maxSubprob(NONE),
-    lds(NONE), seed(NONE), rotateLimit(0), subprobOrder(NONE),
+    lds(NONE), ldsThreads(1), ldsTime(NONE), seed(NONE), rotateLimit(0), lazyProp(0),
+    weight(1.0), weightSchedule("sqrt"), subprobOrder(NONE),
+    eventFormat("json"), eventAssignment(false),
     sampleDepth(NONE), sampleScheme(NONE), sampleRepeat(NONE),
     maxWidthAbort(NONE), 
-    aobbLookahead(0),
+    schedule(false), estimateProbes(0), aobbLookahead(0),
     initialBound(ELEM_NAN),
     problemSpec(NULL), problemSpec_len(0),
     evidSpec(NULL), evidSpec_len(0), varOrder(NULL),
     order_cvo(false), cvo_n_random_pick(-1), cvo_e_random_pick(0.0),
-    fglpHeur(false), fglpMBEHeur(false),
+    fglpHeur(false), fglpMBEHeur(false), arpMBEHeur(false),
     slsIter(0), slsTime(0), slsConvergeRate(2.0), slsAlgo(0),
+    slsThreads(1), slsBackground(false),
     mplp(0), mplps(0), mplpt(1e-7),
     jglp(0), jglps(0), jglpt(1e-3), jglpc(1e-5),
-    incrementalJG(false),
+    incrementalJG(false), jglpTiming(false),
     useShiftedLabels(false), useNullaryShift(false), usePriority(false),
     ndfglp(0), ndfglps(0),
     match(true),
+    minibucketMmap(false),
     collapse(false),
     perturb(0),
     lookaheadDepth(-1), lookaheadSubtreeSizeLimit(-1), nBEabsErrorToInclude(INT_MAX), lookahead_LE_SingleTableLimit(-1.0),
     lookahead_LE_AllTablesTotalLimit(-1.0),
     lookahead_LE_IgnoreThreshold(DBL_MIN), 
+    lookaheadMemo(false),
     maxTime(kint32max),
     force_compute_tables(false),
     bee_slice_sample_scope_size(-1),
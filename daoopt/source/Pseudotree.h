@@ -390,12 +390,11 @@ inline bigint PseudotreeNode::computeHWB(const vector<val_t>* assig) {
 
 /* Constructor */
 inline PseudotreeNode::PseudotreeNode(Pseudotree* t, int v, const set<int>& s) :
-#if defined PARALLEL_DYNAMIC
-  m_domain(UNKNOWN), m_var(v), m_depth(UNKNOWN), m_subHeight(UNKNOWN), m_parent(NULL), m_tree(t), m_complexity(NULL),
-  m_contextS(s), m_contextV(s.begin(), s.end()) {}
-#elif defined PARALLEL_STATIC || TRUE
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC || TRUE
   m_domain(UNKNOWN), m_var(v), m_depth(UNKNOWN), m_subHeight(UNKNOWN), m_parent(NULL), m_tree(t),
-  //m_complexity(NULL),
+#if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
+  m_complexity(NULL),
+#endif
   m_subprobStats(NULL),
   m_contextS(s),
   m_orderingHeuristic(0.0),
@@ -0,0 +1,190 @@
+/*
+ * RingBuffer.h
+ *
+ *  Bounded lock-free queue for passing pointers between the threads of the
+ *  parallel master (search, propagation, Condor submission).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include "_base.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace daoopt {
+
+/* assumed cache line size, to keep the producer and consumer positions apart */
+#define RING_CACHE_LINE 64
+
+/*
+ * Bounded queue that any number of threads may push to and pop from without
+ * locking (D. Vyukov's bounded MPMC queue). Each cell carries a sequence
+ * number that tells whether it's ready to be written (seq == pos) or read
+ * (seq == pos+1) for the enqueue/dequeue position pos, so a push or pop
+ * costs a single compare-and-swap on the respective position.
+ *
+ * The capacity is rounded up to a power of two. tryPush() fails if the
+ * buffer is full, push() yields until there is room.
+ */
+template <class T>
+class RingBuffer {
+ protected:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  size_t m_mask;
+  char m_pad0[RING_CACHE_LINE];
+  std::atomic<size_t> m_enqueuePos;
+  char m_pad1[RING_CACHE_LINE];
+  std::atomic<size_t> m_dequeuePos;
+  char m_pad2[RING_CACHE_LINE];
+
+ public:
+  bool tryPush(const T& x);
+  void push(const T& x);
+  bool tryPop(T& x);
+  /* (only a snapshot if other threads are pushing or popping) */
+  bool empty() const;
+  size_t capacity() const { return m_mask + 1; }
+
+  explicit RingBuffer(size_t capacity);
+};
+
+
+template <class T>
+RingBuffer<T>::RingBuffer(size_t capacity) : m_mask(1) {
+  while (m_mask + 1 < capacity)
+    m_mask = (m_mask << 1) | 1;
+  m_cells.reset(new Cell[m_mask + 1]);
+  for (size_t i = 0; i <= m_mask; ++i)
+    m_cells[i].seq.store(i, std::memory_order_relaxed);
+  m_enqueuePos.store(0, std::memory_order_relaxed);
+  m_dequeuePos.store(0, std::memory_order_relaxed);
+}
+
+template <class T>
+bool RingBuffer<T>::tryPush(const T& x) {
+  Cell* cell;
+  size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+    if (diff == 0) {
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+  cell->data = x;
+  cell->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+void RingBuffer<T>::push(const T& x) {
+  while (!tryPush(x))
+    std::this_thread::yield();
+}
+
+template <class T>
+bool RingBuffer<T>::tryPop(T& x) {
+  Cell* cell;
+  size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+    if (diff == 0) {
+      if (m_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;  // empty
+    } else {
+      pos = m_dequeuePos.load(std::memory_order_relaxed);
+    }
+  }
+  x = cell->data;
+  cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+bool RingBuffer<T>::empty() const {
+  size_t pos = m_dequeuePos.load(std::memory_order_acquire);
+  return m_cells[pos & m_mask].seq.load(std::memory_order_acquire) != pos + 1;
+}
+
+
+#ifdef PARALLEL_DYNAMIC
+/*
+ * Lets a thread sleep until a condition on lock-free state holds (e.g., one
+ * of its RingBuffers is non-empty). Threads that change the state call
+ * notify() afterwards, which only takes the mutex if the waiter is actually
+ * asleep -- the common case of a busy consumer costs an atomic load.
+ * (Waiting is a boost interruption point, as before.)
+ */
+class RingWaiter {
+ protected:
+  std::atomic<bool> m_sleeping;
+  boost::mutex m_mtx;
+  boost::condition_variable_any m_cond;
+
+ public:
+  template <class Pred> void wait(Pred ready);
+  void notify();
+  RingWaiter() : m_sleeping(false) {}
+};
+
+template <class Pred>
+void RingWaiter::wait(Pred ready) {
+  if (ready())
+    return;
+  GETLOCK(m_mtx, lk);
+  m_sleeping.store(true);
+  // (pairs with the fence in notify(): either the notifying thread sees
+  // m_sleeping, or its state change is visible to ready() here)
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (!ready())
+    CONDWAIT(m_cond, lk);
+  m_sleeping.store(false);
+}
+
+inline void RingWaiter::notify() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_sleeping.load()) {
+    GETLOCK(m_mtx, lk);
+    NOTIFYALL(m_cond);
+  }
+}
+#endif /* PARALLEL_DYNAMIC */
+
+}  // namespace daoopt
+
+#endif /* RINGBUFFER_H_ */
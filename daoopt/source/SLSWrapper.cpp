@@ -26,12 +26,23 @@
 
 namespace daoopt {
 
-bool SLSWrapper::init(Problem* prob, int iter, int time) {
-
+bool SLSWrapper::init(Problem* prob, int iter, int time, long seed) {
   assert(prob);
   m_problem = prob;
+  m_iter = iter;
+  m_time = time;
+  m_seed = seed;
+  m_abort = false;
+  return true;
+}
+
+
+bool SLSWrapper::loadProblem() {
+  Problem* prob = m_problem;
+  assert(prob);
 
-  sls4mpe::verbose = false;
+  // the engine state is per thread and outlives a run, start from scratch
+  sls4mpe::reset_parameters();
   sls4mpe::start_timer();
 
   sls4mpe::assignmentManager = new sls4mpe::AssignmentManager();
@@ -43,8 +54,10 @@ bool SLSWrapper::init(Problem* prob, int iter, int time) {
   sls4mpe::sls_filename[0] = '\0';
   //strncpy(sls4mpe::network_filename, filename.c_str(), filename.size());
 
-  sls4mpe::maxRuns = iter;
-  sls4mpe::maxTime = time;
+  sls4mpe::maxRuns = m_iter;
+  sls4mpe::maxTime = m_time;
+  sls4mpe::initial_seed = m_seed;
+  sls4mpe::run_abort = &m_abort;
 
   sls4mpe::preprocessingSizeBound = 0;
 
@@ -53,6 +66,7 @@ bool SLSWrapper::init(Problem* prob, int iter, int time) {
   // load network directly into SLS from Problem*
   sls4mpe::num_vars = prob->getN() - ((prob->hasDummy()) ? 1 : 0);  // -1 for dummy variable
   sls4mpe::num_pots = prob->getC();
+  m_numVars = sls4mpe::num_vars;
   sls4mpe::allocateVarsAndPTs(false);
 
   for (int i = 0; i < prob->getN() - ((prob->hasDummy()) ? 1 : 0); ++i)
@@ -82,20 +96,40 @@ bool SLSWrapper::init(Problem* prob, int iter, int time) {
 
 
 void SLSWrapper::reportSolution(double cost, int num_vars, int* assignment) {
-#ifndef NO_ASSIGNMENT
+  if (!m_problem->isTrackAssignment()) {
+    m_problem->updateSolution(cost, NULL, true);
+    return;
+  }
   cost += sls4mpe::EPS;  // EPS needed to avoid floating point precision issues
   assert(assignment);
   vector<val_t> assigVec(num_vars);
   for (int i = 0; i < num_vars; ++i)
     assigVec[i] = assignment[i];
   m_problem->updateSolution(cost, assigVec, NULL, true);
-#else
-  m_problem->updateSolution(cost, NULL, true);
-#endif
+}
+
+
+bool SLSWrapper::start() {
+  if (m_thread.joinable())
+    return false;  // already running
+  m_thread = std::thread([this]() { this->run(); });
+  return true;
+}
+
+void SLSWrapper::stop() {
+  m_abort = true;
+}
+
+void SLSWrapper::join() {
+  if (m_thread.joinable())
+    m_thread.join();
 }
 
 
 bool SLSWrapper::run() {
+  loadProblem();
+  if (m_assignment)
+    delete[] m_assignment;
   m_assignment = new int[sls4mpe::num_vars];
   sls4mpe::start_timer();
   sls4mpe::runAlgorithm(&m_assignment, &m_likelihood);
@@ -106,20 +140,21 @@ bool SLSWrapper::run() {
 double SLSWrapper::getSolution(vector<val_t>* tuple) const {
   if (tuple) {
     tuple->clear();
-    tuple->resize(sls4mpe::num_vars);
-    for (int i=0; i<sls4mpe::num_vars; ++i) {
+    tuple->resize(m_numVars);
+    for (int i=0; i<m_numVars; ++i) {
       tuple->at(i) = m_assignment[i];
     }
   }
-#ifdef NO_ASSIGNMENT
-  return m_likelihood + sls4mpe::EPS;  // EPS for floating point precision issues
-#else
+  if (!m_problem || !m_problem->isTrackAssignment())
+    return m_likelihood + sls4mpe::EPS;  // EPS for floating point precision issues
   return m_likelihood;  // no ESP needed since solution cost will be recalculated
-#endif
 }
 
 
 bool SLSWrapperInc::run() {
+	loadProblem();
+	if (m_assignment)
+		delete[] m_assignment;
 	m_assignment = new int[sls4mpe::num_vars];
 	sls4mpe::start_timer();
 	sls4mpe::runAlgorithm(&m_assignment, &m_likelihood, m_solution_found, m_num_trial, m_time_elapsed, m_converge_rate);
@@ -129,6 +164,7 @@ bool SLSWrapperInc::run() {
 }
 
 bool SLSWrapperHybrid::run() {
+	loadProblem();
 	sls4mpe::start_timer();
 	sls4mpe::algo = sls4mpe::ALGO_HYBRID;
 	sls4mpe::verbose = true;
@@ -31,6 +31,9 @@
 
 #ifdef ENABLE_SLS
 
+#include <atomic>
+#include <thread>
+
 #include "sls4mpe/main_algo.h"
 #include "sls4mpe/timer.h"
 #include "sls4mpe/global.h"
@@ -38,15 +41,37 @@
 
 namespace daoopt {
 
+/*
+ * All sls4mpe engine state is thread-local, so each wrapper instance can run
+ * in its own thread, concurrently with other instances (e.g. with different
+ * seeds or algorithms) and with the main search. Solutions are streamed into
+ * the shared Problem instance through Problem::updateSolution().
+ */
 class SLSWrapper {
 protected:
   double m_likelihood;
   int* m_assignment;
   Problem* m_problem;
+  int m_numVars;          // number of SLS variables (excl. dummy)
+  int m_iter;             // number of SLS runs
+  int m_time;             // time per run (in seconds)
+  long m_seed;            // seed for the sls4mpe random number generator
+  std::atomic<bool> m_abort;  // per-instance abort flag, see stop()
+  std::thread m_thread;   // background thread, if started via start()
+
+  /* loads the problem into the sls4mpe state of the calling thread */
+  bool loadProblem();
 
 public:
-  bool init(Problem* prob, int iter, int time);
+  bool init(Problem* prob, int iter, int time, long seed = 1);
+  /* runs SLS to completion in the calling thread */
   virtual bool run();
+  /* runs SLS in a background thread, returns immediately */
+  bool start();
+  /* asks this instance to abort as soon as possible (asynchronous) */
+  void stop();
+  /* waits for the background thread to finish (no-op if not started) */
+  void join();
   double getSolution(vector<val_t>* tuple = NULL) const;
   void reportSolution(double cost, int num_vars, int* assignment);
 
@@ -58,11 +83,14 @@ public:
 
 /* Inline definitions */
 inline SLSWrapper::SLSWrapper() :
-    m_likelihood(0.0), m_assignment(NULL) {
+    m_likelihood(0.0), m_assignment(NULL), m_problem(NULL),
+    m_numVars(0), m_iter(0), m_time(0), m_seed(1), m_abort(false) {
   /* nothing here */
 }
 
 inline SLSWrapper::~SLSWrapper() {
+  stop();
+  join();
   if (m_assignment)
     delete[] m_assignment;
 }
@@ -79,7 +107,7 @@ public:
 	bool run();
 	SLSWrapperInc(double converge_rate = 2.0) : SLSWrapper(), 
 		m_solution_found(false), m_num_trial(0), m_time_elapsed(0.0), m_converge_rate(converge_rate) {}
-	virtual ~SLSWrapperInc() {}
+	virtual ~SLSWrapperInc() { stop(); join(); }
 };
 
 class SLSWrapperHybrid : public SLSWrapper {
@@ -88,7 +116,8 @@ class SLSWrapperHybrid : public SLSWrapper {
 public:
 	bool run();
 	SLSWrapperHybrid() : SLSWrapper() {}
-	virtual ~SLSWrapperHybrid() {}
+	// (the thread runs our run(), stop it before this part is destroyed)
+	virtual ~SLSWrapperHybrid() { stop(); join(); }
 };
 
 
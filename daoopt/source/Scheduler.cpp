@@ -0,0 +1,193 @@
+/*
+ * Scheduler.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Scheduler.h"
+
+#include <chrono>
+using namespace std::chrono;
+
+namespace daoopt {
+
+extern high_resolution_clock::time_point _time_start;  // from Main.cpp
+
+/* shares of the remaining time per stage */
+static const double SHARE_SLS = 0.05;
+static const double SHARE_ORDERING = 0.05;
+static const double SHARE_FGLP = 0.05;
+static const double SHARE_JGLP = 0.05;
+static const double SHARE_HEURISTIC = 0.25;
+static const double SHARE_LDS = 0.05;
+
+/* the i-bound trials build the heuristic while this fraction of its share
+ * suffices, and extrapolate beyond */
+static const double TRIAL_FRACTION = 0.1;
+
+Scheduler::Scheduler(double total, int memlimit) :
+    m_total(total), m_memlimit(memlimit) {
+  oss ss;
+  ss << m_total << " seconds";
+  if (m_memlimit != NONE)
+    ss << ", " << m_memlimit << " MBytes";
+  log("budget " + ss.str());
+}
+
+
+double Scheduler::elapsed() const {
+  return duration_cast<duration<double> >(
+      high_resolution_clock::now() - _time_start).count();
+}
+
+double Scheduler::remaining() const {
+  return max(0.0, m_total - elapsed());
+}
+
+double Scheduler::share(double fraction, double least) const {
+  return max(least, fraction * remaining());
+}
+
+void Scheduler::log(const string& msg) const {
+  myprint("Scheduler: " + msg + "\n");
+}
+
+
+void Scheduler::planSLS(ProgramOptions* po) const {
+  // whole seconds per iteration (the SLS time granularity)
+  int iter = max(1, po->slsIter);
+  int t = max(1, (int) (share(SHARE_SLS) / iter));
+  if (po->slsTime > t || po->slsTime <= 0)
+    po->slsTime = t;
+  oss ss;
+  ss << "SLS " << po->slsIter << " x " << po->slsTime << " seconds";
+  log(ss.str());
+}
+
+
+void Scheduler::planOrdering(ProgramOptions* po) const {
+  po->order_timelimit = max(1, (int) share(SHARE_ORDERING));
+  po->order_iterations = NONE;
+  oss ss;
+  ss << "ordering for at most " << po->order_timelimit
+     << " seconds, until it stops improving";
+  log(ss.str());
+}
+
+
+bool Scheduler::stopOrdering(int iterations, double t, double last) const {
+  if (iterations < MIN_ORDER_ITERATIONS || t - last <= last)
+    return false;
+  oss ss;
+  ss << "ordering stopped after " << iterations << " iterations, last "
+     << "improvement at " << last << " of " << t << " seconds";
+  log(ss.str());
+  return true;
+}
+
+
+void Scheduler::planReparameterization(ProgramOptions* po) const {
+  oss ss;
+  if (po->mplp > 0 || po->mplps > 0) {
+    double t = share(SHARE_FGLP, 0.1);
+    if (po->mplps <= 0 || po->mplps > t)
+      po->mplps = t;
+    ss << "FGLP for at most " << po->mplps << " seconds";
+  }
+  if (po->jglp > 0 || po->jglps > 0) {
+    double t = share(SHARE_JGLP, 0.1);
+    if (po->jglps <= 0 || po->jglps > t)
+      po->jglps = t;
+    if (!ss.str().empty())
+      ss << ", ";
+    ss << "JGLP for at most " << po->jglps << " seconds";
+  }
+  if (!ss.str().empty())
+    log(ss.str());
+}
+
+
+int Scheduler::chooseIbound(Problem* p, Pseudotree* pt,
+                            const ProgramOptions& po, MiniBucketElim* mbe,
+                            const vector<val_t>* assignment, int maxIbound,
+                            bool* built) const {
+  assert(mbe && built);
+  double budget = share(SHARE_HEURISTIC);
+  // (simulating resets the tables)
+  MiniBucketElim sizer(p, pt, const_cast<ProgramOptions*>(&po), 1);
+
+  int best = 1, last = NONE;
+  double measured = 0;     // build time at the last measured i-bound
+  size_t measuredSize = 0;  // its table size
+  for (int i = 1; i <= maxIbound; ++i) {
+    sizer.setIbound(i);
+    size_t size = sizer.build(assignment, false);
+    double mbytes = (size / (1024 * 1024.0)) * sizeof(double);
+    oss ss;
+    ss << "i=" << i << ": " << mbytes << " MBytes";
+    if (m_memlimit != NONE && mbytes > m_memlimit) {
+      ss << ", over the memory limit";
+      log(ss.str());
+      break;
+    }
+    double t = measuredSize ? measured * size / measuredSize : 0;
+    if (t <= TRIAL_FRACTION * budget) {
+      high_resolution_clock::time_point start = high_resolution_clock::now();
+      mbe->setIbound(i);
+      mbe->build(assignment, true);
+      measured = t = duration_cast<duration<double> >(
+          high_resolution_clock::now() - start).count();
+      measuredSize = max<size_t>(size, 1);
+      last = i;
+      ss << ", built in " << t << " seconds";
+    } else {
+      ss << ", predicted " << t << " seconds";
+    }
+    if (t > budget) {
+      ss << ", over " << budget << " seconds";
+      log(ss.str());
+      break;
+    }
+    log(ss.str());
+    best = i;
+  }
+
+  *built = (best == last);
+  oss ss;
+  ss << "mini bucket i-bound " << best << " (-ibound " << maxIbound
+     << " is the limit)";
+  log(ss.str());
+  return best;
+}
+
+
+void Scheduler::planLDS(ProgramOptions* po) const {
+  int t = max(1, (int) share(SHARE_LDS));
+  if (po->ldsTime == NONE || po->ldsTime > t)
+    po->ldsTime = t;
+  oss ss;
+  ss << "LDS for at most " << po->ldsTime << " seconds";
+  log(ss.str());
+}
+
+
+void Scheduler::planSearch() const {
+  oss ss;
+  ss << "search for the remaining " << remaining() << " seconds";
+  log(ss.str());
+}
+
+}  // namespace daoopt
@@ -0,0 +1,92 @@
+/*
+ * Scheduler.h
+ *
+ *  Splits the time budget of a run (-max_time, and -mem_limit) across the
+ *  preprocessing stages and the search (-schedule).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "_base.h"
+
+#include "MiniBucketElim.h"
+#include "Problem.h"
+#include "ProgramOptions.h"
+#include "Pseudotree.h"
+
+namespace daoopt {
+
+/*
+ * Each stage gets a fixed share of the time that remains when it starts, so
+ * stages that finish early (or are disabled) leave more to the later ones,
+ * and the search gets whatever is left in the end. Within their share:
+ * - SLS spreads its time over the configured iterations (it stops on
+ *   convergence by itself, cf. -sls_converge_rate);
+ * - ordering search stops once the time since its last improvement exceeds
+ *   the time it took to get there (improvements get rarer as it goes on);
+ * - FGLP/JGLP, if enabled, have their time limits capped;
+ * - the mini bucket i-bound is the largest up to -ibound whose build is
+ *   predicted to fit, where the build time of the configured heuristic is
+ *   measured for increasing i-bounds while it's small and extrapolated from
+ *   the table sizes beyond (the memory limit applies as usual);
+ * - LDS gets a wall-clock budget (-lds_time).
+ * Every decision is logged.
+ */
+class Scheduler {
+
+ protected:
+  double m_total;  // seconds for the whole run
+  int m_memlimit;  // MBytes (NONE for none)
+
+  /* minimum number of ordering iterations before they may be stopped
+   * (the default of -order_iterations) */
+  static const int MIN_ORDER_ITERATIONS = 25;
+
+ protected:
+  /* seconds since the start of the run, and until its end */
+  double elapsed() const;
+  double remaining() const;
+  /* the given share of the remaining time, at least 'least' seconds */
+  double share(double fraction, double least = 0) const;
+  void log(const string& msg) const;
+
+ public:
+  void planSLS(ProgramOptions* po) const;
+  void planOrdering(ProgramOptions* po) const;
+  /* returns true if the ordering search should stop after 'iterations'
+   * iterations at time t (seconds since its start), the last improvement
+   * having been at time 'last' */
+  bool stopOrdering(int iterations, double t, double last) const;
+  void planReparameterization(ProgramOptions* po) const;
+  /* returns the i-bound for the mini bucket heuristic, at most maxIbound,
+   * timing the trial builds on mbe (table sizes are simulated on a separate
+   * instance); *built is set if mbe holds the tables of the chosen i-bound
+   * afterwards */
+  int chooseIbound(Problem* p, Pseudotree* pt, const ProgramOptions& po,
+                   MiniBucketElim* mbe, const vector<val_t>* assignment,
+                   int maxIbound, bool* built) const;
+  void planLDS(ProgramOptions* po) const;
+  void planSearch() const;
+
+  Scheduler(double total, int memlimit);
+};
+
+}  // namespace daoopt
+
+#endif /* SCHEDULER_H_ */
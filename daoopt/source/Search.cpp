@@ -40,19 +40,30 @@ using namespace minisat;
 
 // NONE, UNIT, FULL (not yet implemented).
 DECLARE_string(cp_type);
+DECLARE_int32(cp_nogoods);
+DECLARE_int32(cp_nogood_size);
 
 namespace daoopt {
 
 extern high_resolution_clock::time_point _time_start; // from Main.cpp
 
-Search::Search() {
+// gaps to the ancestor pruning threshold up to this size are rechecked by
+// climbing to the root, to decide ties exactly as the climb would
+static const double PRUNING_GAP_EPS = 1e-9;
+
+Search::Search() : m_sumTask(false), m_trackAssignment(false), m_incrementalPruning(true), m_weight(1.0), m_weightBounded(true), m_syncSolution(false), m_abort(NULL), m_timeStart(_time_start), m_exitOnTimeout(true), m_timedOut(false) {
 }
 
 Search::Search(Problem* prob, Pseudotree* pt, SearchSpace* s, Heuristic* h,
     BoundPropagator* prop, ProgramOptions* po) :
     m_problem(prob), m_pseudotree(pt), m_space(s), m_heuristic(h),
     m_prop(prop),
-    m_options(po), m_foundFirstPartialSolution(false)
+    m_options(po), m_sumTask(po && po->task == TASK_PR),
+    m_trackAssignment(po && po->trackAssignment),
+    m_incrementalPruning(true), m_weight(1.0), m_weightBounded(true),
+    m_foundFirstPartialSolution(false), m_syncSolution(false),
+    m_abort(NULL), m_timeStart(_time_start), m_exitOnTimeout(true),
+    m_timedOut(false)
 #ifdef PARALLEL_DYNAMIC
   , m_nextSubprob(NULL)
 #endif
@@ -67,6 +78,23 @@ Search::Search(Problem* prob, Pseudotree* pt, SearchSpace* s, Heuristic* h,
 
   // Preallocate space for expansion vector. 128 should be plenty.
   m_expand.reserve(128);
+
+  // value and subproblem ordering policies
+  m_orderingStats.init(m_problem);
+  string valueOrder = m_options ? m_options->valueOrdering : "";
+  string subprobOrder = m_options ? m_options->subprobOrdering : "";
+  if (subprobOrder == "") {
+    int so = m_options ? m_options->subprobOrder : NONE;
+    if (so == SUBPROB_HEUR_INC) subprobOrder = "heur-inc";
+    else if (so == SUBPROB_HEUR_DEC) subprobOrder = "heur-dec";
+    else subprobOrder = "pseudotree";
+  }
+  m_valueOrdering.reset(ValueOrdering::create(valueOrder, &m_orderingStats));
+  m_subprobOrdering.reset(
+      SubproblemOrdering::create(subprobOrder, &m_orderingStats));
+  assert(m_valueOrdering && m_subprobOrdering);
+  if (m_prop)
+    m_prop->setOrderingStats(&m_orderingStats);
 }
 
 
@@ -106,6 +134,7 @@ bool Search::doProcess(SearchNode* node) {
     int var = node->getVar();
     int val = node->getVal();
     m_assignment[var] = val; // record assignment
+    m_orderingStats.recordProcessed(var, val);
   } else { // NODE_OR
     m_space->stats.numProcOR += 1;
     m_space->stats.numProcORVar[node->getVar()] += 1;
@@ -136,25 +165,23 @@ if (!ptnode->getParent() || !ptnode->getParent()->getParent())
       addCacheContext(node,ptnode->getCacheContextVec());
       //DIAG( myprint( str("    Context set: ") + ptnode->getCacheContext() + "\n" ) );
       // try to get value from cache
-#ifndef NO_ASSIGNMENT
-      const pair<const double, const vector<val_t> >& entry =
-          m_space->cache->read(var, node->getCacheInst(), node->getCacheContext());
-      if (!ISNAN(entry.first)) {
-        node->setValue( entry.first ); // set value
-        node->setOptAssig( entry.second ); // set assignment
-#else
-      const double entry = m_space->cache->read(var, node->getCacheInst(), node->getCacheContext());
+      double entry = ELEM_NAN;
+      if (m_trackAssignment) {
+        const cache_assig_entry& assigEntry =
+            m_space->cache->readAssig(var, node->getCacheInst(), node->getCacheContext());
+        entry = assigEntry.first;
+        if (!ISNAN(entry))
+          node->setSolution( assigEntry.second ); // set solution
+      } else {
+        entry = m_space->cache->read(var, node->getCacheInst(), node->getCacheContext());
+      }
       if (!ISNAN(entry)) {
         node->setValue( entry ); // set value
-#endif
         node->setLeaf(); // mark as leaf
 #ifdef DEBUG
         ostringstream ss;
-        ss << "-Read " << *node << " with value " << node->getValue()
-#ifndef NO_ASSIGNMENT
-        << " and opt. solution " << node->getOptAssig()
-#endif
-        << endl;
+        ss << "-Read " << *node << " with value " << node->getValue();
+        ss << endl;
         myprint(ss.str());
 #endif
         return true;
@@ -175,13 +202,18 @@ bool Search::doPruning(SearchNode* node) {
 #ifdef NO_HEURISTIC
   return false;
 #endif
+  // bounds on the best solution can't prune a sum over all solutions
+  if (m_sumTask)
+    return false;
 
   assert(node);
   int var = node->getVar();
   PseudotreeNode* ptnode = m_pseudotree->getNode(var);
   int depth = ptnode->getDepth();
 
-  if (canBePruned(node)) {
+  bool pruned = canBePruned(node);
+  m_orderingStats.recordPruningCheck(node, pruned);
+  if (pruned) {
     DIAG( myprint("\t !pruning \n") );
     node->setLeaf();
     m_space->stats.numPruned += 1;
@@ -227,8 +259,10 @@ SearchNode* Search::nextLeaf() {
 
     // Then move to next node.
     node = this->nextNode();
+    if (m_syncSolution)
+      importSolution();
     high_resolution_clock::time_point time_now = high_resolution_clock::now();
-    double time_elapsed = duration_cast<duration<double>>(time_now - _time_start).count();
+    double time_elapsed = duration_cast<duration<double>>(time_now - m_timeStart).count();
     if (time_elapsed > m_options->maxTime) {
       cout << "Timed out at " << time_elapsed << " seconds." << endl;
       cout << "Stats at timeout: " << endl;
@@ -241,6 +275,12 @@ SearchNode* Search::nextLeaf() {
       cout << "Pruned nodes:       " << m_space->stats.numPruned << endl;
       cout << "Deadend nodes:      " << m_space->stats.numDead << endl;
       cout << "Deadend nodes (CP): " << m_space->stats.numDeadCP << endl;
+      if (!m_exitOnTimeout) {
+        m_timedOut = true;
+        return NULL;
+      }
+      if (m_onTimeout)
+        m_onTimeout();
       exit(0);
     }
   }
@@ -267,7 +307,7 @@ bool Search::canBePruned(SearchNode* n) {
       for (;;) {
         int vvar = cur->getVar();
         int vval = cur->getVal();
-        sat_vars.push_back(var2sat_[vvar][vval]);
+        sat_vars.push_back(m_satOffset[vvar] + vval);
 
         cur = parent->getParent();
         if (cur) break;
@@ -279,10 +319,8 @@ bool Search::canBePruned(SearchNode* n) {
         return true;
       }
     }
-    else if (FLAGS_cp_type == "UNIT") {
-      zchaff_solver_.dlevel()++;
-      if (!DoCPLookahead(n->getVar(), n->getVal(), n->changes(),
-          m_pseudotree->getNode(n->getVar())->getSubprobVars())) {
+    else if (m_cp) {
+      if (!DoCPLookahead(n)) {
         ++m_space->stats.numDeadCP;
         return true;
       }
@@ -293,13 +331,47 @@ bool Search::canBePruned(SearchNode* n) {
   if (n->getHeur() == ELEM_ZERO)
 	  { n->PruningGap() = ELEM_ZERO ; return true; }
 
+  if (m_incrementalPruning) {
+    // compare against the OR node's value and the threshold that all the
+    // ancestors impose; the climb below only runs to confirm (close to)
+    // actual pruning and to mark the affected subproblems
+    SearchNode* curOR = (n->getType() == NODE_OR) ? n : n->getParent();
+    double pg = n->getHeur() - curOR->getValue();
+    double pgAnc = n->getHeur() - ancestorBound(curOR);
+    if (!(pg <= PRUNING_GAP_EPS) && !(pgAnc <= PRUNING_GAP_EPS)) {
+      if (pgAnc < pg) pg = pgAnc;
+#ifdef VALIDATE_PRUNING
+      if (canBePrunedClimb(n) || fabs(n->getPruningGap() - pg) > 1e-6) {
+        ostringstream ss;
+        ss << std::setprecision(20) << "Pruning threshold " << ancestorBound(curOR)
+           << " disagrees on " << *n << " (h=" << n->getHeur() << ", gap " << pg
+           << " vs. " << n->getPruningGap() << ")" << endl;
+        myerror(ss.str());
+        assert(false);
+      }
+#endif
+      n->PruningGap() = pg;
+      return false;
+    }
+  }
+
+  return canBePrunedClimb(n);
+
+} // Search::canBePruned
+
+
+bool Search::canBePrunedClimb(SearchNode* n) {
+
   double curPSTVal = n->getHeur();  // includes label in case of AND node
   SearchNode* curOR = (n->getType() == NODE_OR) ? n : n->getParent();
 
   double pg = curPSTVal - curOR->getValue() ;
   n->PruningGap() = pg ;
-  if (pg <= 0.0)  // simple pruning case
-	  return true;
+  if (pg <= 0.0) {  // simple pruning case
+    if (m_weight != 1.0)
+      markNotOptWeighted(curOR);
+    return true;
+  }
 
   SearchNode* curAND = NULL;
 
@@ -327,12 +399,58 @@ bool Search::canBePruned(SearchNode* n) {
         for (SearchNode* nn = (n->getType() == NODE_OR) ? n : n->getParent();
             nn != curOR; nn = nn->getParent()->getParent())
             nn->setNotOpt();  // mark possibly not optimally solved subproblems
+        if (m_weight != 1.0)
+          markNotOptWeighted(curOR);
       return true;  // pruning is possible!
     }
   }
   return false;  // default, no pruning possible
 
-} // Search::canBePruned
+} // Search::canBePrunedClimb
+
+
+void Search::markNotOptWeighted(SearchNode* n) {
+  // (ancestors of marked nodes are always marked already)
+  while (n && !n->isNotOpt()) {
+    n->setNotOpt();
+    n = n->getParent() ? n->getParent()->getParent() : NULL;
+  }
+}
+
+
+double Search::ancestorBound(SearchNode* n) {
+  assert(n && n->getType() == NODE_OR);
+  size_t epoch = m_space->boundEpoch;
+  if (n->getAncestorBoundEpoch() == epoch)
+    return n->getAncestorBound();
+
+  double bound = ELEM_ZERO;
+  SearchNode* curAND = n->getParent();
+  if (curAND) {
+    bound = pruningThreshold(curAND->getParent());
+    // what the AND parent contributes apart from n's subproblem
+    double pst = curAND->getLabel() OP_TIMES curAND->getSubSolved();
+    NodeP* children = curAND->getChildren();
+    for (size_t i = 0; i < curAND->getChildCountFull(); ++i) {
+      if (!children[i] || children[i] == n) continue;
+      else pst OP_TIMESEQ children[i]->getHeur();
+    }
+    bound OP_DIVIDEEQ pst;
+    if (ISNAN(bound))  // zero threshold and zero siblings
+      bound = ELEM_ZERO;
+  }
+  n->setAncestorBound(bound, epoch);
+  return bound;
+}
+
+
+double Search::pruningThreshold(SearchNode* n) {
+  double thr = ancestorBound(n);
+  double v = n->getValue();
+  if (!ISNAN(v) && v > thr)
+    thr = v;
+  return thr;
+}
 
 
 void Search::syncAssignment(const SearchNode* node) {
@@ -426,12 +544,8 @@ bool Search::generateChildrenAND(SearchNode* n, vector<SearchNode*>& chi) {
     return true; // no children
   }
 
-  // order subproblems by their heuristic (if applicable)
-  // (inverse due to stack reversal)
-  if (m_space->options->subprobOrder == SUBPROB_HEUR_INC)
-    sort(chi.rbegin(), chi.rend(), SearchNode::heurLess);
-  else if (m_space->options->subprobOrder == SUBPROB_HEUR_DEC)
-    sort(chi.begin(), chi.end(), SearchNode::heurLess);
+  // order subproblems according to policy (last one is explored first)
+  m_subprobOrdering->order(n, chi);
 
   n->addChildren(chi);
 
@@ -505,8 +619,8 @@ bool Search::generateChildrenOR(SearchNode* n, vector<SearchNode*>& chi) {
       continue;
     }
 
-    // Found inconsistent by constriant propagation
-    if (!current_domains_.empty() && !current_domains_[var][i]) {
+    // Found inconsistent by constraint propagation
+    if (m_cp && !m_cp->inDomain(var, i)) {
       continue;
     }
     SearchNodeAND* c = new SearchNodeAND(n, i, heur[2*i+1]); // uses cached label
@@ -524,15 +638,18 @@ bool Search::generateChildrenOR(SearchNode* n, vector<SearchNode*>& chi) {
 //  n->clearHeurCache();
 #endif
 
-  if (chi.empty()) {  // should never happen
+  if (chi.empty()) {  // all values are dead-ends
+    if (m_cp)
+      m_cp->learnDeadEnd(var, node->getFullContextVec());
     n->setLeaf();
     n->setValue(ELEM_ZERO);
     return true; // no children
   }
 
 #ifndef NO_HEURISTIC
-  // sort new nodes by increasing heuristic value
-  sort(chi.begin(), chi.end(), SearchNode::heurLess);
+  // order new nodes according to policy (by default increasing heuristic
+  // value, the last one is explored first)
+  m_valueOrdering->order(n, chi);
 #endif
 #ifdef DEBUG
 // =================
@@ -591,6 +708,13 @@ double Search::assignCostsOR(SearchNode* n)
     dv[2*i] = m_costTmp[i];
     dv[2*i+1] = labelAll[i];
   }
+  if (m_weight != 1.0) {
+    for (int i=0; i<vDomain; ++i) {
+      if (dv[2*i] > ELEM_ONE || dv[2*i+1] > ELEM_ONE)
+        m_weightBounded = false;
+      dv[2*i] = weightHeur(dv[2*i]);
+    }
+  }
 
   for (int i=0; i<vDomain; ++i) {
     m_assignment[v] = i;
@@ -621,6 +745,11 @@ double Search::assignCostsOR(SearchNode* n)
 #else
     heuristic = m_heuristic->getHeur(v, m_assignment, n);
 #endif // DECOMPOSE_H_INTO_INDEPENDENT_SUBPROBLEMS
+    if (m_weight != 1.0) {
+      if (heuristic > ELEM_ONE || label > ELEM_ONE)
+        m_weightBounded = false;
+      heuristic = weightHeur(heuristic);
+    }
 
 
     // store label and heuristic into cache table
@@ -730,7 +859,13 @@ bool Search::loadInitialBound(string file) {
     double bound;
     BINREAD(infile, bound);
 
-#ifndef NO_ASSIGNMENT
+    if (!m_trackAssignment) {
+      // store bound into search space and problem instance
+      this->updateSolution(bound);
+      m_problem->updateSolution(getCurOptValue(), NULL, true);
+      infile.close();
+      return true;
+    }
 
     // no. of and and or nodes (not relevant here) // TODO breaks old versions
     count_t noOr, noAnd;
@@ -769,17 +904,10 @@ bool Search::loadInitialBound(string file) {
       cerr << "ERROR reading SLS solution, reduced problem size doesn't match" << endl;
       return false;
     }
-#endif
 
     // store solution/bound into search space and problem instance
-#ifdef NO_ASSIGNMENT
-    this->updateSolution(bound);
-    m_problem->updateSolution(getCurOptValue(), NULL, true);
-#else
     this->updateSolution(bound, reduced);
     m_problem->updateSolution(getCurOptValue(), getCurOptTuple(), NULL, true);
-#endif
-
 
   }
   infile.close();
@@ -848,11 +976,11 @@ int Search::restrictSubproblem(int rootVar, const vector<val_t>& assig, const ve
 }
 
 
-bool Search::updateSolution(double d
-#ifndef NO_ASSIGNMENT
-    ,const vector<val_t>& tuple
-#endif
-  ) const {
+bool Search::updateSolution(double d) const {
+  return updateSolution(d, vector<val_t>());
+}
+
+bool Search::updateSolution(double d, const vector<val_t>& tuple) const {
   assert(m_space && m_space->root);
   if (ISNAN(d))
     return false;
@@ -860,13 +988,33 @@ bool Search::updateSolution(double d
   if (!ISNAN(curValue) && d <= curValue)
     return false;
   m_space->root->setValue(d);
-#ifndef NO_ASSIGNMENT
-  m_space->root->setOptAssig(tuple);
-#endif
+  m_space->boundEpoch += 1;  // cached pruning thresholds are outdated
+  if (tuple.empty())
+    m_space->root->clearSolution();
+  else
+    m_space->root->setSolution(tuple);
   return true;
 }
 
 
+bool Search::importSolution() const {
+  double cur = m_space->root->getValue();
+  // (called for every node with solution sync, so check without locking
+  // whether there is anything to import first)
+  double d = m_problem->peekSolutionCost();
+  if (ISNAN(d) || (!ISNAN(cur) && d <= cur))
+    return false;
+  d = m_problem->getSolutionSnapshot();
+  if (ISNAN(d) || (!ISNAN(cur) && d <= cur))
+    return false;
+  if (!m_trackAssignment)
+    return updateSolution(d);
+  vector<val_t> tuple;
+  d = m_problem->getSolutionSnapshot(&tuple);
+  return updateSolution(d, tuple);
+}
+
+
 bool Search::restrictSubproblem(string file) {
   assert(!file.empty());
 
@@ -1105,7 +1253,8 @@ bool Search::propHeuristic(SearchNode* node) {
     }
   } while (cur);
 
-  if (prop || !cur) {
+  // (a weighted heuristic doesn't bound the problem)
+  if ((prop || !cur) && m_weight == 1.0) {
     m_problem->updateUpperBound(prev->getHeur(), &m_space->stats, true);
   }
 
@@ -1120,14 +1269,12 @@ void Search::DoConstraintPropagation() {
   if (FLAGS_cp_type == "FULL") {
     vec<Lit> lits;
 
-    // create SAT problem
-    var2sat_.resize(m_problem->getN());
+    // create SAT problem, one variable per (var,val) pair
+    m_satOffset.resize(m_problem->getN());
     for (int var = 0; var < m_problem->getN(); ++var) {
-      var2sat_[var].resize(m_problem->getDomainSize(var));
-      for (int val = 0; val < m_problem->getDomainSize(var); ++val) {
-        Var vid = minisat_solver_.newVar();
-        var2sat_[var][val] = vid;
-      }
+      m_satOffset[var] = minisat_solver_.nVars();
+      for (int val = 0; val < m_problem->getDomainSize(var); ++val)
+        minisat_solver_.newVar();
     }
 
     vector<val_t> assignment;
@@ -1161,7 +1308,7 @@ void Search::DoConstraintPropagation() {
         if (val == ELEM_ZERO) {
           lits.clear();
           for (int a = 0; a < scope_size; ++a) {
-            int vid = var2sat_[scope_vars[a]][values[a]];
+            int vid = m_satOffset[scope_vars[a]] + values[a];
             lits.push(~mkLit(vid));
           }
           minisat_solver_.addClause_(lits);
@@ -1175,8 +1322,8 @@ void Search::DoConstraintPropagation() {
       int domain_size = m_problem->getDomainSize(var);
       for (int v1 = 0; v1 < domain_size - 1; ++v1) {
         for (int v2 = v1 + 1; v2 < domain_size; ++v2) {
-          int v1sat = var2sat_[var][v1];
-          int v2sat = var2sat_[var][v2];
+          int v1sat = m_satOffset[var] + v1;
+          int v2sat = m_satOffset[var] + v2;
 
           lits.clear();
           lits.push(~mkLit(v1sat));
@@ -1190,7 +1337,7 @@ void Search::DoConstraintPropagation() {
     for (int var = 0; var < m_problem->getN(); ++var) {
       lits.clear();
       for (int val = 0; val < m_problem->getDomainSize(var); ++val) {
-        lits.push(mkLit(var2sat_[var][val]));
+        lits.push(mkLit(m_satOffset[var] + val));
       }
       minisat_solver_.addClause_(lits);
     }
@@ -1207,112 +1354,23 @@ void Search::DoConstraintPropagation() {
     }
   }
   else if (FLAGS_cp_type == "UNIT") {
-    int var_id = 1;
-    int n_sat_vars = 0;
-    for (int i = 0; i < m_problem->getN(); ++i) {
-      n_sat_vars += m_problem->getDomainSize(i);
-    }
-
-    // Create SAT problem
-    var2sat_.resize(m_problem->getN());
-    sat2var_.resize(n_sat_vars + 1, std::make_pair(-1, -1));
-    zchaff_solver_.set_variable_number(n_sat_vars);
-    for (int i = 0; i < m_problem->getN(); ++i) {
-      int domain_size = m_problem->getDomainSize(i);
-      var2sat_[i].resize(domain_size, 0);
-      for (int k = 0; k < domain_size; ++k, ++var_id) {
-        var2sat_[i][k] = var_id;
-        sat2var_[var_id] = std::make_pair(i, k);
-      }
-    }
-
-    zchaff_solver_.set_var_maps(var2sat_, sat2var_);
-
-    // Create clauses for 0 probability tuples
-    int num_cl = 0;
-    for (const Function* f : m_problem->getFunctions()) {
-      int arity = f->getArity();
-      if (arity == 0) continue;
-      int* scope_vars = new int[arity];
-      int l = 0;
-      for (int v : f->getScopeSet()) {
-        scope_vars[l++] = v;
-      }
-
-      int* values = new int[arity];
-      for (int i = 0 ; i < arity - 1; ++i) {
-        values[i] = 0;
-      }
-      values[arity - 1] = -1;
-
-      // Enumerate instantiations
-      vector<val_t> assignment(m_problem->getN(), -1);
-      int i;
-      for (;;) {
-        for (i = arity - 1; i >= 0; --i) {
-          int a = scope_vars[i];
-          int last = m_problem->getDomainSize(a) - 1;
-          if (values[i] < last) break;
-          values[i] = 0;
-        }
-        if (i < 0) break;
-        ++values[i];
-
-        for (int a = 0; a < arity; ++a) {
-          assignment[scope_vars[a]] = values[a];
-        }
-
-        // Nogood clause if assignment is 0
-        if (f->getValue(assignment) == ELEM_ZERO) {
-          zchaff_solver_.add_nogood_clause(arity, scope_vars, values);
-          ++num_cl;
-        }
-      }
-
-      // Reset assignment
-      assignment.resize(m_problem->getN(), -1);
-      delete[] values;
-      delete[] scope_vars;
-    }
-
-    // Add at-most-one clauses for domain values
-    // (assignment exclusivity constraint)
-    for (int i = 0; i < m_problem->getN(); ++i) {
-      int domain_size = m_problem->getDomainSize(i);
-      for (int v1 = 0; v1 < domain_size - 1; ++v1) {
-        for (int v2 = v1 + 1; v2 < domain_size; ++v2) {
-          zchaff_solver_.add_atmostone_clause(i, v1, v2);
-          ++num_cl;
-        }
-      }
+    m_cp.reset(new ConstraintPropagator(m_problem, m_pseudotree));
+    if (FLAGS_cp_nogoods > 0)
+      m_cp->setNogoodLimit(FLAGS_cp_nogoods, max(1, FLAGS_cp_nogood_size));
+    bool ok = m_cp->init();
+    cout << "Created constraint propagator over "
+         << m_cp->getConstraintCount() << " functions with zero entries"
+         << endl;
+    if (FLAGS_cp_nogoods > 0) {
+      cout << "Learning up to " << FLAGS_cp_nogoods << " nogoods of size <= "
+           << max(1, FLAGS_cp_nogood_size) << endl;
     }
-
-    // Add at-least-one clauses to ensure something is assigned
-    for (int i = 0; i < m_problem->getN(); ++i) {
-      int domain_size = m_problem->getDomainSize(i);
-      zchaff_solver_.add_atleastone_clause(i, domain_size);
-      ++num_cl;
+    if (!ok) {
+      cout << "Initial propagation wiped out a domain." << endl;
     }
-
-    zchaff_solver_.init_solve();
-    zchaff_solver_.preprocess();
-
-    cout << "Created SAT (zchaff) instance with "
-         << zchaff_solver_.num_variables() << " variables and "
-         << zchaff_solver_.num_clauses() << " clauses" << endl;
-
-    current_domains_.resize(m_problem->getN());
-    for (int i = 0; i < m_problem->getN(); ++i) {
-      current_domains_[i].resize(m_problem->getDomainSize(i), true);
-    }
-
-    list<pair<int, int>> changes;
-    zchaff_solver_.update_domains(current_domains_, changes);
-
-    m_prop->setSatSolver(&zchaff_solver_);
+    m_prop->setConstraintPropagator(m_cp.get());
   } else {
-    m_prop->setSatSolver(nullptr);
-    assert(current_domains_.empty());
+    m_prop->setConstraintPropagator(NULL);
   }
 }
 
@@ -1327,36 +1385,10 @@ bool Search::DoSATPropagate(const vector<int>& vars) {
   return minisat_solver_.solve(lits);
 }
 
-bool Search::DoCPLookahead(int var, int val, list<pair<int, int>>& changes,
-                           const vector<int>& subtree) {
-  assert(FLAGS_cp_type == "UNIT");
-
-  // Unit resolution
-  int res = zchaff_solver_.propagate(var, val);
-  zchaff_solver_.update_domains(current_domains_, changes);
-  if (res == zchaff::CONFLICT) {
-    return false;
-  }
-
-  // Future empty domain in a subproblem?
-  for (int desc : subtree) {
-    if (var == desc) {
-      continue;
-    }
-
-    vector<bool>& domain = current_domains_[desc];
-    size_t sz = domain.size();
-    size_t pruned = 0;
-    for (size_t j = 0; j < sz; ++j) {
-      if (!domain[j]) {
-        ++pruned;
-      }
-    }
-    if (pruned == sz) {
-      return false;
-    }
-  }
-  return true;
+bool Search::DoCPLookahead(SearchNode* n) {
+  assert(m_cp && n->getType() == NODE_AND);
+  n->setCPMark(m_cp->mark());
+  return m_cp->assign(n->getVar(), n->getVal());
 }
 
 }  // namespace daoopt
@@ -34,7 +34,12 @@
 #include "utils.h"
 
 #include "minisat/Solver.h"
-#include "zchaff/zchaff_solver.h"
+#include "ConstraintPropagator.h"
+#include "OrderingPolicy.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 #ifdef PARALLEL_DYNAMIC
 #include "SubproblemHandler.h"
@@ -56,6 +61,14 @@ protected:
   Heuristic* m_heuristic;       // Heuristic for search
   BoundPropagator* m_prop;      // Bound (solution) propagator
   ProgramOptions * m_options;    // Program options instance
+  bool m_sumTask;               // summing over solutions (task pr), no pruning
+  bool m_trackAssignment;       // optimal assignments are recorded (-track_assignment)
+  bool m_incrementalPruning;    // pruning uses the cached ancestor thresholds, which
+                                // requires that nodes are explored depth-first
+  double m_weight;              // weight w >= 1 applied to the heuristic (1: admissible)
+  bool m_weightBounded;         // all labels and heuristic estimates seen under weight w
+                                // were at most ELEM_ONE, so solutions are within w of
+                                // the optimum (in terms of -log cost)
 #ifdef PARALLEL_DYNAMIC
   Subproblem* m_nextSubprob;    // Next subproblem for external solving
 #endif
@@ -76,13 +89,24 @@ protected:
 
   bool m_foundFirstPartialSolution;       // Used to know if some lower bound exists for some part of the problem
 
+  bool m_syncSolution;          // Pick up solutions reported to the problem instance by
+                                // other threads (e.g. background SLS) during search
+
+  const std::atomic<bool>* m_abort;  // set by another thread to stop the search
+  std::function<void()> m_onTimeout;  // called before exiting on timeout
+  std::chrono::high_resolution_clock::time_point m_timeStart;  // -max_time
+                                      // counts from here (default: run start)
+  bool m_exitOnTimeout;  // exit the process on timeout (or stop the search)
+  bool m_timedOut;       // the search stopped on timeout
+
   // For constraint propagation
   minisat::Solver minisat_solver_;
-  zchaff::CSolver zchaff_solver_;
+  vector<int> m_satOffset;  // first minisat variable per variable (FULL)
+  scoped_ptr<ConstraintPropagator> m_cp;  // incremental propagation (UNIT)
 
-  vector<vector<int>> var2sat_;
-  vector<pair<int,int>> sat2var_;
-  vector<vector<bool>> current_domains_;
+  OrderingStats m_orderingStats;  // online statistics for the orderings
+  scoped_ptr<ValueOrdering> m_valueOrdering;  // orders new AND children
+  scoped_ptr<SubproblemOrdering> m_subprobOrdering;  // orders new OR children
 
 
 
@@ -110,6 +134,7 @@ public:
 
   const vector<count_t>& getNodeProfile() const { return m_nodeProfile; }
   const vector<count_t>& getLeafProfile() const { return m_leafProfile; }
+  const ConstraintPropagator* getConstraintPropagator() const { return m_cp.get(); }
   const vector<val_t>& getAssignment() const { return m_assignment; }
 
   /* returns the current lower bound on the root problem solution
@@ -120,9 +145,9 @@ public:
 
   /* cur value of root OR node */
   double getCurOptValue() const;
-#ifndef NO_ASSIGNMENT
-  const vector<val_t>& getCurOptTuple() const;
-#endif
+  /* cur optimal assignment of the root problem (empty unless tracked),
+   * assembled from the solution recorded at the root */
+  vector<val_t> getCurOptTuple() const;
 
 //  void outputAndSaveSolution(const string& filename) const;
 
@@ -141,11 +166,45 @@ public:
    * returns true on success, false on error */
   bool loadInitialBound(string);
 
-  bool updateSolution(double
-#ifndef NO_ASSIGNMENT
-    , const vector<val_t>&
-#endif
-  ) const;
+  /* sets a new root solution value, with or without its assignment */
+  bool updateSolution(double) const;
+  bool updateSolution(double, const vector<val_t>&) const;
+
+  /* enables/disables picking up external solutions from the problem instance
+   * while searching (cf. importSolution()) */
+  void setSolutionSync(bool b) { m_syncSolution = b; }
+
+  /* flag through which other threads can abort the search (not supported by
+   * all algorithms, AOBB is best stopped between node-limited solve() calls) */
+  void setAbortFlag(const std::atomic<bool>* f) { m_abort = f; }
+  bool isAborted() const { return m_abort && *m_abort; }
+
+  /* function to call when the search times out (-max_time), right before
+   * the process exits (e.g., to stop other threads) */
+  void setTimeoutHandler(const std::function<void()>& f) { m_onTimeout = f; }
+
+  /* counts the time limit (-max_time) from 'start' rather than the start of
+   * the run; unless exitOnTimeout, a search that times out stops (solve()
+   * returns false and isTimedOut() is set) instead of exiting the process */
+  void setTimeLimit(const std::chrono::high_resolution_clock::time_point& start,
+                    bool exitOnTimeout) {
+    m_timeStart = start;
+    m_exitOnTimeout = exitOnTimeout;
+  }
+  bool isTimedOut() const { return m_timedOut; }
+
+  /* sets the weight w >= 1 of the heuristic for weighted search, which is
+   * applied to nodes generated from then on (i.e., set it before
+   * finalizeHeuristic()). Solutions found with w > 1 are within factor w
+   * of the optimal cost if isWeightBounded() holds when the search is done */
+  void setWeight(double w) { m_weight = w; m_weightBounded = true; }
+  double getWeight() const { return m_weight; }
+  bool isWeightBounded() const { return m_weightBounded; }
+
+  /* loads the problem instance's current solution into the search space if it
+   * is better than the search's own, returns true if so. Safe to call while
+   * other threads keep reporting solutions to the problem. */
+  bool importSolution() const;
 
   /* resets the queue/stack/etc. to the given node */
   virtual void reset(SearchNode* = NULL) = 0;
@@ -154,8 +213,9 @@ public:
   virtual bool solve(size_t nodeLimit) = 0;
 
   void DoConstraintPropagation();
-  bool DoCPLookahead(int var, int val, list<pair<int, int>>& changes,
-     const vector<int>& subtree);
+  /* assigns the AND node's variable in the propagation engine (recording
+   * the trail position in the node), returns false on a dead end */
+  bool DoCPLookahead(SearchNode* n);
   bool DoSATPropagate(const vector<int>& vars);
 
 #ifndef NO_HEURISTIC
@@ -206,11 +266,30 @@ protected:
 
   /* checks if the node can be pruned (only meant for AND nodes) */
   bool canBePruned(SearchNode*);
+  /* the pruning check proper, climbing all the way up to the root node */
+  bool canBePrunedClimb(SearchNode*);
+  /* marks OR node n and all its ancestors as possibly not optimally solved,
+   * as pruning with a weighted heuristic may discard the optimal solution
+   * below any of them */
+  void markNotOptWeighted(SearchNode* n);
+
+  /* returns the pruning threshold the ancestors impose on the subproblem
+   * below OR node n: the maximum over OR ancestors A of A's value divided by
+   * the labels, solved subproblems and sibling heuristics between n and A.
+   * It follows from the parent's threshold and is cached in n until the
+   * search space's bound epoch advances */
+  double ancestorBound(SearchNode* n);
+  /* returns the threshold against which the children of OR node n are
+   * pruned, i.e., the better of n's value and its ancestor bound */
+  double pruningThreshold(SearchNode* n);
 
   /* computes the heuristic of a new OR node, which includes precomputing
    * its child AND nodes' heuristic and label values, which are cached
    * for their explicit generation */
   double assignCostsOR(SearchNode*);
+  /* returns heuristic estimate h under the search weight, h^w (w*h in log
+   * space) */
+  double weightHeur(double h) const;
 
   /* returns the current lower bound on the subproblem solution rooted at
    * n, taking into account solutions to parent problems (or the dummy partial
@@ -248,17 +327,27 @@ public:
 
 /* Inline definitions */
 
+inline double Search::weightHeur(double h) const {
+#ifdef USE_LOG
+  return m_weight * h;
+#else
+  return pow(h, m_weight);
+#endif
+}
+
 inline double Search::getCurOptValue() const {
   assert(m_space);
   return m_space->getTrueRoot()->getValue();
 }
 
-#ifndef NO_ASSIGNMENT
-inline const vector<val_t>& Search::getCurOptTuple() const {
+inline vector<val_t> Search::getCurOptTuple() const {
   assert(m_space);
-  return m_space->getTrueRoot()->getOptAssig();
+  vector<val_t> tuple;
+  const SearchNode* root = m_space->getTrueRoot();
+  if (root->getSolution())
+    assignSolution(root->getSolution(), m_pseudotree, root->getVar(), tuple);
+  return tuple;
 }
-#endif
 
 }  // namespace daoopt
 
@@ -68,18 +68,17 @@ void SearchMaster::operator ()() {
 
   while ( !this->isDone() ) {
 
-    { // allowedThreads says how many more subproblems can be processed in parallel
-      GETLOCK( m_spaceMaster->mtx_allowedThreads , lk);
-      while (!m_spaceMaster->allowedThreads) {
-        CONDWAIT(m_spaceMaster->cond_allowedThreads,lk);
-      }
-      --m_spaceMaster->allowedThreads;
-    }
+    // allowedThreads says how many more subproblems can be processed in parallel
+    // (only this thread decrements it)
+    m_spaceMaster->waitAllowed.wait(
+        [this]() { return m_spaceMaster->allowedThreads.load() > 0; });
+    --m_spaceMaster->allowedThreads;
+
     // new processing thread can now be started
+    SearchNode* node = NULL;
     {
       GETLOCK(m_spaceMaster->mtx_space, lk); // lock the search space
 
-      SearchNode* node = NULL;
       while (true) {
         /*
          * a single loop iteration will take the next node (top of stack, e.g.)
@@ -92,7 +91,12 @@ void SearchMaster::operator ()() {
         if (doProcess(node)) // * initial processing
           break; // node is dead end
 
-        if (doCaching(node)) // * caching
+        bool cached;
+        {
+          GETLOCK(m_spaceMaster->mtx_cache, lk2);
+          cached = doCaching(node); // * caching
+        }
+        if (cached)
           break; // cached solution found
 
         if (doPruning(node)) // * pruning
@@ -107,40 +111,38 @@ void SearchMaster::operator ()() {
         if (doExpand(node)) // finally, generate child nodes
           break; // no children generated -> leaf node -> propagate
       }
+    } // mtx_space is released
 
-      if ( node->isLeaf() ) { // leaf node, straight to propagation queue
-        GETLOCK(m_spaceMaster->mtx_solved, lk2);
-        m_spaceMaster->leaves.push(node);
-        m_spaceMaster->cond_solved.notify_one();
-      } else if ( node->isExtern() ) {
-
-        // Create new process that 'outsources' subproblem solving, collects the
-        // results and feeds it back into the search space
-        SubproblemCondor subprob(m_spaceMaster, m_nextSubprob, m_nextThreadId);
-        {
-          GETLOCK(m_spaceMaster->mtx_activeThreads, lk2);
-          m_spaceMaster->activeThreads.insert(
-              make_pair( m_nextSubprob , new boost::thread(subprob) )  );
-        }
-        m_nextSubprob = NULL;
-        m_nextThreadId += 1;
-      }
-
-      // mark search as done if needed (before releasing the search space)
-      if ( this->isDone() ) {
-        GETLOCK(m_spaceMaster->mtx_searchDone, lk2);
-        m_spaceMaster->searchDone = true;
+    // (the node stays in the search space until it has been propagated)
+    if ( node->isLeaf() ) { // leaf node, straight to propagation queue
+      m_spaceMaster->leaves.push(node);
+      m_spaceMaster->waitPropagate.notify();
+    } else if ( node->isExtern() ) {
+
+      // Create new process that 'outsources' subproblem solving, collects the
+      // results and feeds it back into the search space
+      SubproblemCondor subprob(m_spaceMaster, m_nextSubprob, m_nextThreadId);
+      {
+        GETLOCK(m_spaceMaster->mtx_activeThreads, lk2);
+        m_spaceMaster->activeThreads.insert(
+            make_pair( m_nextSubprob , new boost::thread(subprob) )  );
       }
+      m_nextSubprob = NULL;
+      m_nextThreadId += 1;
+    }
 
-      // only do a limited number of subprob's?
-      if (m_spaceMaster->options->maxSubprob != NONE &&
-          ((count_t) m_spaceMaster->options->maxSubprob) <= m_nextThreadId) {
-        GETLOCK(m_spaceMaster->mtx_searchDone, lk2);
-        m_spaceMaster->searchDone = true;
-        break; // break the while loop
-      }
+    // mark search as done if needed (after queueing its last leaf/subproblem)
+    bool done = this->isDone();
+    // only do a limited number of subprob's?
+    if (m_spaceMaster->options->maxSubprob != NONE &&
+        ((count_t) m_spaceMaster->options->maxSubprob) <= m_nextThreadId)
+      done = true;
+    if (done) {
+      m_spaceMaster->searchDone = true;
+      m_spaceMaster->waitPropagate.notify();
+      break; // break the while loop
+    }
 
-    } // mtx_space is released
   } // end of while loop
 
   myprint("\t!!! Search done !!!\n");
@@ -245,7 +247,9 @@ bool SearchMaster::doParallelize(SearchNode* node) {
 
   } else {
     estimate = 0;
-    cutoff = (depth == m_space->options->cutoff_depth);
+    // (the dummy root has depth -1, i.e. NONE)
+    cutoff = (m_space->options->cutoff_depth != NONE &&
+              depth == m_space->options->cutoff_depth);
   }
 
   /*
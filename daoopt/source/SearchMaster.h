@@ -71,7 +71,8 @@ protected:
   /* solves the subproblem under the node locally through sequential search */
   virtual void solveLocal(SearchNode*) const = 0;
 
-  SearchMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* s, Heuristic* h);
+  SearchMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* s, Heuristic* h,
+               BoundPropagator* prop, ProgramOptions* po);
 
 protected:
 
@@ -87,10 +88,13 @@ protected:
 };
 
 
-inline SearchMaster::SearchMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* s, Heuristic* h) :
-          Search(prob, pt, s, h), m_nextThreadId(0), m_spaceMaster(s)
+inline SearchMaster::SearchMaster(Problem* prob, Pseudotree* pt, SearchSpaceMaster* s, Heuristic* h,
+                                  BoundPropagator* prop, ProgramOptions* po) :
+          Search(prob, pt, s, h, prop, po), m_nextThreadId(0), m_spaceMaster(s)
 {
   m_spaceMaster->avgStats = new AvgStatistics();
+  // external subproblems are solved out of (depth-first) order
+  m_incrementalPruning = false;
 }
 
 }  // namespace daoopt
@@ -28,6 +28,7 @@
 #include "utils.h"
 #include "SubprobStats.h"  // only for PARALLEL_STATIC
 #include "ExtraNodeInfo.h"
+#include "Solution.h"
 
 namespace daoopt {
 
@@ -77,7 +78,8 @@ protected:
   size_t m_childCountFull;           // Number of total child nodes (initial count)
   size_t m_childCountAct;            // Number of remaining active child nodes
 
-  std::list<std::pair<int, int>> changes_;
+  size_t m_cpMark;                   // constraint propagation trail position
+                                     // before this node's assignment (AND only)
 
 #if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC || TRUE
   count_t m_subCount;                // number of nodes expanded below this node
@@ -87,9 +89,9 @@ protected:
   count_t m_subLeafD;                // cumulative depth of leaf nodes below this node, division
                                      // by m_subLeaves yields average leaf depth
 #endif
-#ifndef NO_ASSIGNMENT
-  vector<val_t> m_optAssignment;     // stores the optimal solution to the subproblem
-#endif
+  SolutionRef m_solution;            // OR: optimal solution to the subproblem,
+                                     // AND: solutions to the solved child subproblems
+                                     // (only set if assignments are tracked)
 
   static context_t emptyCtxt;
   unique_ptr<ExtraNodeInfo> m_eInfo; // stores extra info specific to a heuristic
@@ -117,6 +119,11 @@ public:
   virtual double getOrderingHeur() const { return m_orderingHeurValue; }
 
   inline double & PruningGap(void) { return _PruningGap ; }
+  inline double getPruningGap(void) const { return _PruningGap ; }
+
+  virtual void setAncestorBound(double d, size_t epoch) = 0;
+  virtual double getAncestorBound() const = 0;
+  virtual size_t getAncestorBoundEpoch() const = 0;
 
   virtual void setCacheContext(const context_t&) = 0;
   virtual const context_t& getCacheContext() const = 0;
@@ -167,13 +174,17 @@ public:
 
   bool hasChild(SearchNode* node) const;
   void eraseChild(SearchNode* node);
+  /* removes the child without deleting it, returns it (NULL if not found) */
+  SearchNode* detachChild(SearchNode* node);
   void clearChildren();
 
-#ifndef NO_ASSIGNMENT
-  vector<val_t>& getOptAssig() { return m_optAssignment; }
-  void setOptAssig(const vector<val_t>& assign) { m_optAssignment = assign; }
-  void clearOptAssig() { vector<val_t> v; m_optAssignment.swap(v); }
-#endif
+  const SolutionRef& getSolution() const { return m_solution; }
+  void setSolution(const SolutionRef& s) { m_solution = s; }
+  /* records a flat assignment to the subproblem below this (OR) node */
+  void setSolution(const vector<val_t>& tuple) {
+    m_solution = flatSolution(getVar(), tuple);
+  }
+  void clearSolution() { m_solution.reset(); }
 
   void setLeaf() { m_flags |= FLAG_LEAF; }
   bool isLeaf() const { return m_flags & FLAG_LEAF; }
@@ -201,7 +212,8 @@ public:
   }
   virtual void setExtraNodeInfo(ExtraNodeInfo *inf) { m_eInfo.reset(inf); }
 
-  inline std::list<std::pair<int, int>>& changes() { return changes_; }
+  void setCPMark(size_t m) { m_cpMark = m; }
+  size_t getCPMark() const { return m_cpMark; }
 
 protected:
   SearchNode(SearchNode* parent);
@@ -260,6 +272,9 @@ public:
   const context_t& getCacheContext() const { assert(false); return emptyCtxt; }
   void setCacheInst(size_t i) { assert(false); }
   size_t getCacheInst() const { assert(false); return 0; }
+  void setAncestorBound(double d, size_t epoch) { assert(false); }
+  double getAncestorBound() const { assert(false); return ELEM_ZERO; }
+  size_t getAncestorBoundEpoch() const { assert(false); return 0; }
 #if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC || TRUE
   void setInitialBound(double d) { assert(false); }
   double getInitialBound() const { assert(false); return 0.0; }
@@ -301,6 +316,10 @@ protected:
                                // values of the AND children
   context_t m_cacheContext; // Stores the context (for caching)
 
+  double m_ancestorBound;      // Pruning threshold imposed by the ancestors (see
+                               // Search::ancestorBound), not including this node's value
+  size_t m_ancestorBoundEpoch; // SearchSpace::boundEpoch when the above was computed
+
 #ifdef DECOMPOSE_H_INTO_INDEPENDENT_SUBPROBLEMS
   // this is the portion of parent (AND) node's h values that came from this OR node.
   // this value is computed when the OR-parent of the AND-parent of this node is computed; then a vector for all children is stored in the AND-parent of this node.
@@ -341,6 +360,10 @@ public:
   void setCacheContext(const context_t& t) { m_cacheContext = t; }
   const context_t& getCacheContext() const { return m_cacheContext; }
 
+  void setAncestorBound(double d, size_t epoch) { m_ancestorBound = d; m_ancestorBoundEpoch = epoch; }
+  double getAncestorBound() const { return m_ancestorBound; }
+  size_t getAncestorBoundEpoch() const { return m_ancestorBoundEpoch; }
+
 #ifdef PARALLEL_DYNAMIC
   void setCacheInst(size_t i) { m_cacheInst = i; }
   size_t getCacheInst() const { return m_cacheInst; }
@@ -391,7 +414,8 @@ inline SearchNode::SearchNode(SearchNode* parent) :
     m_flags(0), m_parent(parent), m_nodeValue(ELEM_NAN), m_heurValue(INFINITY),
     m_feasibleValue(ELEM_ZERO),
     _PruningGap(DBL_MAX),
-    m_children(NULL), m_childCountFull(0), m_childCountAct(0)
+    m_children(NULL), m_childCountFull(0), m_childCountAct(0),
+    m_cpMark((size_t) -1)
 #if defined PARALLEL_DYNAMIC || defined PARALLEL_STATIC
   , m_subCount(0)
 #endif
@@ -427,14 +451,18 @@ inline bool SearchNode::hasChild(SearchNode* node) const {
 }
 
 inline void SearchNode::eraseChild(SearchNode* node) {
+  delete detachChild(node);
+}
+
+inline SearchNode* SearchNode::detachChild(SearchNode* node) {
   for (size_t i = 0; i < m_childCountFull; ++i) {
     if (m_children[i] == node) {
-      delete m_children[i];
       m_children[i] = NULL;
       --m_childCountAct;
-      return;
+      return node;
     }
   }
+  return NULL;
 }
 
 inline void SearchNode::clearChildren() {
@@ -478,7 +506,8 @@ inline SearchNodeAND::SearchNodeAND(SearchNode* parent, val_t val, double label)
 
 
 inline SearchNodeOR::SearchNodeOR(SearchNode* parent, int var, int depth) :
-  SearchNode(parent), m_var(var), m_depth(depth), m_heurCache(nullptr)
+  SearchNode(parent), m_var(var), m_depth(depth), m_heurCache(nullptr),
+  m_orderingHeurCache(nullptr), m_ancestorBound(ELEM_ZERO), m_ancestorBoundEpoch(0)
 #ifdef DECOMPOSE_H_INTO_INDEPENDENT_SUBPROBLEMS
   , _heurValueOfParentFromThisNode(DBL_MAX)
 #endif // DECOMPOSE_H_INTO_INDEPENDENT_SUBPROBLEMS
@@ -24,9 +24,6 @@
 #ifndef SEARCHSPACE_H_
 #define SEARCHSPACE_H_
 
-/* max. number of concurrent threads for subproblem processing */
-#define MAX_THREADS 7
-
 //#include <set>
 
 #include "SearchNode.h"
@@ -34,6 +31,7 @@
 #ifdef PARALLEL_DYNAMIC
 #include "Subproblem.h"
 #include "Statistics.h"
+#include "RingBuffer.h"
 #endif /* PARALLEL_DYNAMIC */
 
 #ifndef NO_CACHING
@@ -111,9 +109,16 @@ class SearchSpace {
 
   SearchStats stats;        // keeps track of various node stats
 
+  size_t boundEpoch;            // advanced whenever node values change such that the
+                                // cached ancestor pruning thresholds may be too loose
+
   SearchNode* getTrueRoot() const;
   SearchNode* getRoot() const { return root; }
   void setRoot(SearchNode* node) { root = node; }
+  /* discards the search space (but keeps the cache tables' memory) for a
+   * new search over the same pseudo tree; with keepCache, the cached
+   * subproblem values are kept as well (if they still apply) */
+  void reset(bool keepCache = false);
   SearchSpace(Pseudotree* pt, ProgramOptions* opt);
   virtual ~SearchSpace();
 };
@@ -121,7 +126,8 @@ class SearchSpace {
 
 
 inline SearchSpace::SearchSpace(Pseudotree* pt, ProgramOptions* opt) :
-    root(NULL), subproblemLocal(NULL), options(opt), pseudotree(pt), cache(NULL)
+    root(NULL), subproblemLocal(NULL), options(opt), pseudotree(pt), cache(NULL),
+    boundEpoch(1)
 { /* intentionally empty at this point */ }
 
 inline SearchSpace::~SearchSpace() {
@@ -131,6 +137,23 @@ inline SearchSpace::~SearchSpace() {
     delete cache;
 }
 
+inline void SearchSpace::reset(bool keepCache) {
+  if (root)
+    delete root;
+  root = NULL;
+  subproblemLocal = NULL;
+#ifndef NO_CACHING
+  if (cache && !keepCache)
+    cache->clear();
+#endif
+  size_t n = stats.numORVar.size();
+  stats = SearchStats();
+  stats.numORVar.resize(n, 0);
+  stats.numANDVar.resize(n, 0);
+  stats.numProcORVar.resize(n, 0);
+  stats.numProcANDVar.resize(n, 0);
+}
+
 /* returns the relevant root node in both conditioned and unconditioned cases */
 inline SearchNode* SearchSpace::getTrueRoot() const {
   assert(root);
@@ -148,37 +171,39 @@ struct SearchSpaceMaster : public SearchSpace {
 
   AvgStatistics* avgStats; // keeps track of subproblem statistics by averaging
 
-  /* queue for information exchange between components */
-  queue< Subproblem* > solved; // for externally solved subproblems
-  queue< SearchNode* > leaves; // for fully solved leaf nodes
+  /* limits the number of processing leaves/threads at any time (-threads),
+   * which also bounds the number of entries in the queues below */
+  const size_t maxThreads;
+  std::atomic<size_t> allowedThreads;
+  RingWaiter waitAllowed;  // search waits for allowedThreads > 0
+
+  /* lock-free queues for information exchange between components; the
+   * propagation thread is the only consumer of 'solved' and 'leaves' */
+  RingBuffer< Subproblem* > solved; // for externally solved subproblems
+  RingBuffer< SearchNode* > leaves; // for fully solved leaf nodes
+  RingWaiter waitPropagate;  // propagation waits for solved/leaves (or the end)
   map< Subproblem*, boost::thread* > activeThreads;
 
   /* for pipelining the condor submissions */
-  queue< CondorSubmission* > condorQueue;
-  boost::mutex mtx_condorQueue;
-  boost::condition_variable_any cond_condorQueue;
+  RingBuffer< CondorSubmission* > condorQueue;
+  RingWaiter waitCondorQueue;
   /* to signal SubproblemHandlers that their job has been submitted */
   boost::condition_variable_any cond_jobsSubmitted;
 
-  /* limits the number of processing leaves/threads at any time */
-  volatile size_t allowedThreads;
-  boost::mutex mtx_allowedThreads;
-  boost::condition_variable_any cond_allowedThreads;
-
-  /* counts the number of active threads */
-  volatile bool searchDone;
-  boost::mutex mtx_searchDone;
+  /* set by the search thread once it won't produce more leaves/subproblems */
+  std::atomic<bool> searchDone;
 
-  /* mutex and condition variable for search space *and* cache */
+  /* mutex for the search space nodes (the search stack and subproblem
+   * bookkeeping are only accessed by the search thread; subproblems removed
+   * by the propagation are freed outside of it) */
   boost::mutex mtx_space;
 
+  /* mutex for the cache, taken after mtx_space where both are needed */
+  boost::mutex mtx_cache;
+
   /* mutex for Statistics object */
   boost::mutex mtx_stats;
 
-  /* mutex and condition var. for the list of solved leaf nodes */
-  boost::mutex mtx_solved;
-  boost::condition_variable_any cond_solved;
-
   /* mutex for active threads */
   boost::mutex mtx_activeThreads;
 
@@ -192,10 +217,10 @@ struct SearchSpaceMaster : public SearchSpace {
 
 
 inline SearchSpaceMaster::SearchSpaceMaster(Pseudotree* pt, ProgramOptions* opt) :
-    SearchSpace(pt, opt), allowedThreads(MAX_THREADS), searchDone(false)
-{
-  if (options) allowedThreads = opt->threads;
-}
+    SearchSpace(pt, opt), maxThreads(max(opt->threads, 1)),
+    allowedThreads(maxThreads), solved(maxThreads), leaves(maxThreads),
+    condorQueue(maxThreads), searchDone(false)
+{ /* nothing here */ }
 
 inline SearchSpaceMaster::~SearchSpaceMaster() {
   if (avgStats) delete avgStats;
@@ -0,0 +1,71 @@
+/*
+ * Semiring.h
+ *
+ *  Semirings over daoopt's value representation (log10 under USE_LOG),
+ *  used to instantiate the task-dependent kernels -- mini-bucket
+ *  elimination and OR node value propagation -- for both max-product (MPE)
+ *  and sum-product (probability of evidence). The instance to run is
+ *  chosen at runtime via the -task option.
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEMIRING_H_
+#define SEMIRING_H_
+
+#include "_base.h"
+
+namespace daoopt {
+
+/* names of the inference tasks accepted by -task */
+const string TASK_MPE = "mpe";  // max-product, most probable explanation
+const string TASK_PR = "pr";    // sum-product, probability of evidence
+
+inline bool isValidTask(const string& task) {
+  return task == TASK_MPE || task == TASK_PR;
+}
+
+/*
+ * A semiring provides zero(), one(), times() and plus(). 'idempotent' is
+ * true if plus() selects one of its arguments; only then can search prune
+ * against an incumbent and stop propagating values that don't improve.
+ *
+ * (Min-sum over costs is max-product under negation of the log values, so
+ * it needs no instance of its own here.)
+ */
+struct MaxProduct {
+  static const bool idempotent = true;
+  static inline double zero() { return ELEM_ZERO; }
+  static inline double one() { return ELEM_ONE; }
+  static inline double times(double a, double b) { return a OP_TIMES b; }
+  static inline double plus(double a, double b) { return (a < b) ? b : a; }
+};
+
+struct SumProduct {
+  static const bool idempotent = false;
+  static inline double zero() { return ELEM_ZERO; }
+  static inline double one() { return ELEM_ONE; }
+  static inline double times(double a, double b) { return a OP_TIMES b; }
+#ifdef USE_LOG
+  static inline double plus(double a, double b) { return log10SumExp(a, b); }
+#else
+  static inline double plus(double a, double b) { return a + b; }
+#endif
+};
+
+}  // namespace daoopt
+
+#endif /* SEMIRING_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Solution.cpp
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Solution.h"
+#include "Pseudotree.h"
+
+namespace daoopt {
+
+void Solution::assign(const Pseudotree* pt, const vector<int>& varMap,
+                      vector<val_t>& assig) const {
+  // walks the records iteratively, solution trees can be as deep as the
+  // pseudo tree
+  vector<const Solution*> stack(1, this);
+  while (!stack.empty()) {
+    const Solution* s = stack.back();
+    stack.pop_back();
+    if (s->m_flat) {
+      const vector<val_t>& tuple = static_cast<const FlatSolution*>(s)->m_tuple;
+      const vector<int>& vars = pt->getNode(s->m_var)->getSubprobVars();
+      // (tuples from outside the search may lack the trailing dummy variable)
+      assert(tuple.size() <= vars.size());
+      for (size_t i = 0; i < tuple.size(); ++i) {
+        if (tuple[i] != UNKNOWN)
+          assig.at(varMap.at(vars[i])) = tuple[i];
+      }
+    } else if (s->m_var != NONE) {
+      assig.at(varMap.at(s->m_var)) = s->m_val;
+    }
+    if (s->m_rest)
+      stack.push_back(s->m_rest.get());
+    if (s->m_first)
+      stack.push_back(s->m_first.get());
+  }
+}
+
+
+void Solution::destroy(const Solution* s) {
+  // releases the links iteratively, chains of records that lose their last
+  // reference at once can be as long as the search got deep
+  vector<const Solution*> dead(1, s);
+  while (!dead.empty()) {
+    Solution* d = const_cast<Solution*>(dead.back());
+    dead.pop_back();
+    const Solution* links[2] = { d->m_first.detach(), d->m_rest.detach() };
+    for (const Solution* l : links) {
+      if (l && --l->m_refs == 0)
+        dead.push_back(l);
+    }
+    if (d->m_flat)
+      delete static_cast<FlatSolution*>(d);
+    else
+      delete d;
+  }
+}
+
+
+void assignSolution(const SolutionRef& s, const Pseudotree* pt, int var,
+                    vector<val_t>& assig) {
+  const PseudotreeNode* ptnode = pt->getNode(var);
+  assig.assign(ptnode->getSubprobVars().size(), UNKNOWN);
+  if (s)
+    s->assign(pt, ptnode->getSubprobVarMap(), assig);
+}
+
+}  // namespace daoopt
@@ -0,0 +1,141 @@
+/*
+ * Solution.h
+ *
+ *  Optimal subproblem assignments as recorded by depth-first search when
+ *  assignments are tracked (-track_assignment).
+ *
+ *  This file is part of DAOOPT.
+ *
+ *  DAOOPT is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  DAOOPT is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with DAOOPT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLUTION_H_
+#define SOLUTION_H_
+
+#include "_base.h"
+
+#include <atomic>
+#include <boost/intrusive_ptr.hpp>
+
+namespace daoopt {
+
+class Pseudotree;
+class Solution;
+
+typedef boost::intrusive_ptr<const Solution> SolutionRef;
+
+/*
+ * Solutions are recorded as backpointers: the record of an OR node holds
+ * the value of its variable (i.e., the best AND child) and links to the
+ * records of the subproblems below that AND node. Records are immutable
+ * once built and shared between search nodes, cache entries and the records
+ * above them, so a new best solution at an OR node costs a single small
+ * allocation, independent of the subproblem size. The full assignment is
+ * only assembled by assign(), when a new solution gets reported.
+ *
+ * Each record has two links, the assignment it stands for is its own
+ * var=val (unless var is NONE) joined with the ones of both links. Longer
+ * lists of subproblems, e.g. the solved children of an AND node, are chained
+ * through records with var NONE.
+ *
+ * (Records are only shared within one search space. The reference count
+ * is atomic for the parallel master, which frees solved subproblems outside
+ * of the search space lock.)
+ */
+class Solution {
+ protected:
+  int m_var;           // the recorded variable (NONE for links only)
+  val_t m_val;         // its value
+  bool m_flat;         // is a FlatSolution
+#ifdef PARALLEL_DYNAMIC
+  mutable std::atomic<unsigned> m_refs;
+#else
+  mutable unsigned m_refs;
+#endif
+  SolutionRef m_first;
+  SolutionRef m_rest;
+
+  friend void intrusive_ptr_add_ref(const Solution* s);
+  friend void intrusive_ptr_release(const Solution* s);
+
+  /* deletes s, which is no longer referenced, along with the records that
+   * are only referenced through it */
+  static void destroy(const Solution* s);
+
+ public:
+  /* writes the assignment into 'assig', which is indexed through 'varMap'
+   * (the subprobVarMap of the pseudo tree node of this or an ancestor
+   * subproblem); variables without a recorded value are left untouched */
+  void assign(const Pseudotree* pt, const vector<int>& varMap,
+              vector<val_t>& assig) const;
+
+ public:
+  Solution(int var, val_t val, const SolutionRef& first, const SolutionRef& rest)
+    : m_var(var), m_val(val), m_flat(false), m_refs(0),
+      m_first(first), m_rest(rest) {}
+};
+
+/*
+ * Solutions that weren't found by this search (initial bounds, externally
+ * solved subproblems) are kept as a flat tuple over the variables of the
+ * subproblem rooted at 'var', indexed like its pseudo tree node's
+ * subprobVars.
+ */
+class FlatSolution : public Solution {
+ protected:
+  vector<val_t> m_tuple;
+  friend class Solution;
+
+ public:
+  FlatSolution(int var, const vector<val_t>& tuple)
+    : Solution(var, UNKNOWN, SolutionRef(), SolutionRef()), m_tuple(tuple) {
+    m_flat = true;
+  }
+};
+
+inline void intrusive_ptr_add_ref(const Solution* s) {
+  ++s->m_refs;
+}
+
+inline void intrusive_ptr_release(const Solution* s) {
+  if (--s->m_refs == 0)
+    Solution::destroy(s);
+}
+
+/* returns the record for assignment var=val joined with 'first' and 'rest' */
+inline SolutionRef makeSolution(int var, val_t val, const SolutionRef& first,
+                                const SolutionRef& rest) {
+  return SolutionRef(new Solution(var, val, first, rest));
+}
+
+/* returns the record for both solutions a and b (either may be NULL) */
+inline SolutionRef joinSolutions(const SolutionRef& a, const SolutionRef& b) {
+  if (!a) return b;
+  if (!b) return a;
+  return makeSolution(NONE, UNKNOWN, a, b);
+}
+
+/* returns the record for a flat tuple over the subproblem below 'var' */
+inline SolutionRef flatSolution(int var, const vector<val_t>& tuple) {
+  return SolutionRef(new FlatSolution(var, tuple));
+}
+
+/* assembles the assignment to the subproblem of pseudo tree node 'var' from
+ * record 's' into 'assig' (sized and indexed like the node's subprobVars) */
+void assignSolution(const SolutionRef& s, const Pseudotree* pt, int var,
+                    vector<val_t>& assig);
+
+}  // namespace daoopt
+
+#endif /* SOLUTION_H_ */
@@ -79,6 +79,8 @@ inline void SubproblemStats::update(SearchNode* n, PseudotreeNode* pt, count_t c
 
 #include "Subproblem.h"
 
+namespace daoopt {
+
 /**
  * keeps track of subproblem statistics, used for complexity estimates
  */
@@ -145,6 +147,7 @@ inline AvgStatistics::AvgStatistics() :
     _alpha(1.0), _beta(0.5), _gamma(1.0)
 { /* intentionally empty */ }
 
+}  // namespace daoopt
 
 #endif /* PARALLEL_DYNAMIC */
 
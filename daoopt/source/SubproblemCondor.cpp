@@ -74,11 +74,8 @@ void SubproblemCondor::operator() () {
   try {
 
   // pass subproblem to CondorSubmissionEngine
-  {
-    GETLOCK(m_spaceMaster->mtx_condorQueue,lk);
-    m_spaceMaster->condorQueue.push(&job);
-    NOTIFY(m_spaceMaster->cond_condorQueue);
-  }
+  m_spaceMaster->condorQueue.push(&job);
+  m_spaceMaster->waitCondorQueue.notify();
 
   // wait for signal from CondorSubmissionEngine
   {
@@ -114,18 +111,19 @@ void SubproblemCondor::operator() () {
   BINREAD(in, nodesOR);
   BINREAD(in, nodesAND);
 
-#ifndef NO_ASSIGNMENT
-  int n;
-  BINREAD(in, n); // read length of opt. tuple
+  vector<val_t> tup;
+  if (m_spaceMaster->options->trackAssignment) {
+    int n;
+    BINREAD(in, n); // read length of opt. tuple
 
-  vector<val_t> tup(n,UNKNOWN);
+    tup.resize(n,UNKNOWN);
 
-  int v; // assignment saved as int, regardless of internal type
-  for (int i=0; i<n; ++i) {
-    BINREAD(in, v); // read opt. assignments
-    tup[i] = (val_t) v;
+    int v; // assignment saved as int, regardless of internal type
+    for (int i=0; i<n; ++i) {
+      BINREAD(in, v); // read opt. assignments
+      tup[i] = (val_t) v;
+    }
   }
-#endif
 
   // read node profiles
   int size;
@@ -147,9 +145,7 @@ void SubproblemCondor::operator() () {
 
   // Write subproblem solution value and tuple into search node
   m_subproblem->root->setValue(optCost);
-#ifndef NO_ASSIGNMENT
-  m_subproblem->root->setOptAssig(tup);
-#endif
+  m_subproblem->root->setSolution(tup);
   // Write number of OR/AND nodes into subproblem
   m_subproblem->nodesOR  = nodesOR;
   m_subproblem->nodesAND = nodesAND;
@@ -176,11 +172,8 @@ void SubproblemCondor::operator() () {
   // clean up pointers
   if (waitProc) delete waitProc;
 
-  {
-    GETLOCK(m_spaceMaster->mtx_solved, lk);
-    m_spaceMaster->solved.push(m_subproblem); // push node to solved queue
-    m_spaceMaster->cond_solved.notify_one();
-  }
+  m_spaceMaster->solved.push(m_subproblem); // push node to solved queue
+  m_spaceMaster->waitPropagate.notify();
 
 }
 
@@ -306,19 +299,15 @@ void CondorSubmissionEngine::operator ()() {
     // start collecting jobs for this batch
     do {
       {
-        GETLOCK(m_spaceMaster->mtx_condorQueue, lk);
-
         if (waitForCond) {
-          while (m_spaceMaster->condorQueue.empty())
-            CONDWAIT(m_spaceMaster->cond_condorQueue, lk); // releases lock
+          m_spaceMaster->waitCondorQueue.wait(
+              [this]() { return !m_spaceMaster->condorQueue.empty(); });
           waitForCond = false;
         }
 
         // collect all jobs
-        if (m_spaceMaster->condorQueue.size()) {
-          while (m_spaceMaster->condorQueue.size()) {
-            nextJob = m_spaceMaster->condorQueue.front();
-            m_spaceMaster->condorQueue.pop();
+        if (!m_spaceMaster->condorQueue.empty()) {
+          while (m_spaceMaster->condorQueue.tryPop(nextJob)) {
             localQ.push(nextJob); // store pointer locally
           }
         } else {
@@ -332,7 +321,7 @@ void CondorSubmissionEngine::operator ()() {
           submitToCondor(jobFile); // also notifies waiting SubproblemHandlers
           waitForCond = true;
         }
-      } // lock mtc_condorQueue is released here
+      }
 
       // wait a little before checking again
       if (!waitForCond)
@@ -101,10 +101,7 @@ inline SubproblemCondor::SubproblemCondor(SearchSpaceMaster* p, Subproblem* n, s
 
 /* puts the submission engine to sleep for s seconds */
 inline void CondorSubmissionEngine::mysleep(size_t s) {
-  boost::xtime xt;
-  boost::xtime_get(&xt, boost::TIME_UTC);
-  xt.sec += s;
-  boost::thread::sleep(xt);
+  boost::this_thread::sleep(boost::posix_time::seconds(s));
 }
 
 inline CondorSubmissionEngine::CondorSubmissionEngine(SearchSpaceMaster* p)
@@ -110,7 +110,8 @@ static boost::mutex mtx_io;
 #define ELEM_ONE 0.0
 
 //#define OP_PLUS(X,Y) ( (X==Y) ? (X+log10(2.0)) : ( ( X > Y ) ? ( X + log10(1.0 + pow(10.0, Y-X ))) : ( Y + log10(1.0 +pow(10.0, X-Y ) )) ) )
-#define OP_PLUS(X,Y) ( ( X > Y ) ? ( X + log10(1.0 + pow(10.0, Y-X ))) : ( Y + log10(1.0 +pow(10.0, X-Y ) )) )
+//#define OP_PLUS(X,Y) ( ( X > Y ) ? ( X + log10(1.0 + pow(10.0, Y-X ))) : ( Y + log10(1.0 +pow(10.0, X-Y ) )) )
+#define OP_PLUS(X,Y) daoopt::log10SumExp( X , Y )
 //#define OP_PLUS(X,Y) ( log10( pow(10.0, X ) + pow(10.0, Y ) ) )
 #define OP_MINUS(X,Y) ( ( X > Y ) ? ( X + log10(1.0 - pow(10.0, Y-X ))) : ( Y + log10(pow(10.0, X-Y ) - 1.0 )) )
 //#define OP_MINUS(X,Y) ( ( X > Y ) ? ( X + log(1.0 - exp( Y-X ))) : ( Y + log(exp( X-Y ) - 1.0 )) )
@@ -415,6 +416,15 @@ public:
   }
 
 };
+
+/* log10(10^a + 10^b), with a single exp()/log1p() and correct handling
+ * of zero (-inf) arguments */
+inline double log10SumExp(double a, double b) {
+  if (a < b) std::swap(a, b);
+  if (b == - std::numeric_limits<double>::infinity())
+    return a;
+  return a + log1p(exp((b - a) * M_LN10)) * M_LOG10E;
+}
 }  // namespace daoopt
 
 /*//////////////////////////////*/
@@ -91,6 +91,17 @@ static inline string& trim(string& s) {
   return ltrim(rtrim(s));
 }
 
+/* FNV-1a hash of n bytes, can be chained by passing the previous hash */
+inline uint64 hashBytes(const void* data, size_t n,
+                        uint64 h = 14695981039346656037ULL) {
+  const unsigned char* p = (const unsigned char*) data;
+  for (size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
 
 /*
  * increments the tuple value, up to each entry's limit. Returns false
@@ -32,17 +32,53 @@ DEFINE_string(ordering_file, "",
               "read elimination ordering from this file (first to last), or"
               "write elimination ordering to this file if it does not exist");
 DEFINE_string(algorithm, "aobb", "search algorithm to use (aobb,aobf)");
+DEFINE_string(task, "mpe",
+              "inference task: mpe (max-product) or pr (probability of "
+              "evidence, sum-product; aobb without pruning)");
 
 DEFINE_bool(adaptive, false, "enable adaptive ordering scheme");
 DEFINE_int32(max_time, kint32max, "timeout threshold in seconds");
+DEFINE_bool(schedule, false,
+            "split -max_time (and -mem_limit) across the preprocessing stages "
+            "(SLS, ordering, FGLP/JGLP, i-bound, LDS) and search");
 DEFINE_string(minibucket_file, "", "path to read/store minibucket heuristic");
+DEFINE_bool(minibucket_mmap, false,
+            "use an uncompressed, page-aligned minibucket file that is mapped "
+            "read-only (and thus shared by solver processes on the same "
+            "problem, ordering and i-bound)");
 DEFINE_string(subproblem_file, "",
               "path to subproblem specification to limit search to");
 DEFINE_int32(suborder, 0,
              "subproblem order "
              "(0:width-inc 1:width-dec 2:heur-inc 3:heur-dec)");
+DEFINE_string(value_order, "heur",
+              "value ordering policy for AOBB (options: heur, ordering_heur, "
+              "incumbent (weighted by rate of new incumbents), "
+              "gap (by pruning gap history))");
+DEFINE_string(portfolio, "",
+              "search configurations to run in parallel with the main one, "
+              "sharing problem, ordering and incumbent; ';'-separated, each "
+              "a ','-separated list of key=value (keys: i, algorithm, "
+              "rotate, rotate_limit, value_order, suborder_policy), "
+              "e.g. \"i=8;i=14,rotate=1;algorithm=aobf\"");
+DEFINE_string(serve, "",
+              "after preprocessing, answer MPE queries with different "
+              "evidence (one per line, UAI evidence format) instead of "
+              "searching once; '-' reads from stdin and answers on stdout "
+              "(all other output goes to stderr), otherwise the path of a "
+              "Unix socket to listen on");
+DEFINE_string(suborder_policy, "",
+              "subproblem ordering policy for AOBB, overrides -suborder "
+              "(options: pseudotree, heur-inc, heur-dec, prune-first)");
 DEFINE_string(sol_file, "", "path to output optimal solution to");
 DEFINE_string(out_bound_file, "", "path to output current best solution to");
+DEFINE_string(event_feed, "",
+              "file, FIFO or unix:<socket path> to stream solution and bound "
+              "updates to");
+DEFINE_string(event_format, "json",
+              "event feed format: json (one object per line) or binary");
+DEFINE_bool(event_assignment, false,
+            "include the solution assignments in the event feed");
 
 DEFINE_int32(order_iterations, 25, "iterations for finding ordering");
 DEFINE_int32(order_time, -1, "maximum time for finding ordering");
@@ -56,8 +92,35 @@ DEFINE_double(cvo_e_random_pick, 0.0,
              "CVO: parameter for randomly choosing from the pool "
              "0 - uniform distribution, <0 - prefer lower cost, "
              ">0 - prefer higher cost");
+DEFINE_int32(threads, 1,
+             "number of threads (CVO ordering search; max. parallel "
+             "subproblems in parallel builds)");
+#ifdef PARALLEL_DYNAMIC
+DEFINE_int32(cutoff_depth, -1,
+             "fixed depth at which the master outsources subproblems");
+DEFINE_int32(cutoff_width, -1,
+             "master solves subproblems up to this width locally");
+DEFINE_int32(cutoff_size, -1,
+             "subproblem size (in 10^5 nodes) to outsource at, "
+             "with -auto_cutoff");
+DEFINE_int32(local_size, -1,
+             "subproblem size (in 10^5 nodes) to solve locally, "
+             "with -auto_cutoff");
+DEFINE_bool(auto_cutoff, false,
+            "master decides about outsourcing from estimated subproblem sizes");
+DEFINE_int32(init_nodes, -1,
+             "nodes (in 10^5) the master explores to initialize the "
+             "estimates for -auto_cutoff");
+DEFINE_int32(max_subprob, -1,
+             "only generate this many subproblems, then abort (for testing)");
+DEFINE_string(tag, "", "tag of the run, to name the temporary files");
+#endif
 
 DEFINE_int32(ibound, 10, "i-bound for minibucket heuristics");
+DEFINE_int32(ibound_select, 0,
+             "choose the i-bound that minimizes the predicted build plus "
+             "search time, estimating the search with this many probes per "
+             "i-bound (0: off, use -ibound)");
 DEFINE_int32(cbound, 1000, "context size bound for caching");
 
 DEFINE_int32(fglp_iterations, -1, "do FGLP preprocessing (# iterations)");
@@ -71,10 +134,29 @@ DEFINE_bool(use_incremental_jglp, false, "use incremental JGLP");
 DEFINE_double(jglp_tolerance, 1e-3, "convergence tolerance for JGLP");
 DEFINE_double(jglp_inc_tolerance, 1e-5,
               "convergence toleraance for incremental JGLP runs");
+DEFINE_bool(jglp_timing, false,
+            "report the time spent converting functions to and from JGLP's "
+            "factors");
 
 DEFINE_bool(rotate, false, "use breadth-rotating AOBB");
 DEFINE_int32(rotate_limit, 1000,
              "nodes per subproblem stack rotation (0: disabled)");
+DEFINE_bool(dive, false,
+            "AOBB performs a heuristic-guided dive into every new subproblem "
+            "first (better anytime behavior)");
+DEFINE_int32(lazy_prop, 0,
+             "AOBB defers propagating the values of unfinished subproblems, "
+             "flushing them to the root after at most this many leaf nodes "
+             "(0: propagate eagerly)");
+DEFINE_double(weight, 1.0,
+              "anytime weighted search: run AOBB/AOBF with the heuristic "
+              "weighted by this factor first, then with decreasing weights "
+              "down to 1 (1: disabled)");
+DEFINE_string(weight_schedule, "sqrt",
+              "how the weight decreases between weighted searches (options: "
+              "sqrt, sub:<step>, div:<factor>)");
+DEFINE_bool(track_assignment, false,
+            "record and output the optimal assignment, not just its cost");
 
 DEFINE_string(bound_file, "", "file with initial lower bound on solution cost");
 DEFINE_double(initial_bound, ELEM_NAN, "initial lower bound on solution cost");
@@ -82,6 +164,12 @@ DEFINE_double(initial_bound, ELEM_NAN, "initial lower bound on solution cost");
 DEFINE_int32(sls_algo, 0,
              "0: default incremental GLS+, 1: GLS+, 2: hybrid SLS");
 DEFINE_double(sls_converge_rate, 2.0, "SLS convergance rate");
+DEFINE_int32(sls_threads, 1, "Number of concurrent SLS runs (distinct seeds)");
+DEFINE_string(sls_algos, "",
+              "comma-separated SLS algorithm per concurrent run "
+              "(cycled, overrides -sls_algo)");
+DEFINE_bool(sls_background, false,
+            "keep SLS running in the background during search");
 
 
 DEFINE_int32(sls_iterations, 0, "Number of initial SLS iterations");
@@ -90,7 +178,15 @@ DEFINE_int32(sls_time, 5, "Time per SLS iteration");
 
 DEFINE_int32(lds_limit, -1,
              "run initial LDS search with given limit (-1: disabled)");
-
+DEFINE_int32(lds_threads, 1,
+             "number of concurrent LDS probes; >1 also probes all lower "
+             "limits and label-ordered values, sharing the incumbent");
+DEFINE_int32(lds_time, -1,
+             "wall-clock budget for initial LDS in seconds (-1: none)");
+
+DEFINE_int32(estimate_probes, 0,
+             "estimate the search space size from this many random probes "
+             "before search (in parallel, cf. -threads)");
 DEFINE_int32(mem_limit, -1, "approximate memory limit for minibuckets (in MB)");
 DEFINE_int32(seed, -1, "seed for random number generator, time() otherwise");
 
@@ -116,6 +212,9 @@ DEFINE_bool(heuristic_fglp_mbe_hybrid, false,
 DEFINE_bool(heuristic_fglp_mbe_choice, false,
             "use pure FGLP dyanmic heuristic if the i-bound is less "
             "than half the width; otherwise, use MBE");
+DEFINE_bool(heuristic_arp_mbe, false,
+            "compile the mini bucket heuristic with ARP's bucket elimination "
+            "workspace");
 
 DEFINE_bool(dfglp_shifted_labels, false, "use shifted labels induced by FGLP");
 DEFINE_bool(dfglp_nullary_shift, false,
@@ -149,6 +248,9 @@ DEFINE_int32(lookahead_n_be_abs_error_to_include, INT_MAX,
 DEFINE_bool(lookahead_reuse_identical_subtrees, false,
             "lookahead: cache results of ancestor subtrees when possible. "
             "(This should only be used when the search is depth-first.)");
+DEFINE_bool(lookahead_memo, false,
+            "lookahead: memoize subtree results by context, using at most "
+            "lookahead_local_error_all_tables_total_limit entries");
 DEFINE_double(lookahead_starting_probability, 1.0,
              "initial probability of performing lookahead");
 DEFINE_double(lookahead_min_probability, 0.2,
@@ -184,7 +286,12 @@ DEFINE_int32(aobf_subordering_depth_limit, -1,
 
 // Constraint propagation
 DEFINE_string(cp_type, "NONE", "use constraint propagation "
-              "(options: UNIT (zchaff))");
+              "(options: UNIT (incremental, over zero entries), "
+              "FULL (minisat))");
+DEFINE_int32(cp_nogoods, 0, "max. number of nogoods learned from dead-ends "
+             "kept by the UNIT propagator (0: no learning)");
+DEFINE_int32(cp_nogood_size, 10, "max. number of assignments in a learned "
+             "nogood");
 
 DEFINE_string(pst_file, "", "path to output the pseudotree to, for plotting");
 DEFINE_string(supplemental_log_file, "", "path to supplmental log file");
@@ -210,6 +317,7 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
 
 
     opt->algorithm = FLAGS_algorithm;
+    opt->task = FLAGS_task;
 
     opt->in_problemFile = FLAGS_input_file;
     opt->in_evidenceFile = FLAGS_evid_file;
@@ -219,14 +327,33 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
     opt->in_subproblemFile = FLAGS_subproblem_file;
     opt->out_solutionFile = FLAGS_sol_file;
     opt->out_boundFile = FLAGS_out_bound_file;
+    opt->eventFeed = FLAGS_event_feed;
+    opt->eventFormat = FLAGS_event_format;
+    opt->eventAssignment = FLAGS_event_assignment;
     opt->in_minibucketFile = FLAGS_minibucket_file;
+    opt->minibucketMmap = FLAGS_minibucket_mmap;
     opt->subprobOrder = FLAGS_suborder;
     if (opt->subprobOrder < 0 || opt->subprobOrder > 3) {
       cout << "Invalid subproblem order" << endl;
       exit(0);
     }
+    opt->valueOrdering = FLAGS_value_order;
+    opt->subprobOrdering = FLAGS_suborder_policy;
+    opt->portfolio = FLAGS_portfolio;
+    opt->schedule = FLAGS_schedule;
+    opt->serve = FLAGS_serve;
+    if (!ValueOrdering::isValidName(opt->valueOrdering)) {
+      cout << "Invalid value ordering policy" << endl;
+      exit(0);
+    }
+    if (opt->subprobOrdering != "" &&
+        !SubproblemOrdering::isValidName(opt->subprobOrdering)) {
+      cout << "Invalid subproblem ordering policy" << endl;
+      exit(0);
+    }
 
     opt->ibound = FLAGS_ibound;
+    opt->iboundSelect = FLAGS_ibound_select;
     opt->cbound = FLAGS_cbound;
     opt->cbound_worker = FLAGS_cbound;
     opt->mplp = FLAGS_fglp_iterations;
@@ -239,6 +366,7 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
     opt->fglpHeur = FLAGS_heuristic_fglp;
     opt->fglpMBEHeur = FLAGS_heuristic_fglp_mbe_hybrid;
     opt->fglpMBEHeurChoice = FLAGS_heuristic_fglp_mbe_choice;
+    opt->arpMBEHeur = FLAGS_heuristic_arp_mbe;
 
     opt->useShiftedLabels = FLAGS_dfglp_shifted_labels;
     opt->useNullaryShift = FLAGS_dfglp_nullary_shift;
@@ -251,6 +379,7 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
     opt->incrementalJG = FLAGS_use_incremental_jglp;
     opt->jglpt = FLAGS_jglp_tolerance;
     opt->jglpc = FLAGS_jglp_inc_tolerance;
+    opt->jglpTiming = FLAGS_jglp_timing;
 
     opt->lookaheadDepth = FLAGS_lookahead_depth;
     opt->lookahead_LE_SingleTableLimit =
@@ -265,6 +394,7 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
         FLAGS_lookahead_subtree_size_limit;
     opt->nBEabsErrorToInclude =
         FLAGS_lookahead_n_be_abs_error_to_include;
+    opt->lookaheadMemo = FLAGS_lookahead_memo;
     // use lookahead ancestor caching by default only if search is depth-first
     // otherwise, ensure it's false.
     if (opt->algorithm != "aobb") {
@@ -280,14 +410,31 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
     opt->order_cvo = FLAGS_cvo;
     opt->cvo_n_random_pick = FLAGS_cvo_n_random_pick;
     opt->cvo_e_random_pick = FLAGS_cvo_e_random_pick;
+    opt->threads = FLAGS_threads;
+#ifdef PARALLEL_DYNAMIC
+    opt->cutoff_depth = FLAGS_cutoff_depth;
+    opt->cutoff_width = FLAGS_cutoff_width;
+    opt->cutoff_size = FLAGS_cutoff_size;
+    opt->local_size = FLAGS_local_size;
+    opt->autoCutoff = FLAGS_auto_cutoff;
+    opt->nodes_init = FLAGS_init_nodes;
+    opt->maxSubprob = FLAGS_max_subprob;
+    opt->runTag = FLAGS_tag;
+#endif
 
     opt->in_boundFile = FLAGS_bound_file;
     opt->initialBound = FLAGS_initial_bound;
 
     opt->lds = FLAGS_lds_limit;
+    opt->ldsThreads = FLAGS_lds_threads;
+    opt->ldsTime = FLAGS_lds_time;
+    opt->estimateProbes = FLAGS_estimate_probes;
 
     opt->slsAlgo = FLAGS_sls_algo;
     opt->slsConvergeRate = FLAGS_sls_converge_rate;
+    opt->slsThreads = FLAGS_sls_threads;
+    opt->slsAlgos = FLAGS_sls_algos;
+    opt->slsBackground = FLAGS_sls_background;
 
     opt->slsIter = FLAGS_sls_iterations;
     opt->slsTime = FLAGS_sls_time;
@@ -302,6 +449,11 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
 
     opt->rotate = FLAGS_rotate;
     opt->rotateLimit = FLAGS_rotate_limit;
+    opt->dive = FLAGS_dive;
+    opt->lazyProp = FLAGS_lazy_prop;
+    opt->weight = FLAGS_weight;
+    opt->weightSchedule = FLAGS_weight_schedule;
+    opt->trackAssignment = FLAGS_track_assignment;
 
     opt->seed = FLAGS_seed;
 
@@ -355,11 +507,14 @@ bool parseOptions(int argc, char** argv, ProgramOptions* opt) {
 int main(int argc, char** argv) {
   Main main;
 
-  if (!main.start())
-    exit(1);
   ProgramOptions opt;
   if (!parseOptions(argc, argv, &opt))
     exit(1);
+  // with -serve -, stdout carries nothing but the query answers
+  if (opt.serve == "-" && !main.reserveStdout())
+    exit(1);
+  if (!main.start())
+    exit(1);
   if (!main.setOptions(opt))
     exit(1);
   if (!main.outputInfo())
@@ -378,6 +533,16 @@ int main(int argc, char** argv) {
     exit(1);
   if (!main.finishPreproc())
     exit(1);
+  if (opt.estimateProbes > 0) {
+    SearchEstimate est;
+    if (!main.runKnuthEstimation(opt.estimateProbes, &est))
+      exit(1);
+  }
+  if (!opt.serve.empty()) {
+    if (!main.serve(opt.serve))
+      exit(1);
+    return 0;
+  }
   if (!main.runSearch())
     exit(1);
   if (!main.outputStats())